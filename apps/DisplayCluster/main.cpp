@@ -40,10 +40,12 @@
 
 #include "globals.h"
 #include "config.h"
+#include "ClockSynchronizer.h"
 #include "configuration/MasterConfiguration.h"
 #include "configuration/WallConfiguration.h"
 #include "DisplayGroupManager.h"
 #include "MainWindow.h"
+#include "MPIChannel.h"
 #include "NetworkListener.h"
 #include "log.h"
 #include "localstreamer/PixelStreamerLauncher.h"
@@ -97,13 +99,29 @@ int main(int argc, char * argv[])
     XInitThreads();
 #endif
 
+    // the wall processes with several screens render them in parallel threads
+    QApplication::setAttribute(Qt::AA_X11InitThreads);
+
     QApplication app(argc, argv);
 
-    MPI_Init(&argc, &argv);
+    // the wall processes receive messages in a thread while the main thread renders
+    int threadSupport;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &threadSupport);
     MPI_Comm_rank(MPI_COMM_WORLD, &g_mpiRank);
     MPI_Comm_size(MPI_COMM_WORLD, &g_mpiSize);
     MPI_Comm_split(MPI_COMM_WORLD, g_mpiRank != 0, g_mpiRank, &g_mpiRenderComm);
 
+    if(threadSupport < MPI_THREAD_MULTIPLE)
+    {
+        put_flog(LOG_FATAL, "the MPI implementation does not support MPI_THREAD_MULTIPLE");
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    g_mpiChannel = new MPIChannel(MPI_COMM_WORLD);
+    if(g_mpiRank != 0)
+        g_mpiChannel->startReceiving(&DisplayGroupManager::stageMessage);
+
     g_displayGroupManager.reset( new DisplayGroupManager );
 
     // Load configuration
@@ -114,8 +132,12 @@ int main(int argc, char * argv[])
         g_configuration = new WallConfiguration(configFilename,
                                                 g_displayGroupManager->getOptions(), g_mpiRank);
 
-    // calibrate timestamp offset between rank 0 and rank 1 clocks
-    g_displayGroupManager->calibrateTimestampOffset();
+    // calibrate timestamp offset between rank 0 and rank 1 clocks, now and periodically
+    ClockSynchronizer* clockSynchronizer = new ClockSynchronizer(MPI_COMM_WORLD);
+    if(g_mpiRank == 0)
+        QObject::connect(clockSynchronizer, SIGNAL(offsetMeasured(boost::posix_time::time_duration)),
+                         g_displayGroupManager.get(), SLOT(setTimestampOffset(boost::posix_time::time_duration)));
+    clockSynchronizer->start();
 
     g_mainWindow = new MainWindow();
 
@@ -273,6 +295,10 @@ int main(int argc, char * argv[])
     g_displayGroupManager.reset();
 
     // clean up the MPI environment after the Qt event loop exits
+    delete clockSynchronizer;
+    clockSynchronizer = 0;
+    delete g_mpiChannel;
+    g_mpiChannel = 0;
     MPI_Comm_free(&g_mpiRenderComm);
     MPI_Finalize();
 
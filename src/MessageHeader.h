@@ -54,7 +54,6 @@ enum MessageType
 {
     MESSAGE_TYPE_NONE,
     MESSAGE_TYPE_CONTENTS,
-    MESSAGE_TYPE_CONTENTS_DIMENSIONS,
     MESSAGE_TYPE_PIXELSTREAM_OPEN,
     MESSAGE_TYPE_PIXELSTREAM_FINISH_FRAME,
     MESSAGE_TYPE_PIXELSTREAM,
@@ -62,10 +61,11 @@ enum MessageType
     MESSAGE_TYPE_BIND_EVENTS_EX,
     MESSAGE_TYPE_BIND_EVENTS_REPLY,
     MESSAGE_TYPE_EVENT,
-    MESSAGE_TYPE_FRAME_CLOCK,
     MESSAGE_TYPE_COMMAND,
     MESSAGE_TYPE_QUIT,
-    MESSAGE_TYPE_ACK
+    MESSAGE_TYPE_ACK,
+    MESSAGE_TYPE_CONTENTS_DELTA,
+    MESSAGE_TYPE_PIXELSTREAM_CLOSE
 };
 
 #define MESSAGE_HEADER_URI_LENGTH 64
@@ -0,0 +1,189 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "ClockSynchronizer.h"
+#include "log.h"
+
+#include <QThread>
+#include <boost/date_time/gregorian/gregorian_types.hpp>
+
+// Request value asking rank 1 to stop answering
+#define CLOCKSYNCHRONIZER_STOP -1
+
+namespace
+{
+const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+}
+
+class ClockSynchronizer::ReplyThread : public QThread
+{
+public:
+    ReplyThread(MPI_Comm comm)
+        : comm_(comm)
+    {
+    }
+
+protected:
+    void run()
+    {
+        while(true)
+        {
+            int64_t request;
+            MPI_Recv((void *)&request, 1, MPI_INT64_T, 0, MPI_TAG_CLOCK_SYNC, comm_, MPI_STATUS_IGNORE);
+
+            int64_t reply[2];
+            reply[0] = ClockSynchronizer::getMicroseconds();
+
+            if(request == CLOCKSYNCHRONIZER_STOP)
+                return;
+
+            reply[1] = ClockSynchronizer::getMicroseconds();
+            MPI_Send((void *)reply, 2, MPI_INT64_T, 0, MPI_TAG_CLOCK_SYNC, comm_);
+        }
+    }
+
+private:
+    MPI_Comm comm_;
+};
+
+ClockSynchronizer::ClockSynchronizer(MPI_Comm comm)
+    : comm_(comm)
+    , replyThread_(0)
+{
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &size_);
+
+    timer_.setInterval(CLOCKSYNCHRONIZER_INTERVAL_MS);
+    connect(&timer_, SIGNAL(timeout()), this, SLOT(synchronize()));
+}
+
+ClockSynchronizer::~ClockSynchronizer()
+{
+    if(rank_ == 0 && timer_.isActive())
+    {
+        int64_t request = CLOCKSYNCHRONIZER_STOP;
+        MPI_Send((void *)&request, 1, MPI_INT64_T, 1, MPI_TAG_CLOCK_SYNC, comm_);
+    }
+
+    if(replyThread_)
+    {
+        replyThread_->wait();
+        delete replyThread_;
+    }
+}
+
+void ClockSynchronizer::start()
+{
+    // can't synchronize clocks unless we have at least 2 processes
+    if(size_ < 2)
+    {
+        put_flog(LOG_DEBUG, "cannot synchronize with %i processes", size_);
+        return;
+    }
+
+    if(rank_ == 0)
+    {
+        synchronize();
+        timer_.start();
+    }
+    else if(rank_ == 1)
+    {
+        replyThread_ = new ReplyThread(comm_);
+        replyThread_->start();
+    }
+}
+
+int64_t ClockSynchronizer::getMicroseconds()
+{
+    return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds();
+}
+
+boost::posix_time::ptime ClockSynchronizer::toTimestamp(const int64_t microseconds)
+{
+    return epoch + boost::posix_time::microseconds(microseconds);
+}
+
+boost::posix_time::time_duration ClockSynchronizer::estimateOffset(const ClockSamples& samples)
+{
+    // the sample with the shortest delay is the least affected by an asymmetric network delay
+    ClockSamples::const_iterator best = samples.end();
+    int64_t bestDelay = 0;
+
+    for(ClockSamples::const_iterator it = samples.begin(); it != samples.end(); ++it)
+    {
+        const int64_t delay = (it->replyReceived - it->requestSent) - (it->replySent - it->requestReceived);
+        if(best == samples.end() || delay < bestDelay)
+        {
+            best = it;
+            bestDelay = delay;
+        }
+    }
+
+    if(best == samples.end())
+        return boost::posix_time::time_duration();
+
+    const int64_t offset = ((best->requestReceived - best->requestSent) + (best->replySent - best->replyReceived)) / 2;
+    return boost::posix_time::microseconds(offset);
+}
+
+void ClockSynchronizer::synchronize()
+{
+    if(rank_ != 0 || size_ < 2)
+        return;
+
+    ClockSamples samples(CLOCKSYNCHRONIZER_SAMPLE_COUNT);
+
+    for(size_t i=0; i<samples.size(); i++)
+    {
+        int64_t request = getMicroseconds();
+        MPI_Send((void *)&request, 1, MPI_INT64_T, 1, MPI_TAG_CLOCK_SYNC, comm_);
+
+        int64_t reply[2];
+        MPI_Recv((void *)reply, 2, MPI_INT64_T, 1, MPI_TAG_CLOCK_SYNC, comm_, MPI_STATUS_IGNORE);
+
+        samples[i].requestSent = request;
+        samples[i].requestReceived = reply[0];
+        samples[i].replySent = reply[1];
+        samples[i].replyReceived = getMicroseconds();
+    }
+
+    const boost::posix_time::time_duration offset = estimateOffset(samples);
+    put_flog(LOG_DEBUG, "timestamp offset = %s", boost::posix_time::to_simple_string(offset).c_str());
+
+    emit offsetMeasured(offset);
+}
@@ -0,0 +1,133 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef CLOCKSYNCHRONIZER_H
+#define CLOCKSYNCHRONIZER_H
+
+#include <mpi.h>
+#include <stdint.h>
+#include <vector>
+#include <QObject>
+#include <QTimer>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+// Number of round trips measured for each synchronization
+#define CLOCKSYNCHRONIZER_SAMPLE_COUNT 8
+
+// Interval between two synchronizations, so that the clocks do not drift apart (ms)
+#define CLOCKSYNCHRONIZER_INTERVAL_MS 10000
+
+// Tag of the round trip messages between rank 0 and rank 1
+#define MPI_TAG_CLOCK_SYNC 3
+
+/** The four timestamps of a round trip, in microseconds since 1970 */
+struct ClockSample
+{
+    /** Rank 0 clock when sending the request */
+    int64_t requestSent;
+    /** Rank 1 clock when receiving the request */
+    int64_t requestReceived;
+    /** Rank 1 clock when sending the reply */
+    int64_t replySent;
+    /** Rank 0 clock when receiving the reply */
+    int64_t replyReceived;
+};
+
+typedef std::vector<ClockSample> ClockSamples;
+
+/**
+ * Measure the offset between the clock of rank 0 and the clock of rank 1, which is the frame
+ * clock of the wall.
+ *
+ * Like NTP, each synchronization measures several round trips and keeps the one with the shortest
+ * network delay, which has the smallest error. Rank 1 answers the requests in a thread, so that its
+ * answers are not delayed by rendering. The synchronization is repeated periodically.
+ */
+class ClockSynchronizer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Construct a synchronizer.
+     * @param comm The communicator in which rank 0 synchronizes with rank 1
+     */
+    ClockSynchronizer(MPI_Comm comm);
+
+    /** Rank 0: stop the answering thread of rank 1. Rank 1: wait for it. */
+    ~ClockSynchronizer();
+
+    /**
+     * Rank 0: synchronize now, then periodically.
+     * Rank 1: start answering the requests.
+     */
+    void start();
+
+    /** Get the current time, in microseconds since 1970. */
+    static int64_t getMicroseconds();
+
+    /** Convert a time in microseconds since 1970. */
+    static boost::posix_time::ptime toTimestamp(const int64_t microseconds);
+
+    /**
+     * Estimate the offset of the clock of rank 1 relative to the clock of rank 0.
+     * @param samples The measured round trips, must not be empty
+     * @return The offset of the round trip with the shortest delay
+     */
+    static boost::posix_time::time_duration estimateOffset(const ClockSamples& samples);
+
+public slots:
+    /** Rank 0: measure the offset and emit offsetMeasured(). */
+    void synchronize();
+
+signals:
+    /** Rank 0: the clock of rank 1 is ahead of the clock of rank 0 by this offset. */
+    void offsetMeasured(boost::posix_time::time_duration offset);
+
+private:
+    class ReplyThread;
+
+    MPI_Comm comm_;
+    int rank_;
+    int size_;
+
+    QTimer timer_;
+    ReplyThread* replyThread_;
+};
+
+#endif // CLOCKSYNCHRONIZER_H
@@ -50,7 +50,8 @@ enum CommandType
     COMMAND_TYPE_UNKNOWN,
     COMMAND_TYPE_FILE,
     COMMAND_TYPE_SESSION,
-    COMMAND_TYPE_WEBBROWSER
+    COMMAND_TYPE_WEBBROWSER,
+    COMMAND_TYPE_TRANSCODING
 };
 
 /** Get the string representation for a CommandType. */
@@ -44,6 +44,12 @@
 #include "log.h"
 #include <QGLWidget>
 
+#define ZOOM_CONTEXT_SIZE_FACTOR    0.25
+#define ZOOM_CONTEXT_PADDING        0.02
+#define ZOOM_CONTEXT_DELTA_Z        0.001
+#define ZOOM_CONTEXT_ALPHA          0.5
+#define ZOOM_CONTEXT_BORDER_PIXELS  5.
+
 Content::Content(QString uri)
     : uri_(uri)
     , width_(0)
@@ -96,26 +102,61 @@ void Content::render(ContentWindowManagerPtr window)
     // render the factory object
     renderFactoryObject(tX, tY, tW, tH);
 
-    // render the context view
+    // render the context view (full view), its borders are drawn by renderOverlays()
     if(g_displayGroupManager->getOptions()->getShowZoomContext() == true && zoom > 1.)
     {
-        float sizeFactor = 0.25;
-        float padding = 0.02;
-        float deltaZ = 0.001;
-        float alpha = 0.5;
-        float borderPixels = 5.;
+        glPushMatrix();
+
+        // position at lower left
+        glTranslatef(ZOOM_CONTEXT_PADDING, 1. - ZOOM_CONTEXT_SIZE_FACTOR - ZOOM_CONTEXT_PADDING, ZOOM_CONTEXT_DELTA_Z);
+        glScalef(ZOOM_CONTEXT_SIZE_FACTOR, ZOOM_CONTEXT_SIZE_FACTOR, 1.);
+
+        glTranslatef(0., 0., ZOOM_CONTEXT_DELTA_Z);
+        renderFactoryObject(0., 0., 1., 1.);
+
+        glPopMatrix();
+    }
+
+    glPopMatrix();
+}
+
+void Content::renderOverlays(ContentWindowManagerPtr window)
+{
+    double x, y, w, h;
+    window->getCoordinates(x, y, w, h);
+
+    double centerX, centerY;
+    window->getCenter(centerX, centerY);
+
+    double zoom = window->getZoom();
+
+    // calculate texture coordinates
+    float tX = centerX - 0.5 / zoom;
+    float tY = centerY - 0.5 / zoom;
+    float tW = 1./zoom;
+    float tH = 1./zoom;
 
+    glPushMatrix();
+
+    glTranslatef(x, y, 0.);
+    glScalef(w, h, 1.);
+
+    renderFactoryObjectOverlays();
+
+    // render the borders of the context view
+    if(g_displayGroupManager->getOptions()->getShowZoomContext() == true && zoom > 1.)
+    {
         glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT | GL_LINE_BIT);
         glPushMatrix();
 
         // position at lower left
-        glTranslatef(padding, 1. - sizeFactor - padding, deltaZ);
-        glScalef(sizeFactor, sizeFactor, 1.);
+        glTranslatef(ZOOM_CONTEXT_PADDING, 1. - ZOOM_CONTEXT_SIZE_FACTOR - ZOOM_CONTEXT_PADDING, ZOOM_CONTEXT_DELTA_Z);
+        glScalef(ZOOM_CONTEXT_SIZE_FACTOR, ZOOM_CONTEXT_SIZE_FACTOR, 1.);
 
         // render border rectangle
         glColor4f(1,1,1,1);
 
-        glLineWidth(borderPixels);
+        glLineWidth(ZOOM_CONTEXT_BORDER_PIXELS);
 
         glBegin(GL_LINE_LOOP);
 
@@ -126,14 +167,13 @@ void Content::render(ContentWindowManagerPtr window)
 
         glEnd();
 
-        // render the factory object (full view)
-        glTranslatef(0., 0., deltaZ);
-        renderFactoryObject(0., 0., 1., 1.);
+        // the full view was drawn at this depth by render()
+        glTranslatef(0., 0., ZOOM_CONTEXT_DELTA_Z);
 
         // draw context rectangle border
-        glTranslatef(0., 0., deltaZ);
+        glTranslatef(0., 0., ZOOM_CONTEXT_DELTA_Z);
 
-        glLineWidth(borderPixels);
+        glLineWidth(ZOOM_CONTEXT_BORDER_PIXELS);
 
         glBegin(GL_LINE_LOOP);
 
@@ -145,12 +185,12 @@ void Content::render(ContentWindowManagerPtr window)
         glEnd();
 
         // draw context rectangle blended
-        glTranslatef(0., 0., deltaZ);
+        glTranslatef(0., 0., ZOOM_CONTEXT_DELTA_Z);
 
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        glColor4f(1.,1.,1., alpha);
+        glColor4f(1.,1.,1., ZOOM_CONTEXT_ALPHA);
         GLWindow::drawRectangle(tX, tY, tW, tH);
 
         glPopMatrix();
@@ -66,7 +66,19 @@ class Content : public QObject {
         void getDimensions(int &width, int &height);
         void setDimensions(int width, int height);
         virtual void getFactoryObjectDimensions(int &width, int &height) = 0;
+
+        /**
+         * Add the textured quads of this content in the window to the QuadBatch of the active GLWindow.
+         * The zoom context view is added too, its borders are drawn by renderOverlays().
+         */
         void render(ContentWindowManagerPtr window);
+
+        /**
+         * Draw the lines and blended shapes of this content in the window.
+         * Must be called after the QuadBatch has been flushed, at the same depth as render().
+         */
+        void renderOverlays(ContentWindowManagerPtr window);
+
         void blockAdvance( bool block ) { blockAdvance_ = block; }
 
         // virtual method for implementing actions on advancing to a new frame
@@ -95,6 +107,9 @@ class Content : public QObject {
         bool blockAdvance_;
 
         virtual void renderFactoryObject(float tX, float tY, float tW, float tH) = 0;
+
+        // virtual method for drawing over the flushed factory object, in normalized coordinates
+        virtual void renderFactoryObjectOverlays() { }
 };
 
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(Content)
@@ -0,0 +1,210 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "ContentDimensionsProber.h"
+#include "log.h"
+#include "config.h"
+
+#include "DynamicTexture.h"
+#include "Movie.h"
+#include "MovieContent.h"
+#include "SVGContent.h"
+#if ENABLE_PDF_SUPPORT
+#  include "PDFContent.h"
+#  if QT_VERSION >= 0x050000
+#    include <poppler-qt5.h>
+#  else
+#    include <poppler-qt4.h>
+#  endif
+#endif
+
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSvgRenderer>
+
+namespace
+{
+// avformat_find_stream_info() opens the decoders, which is not thread-safe
+QMutex ffmpegMutex;
+
+QSize readMovieDimensions(const QString& uri)
+{
+    QMutexLocker locker(&ffmpegMutex);
+
+    AVFormatContext* avFormatContext = NULL;
+    if(avformat_open_input(&avFormatContext, uri.toAscii(), NULL, NULL) != 0)
+    {
+        put_flog(LOG_ERROR, "could not open movie file %s", uri.toLocal8Bit().constData());
+        return QSize();
+    }
+
+    QSize dimensions;
+    if(avformat_find_stream_info(avFormatContext, NULL) >= 0)
+    {
+        for(unsigned int i=0; i<avFormatContext->nb_streams; i++)
+        {
+            const AVCodecContext* codecContext = avFormatContext->streams[i]->codec;
+            if(codecContext->codec_type == AVMEDIA_TYPE_VIDEO)
+            {
+                dimensions = QSize(codecContext->width, codecContext->height);
+                break;
+            }
+        }
+    }
+
+    avformat_close_input(&avFormatContext);
+    return dimensions;
+}
+
+#if ENABLE_PDF_SUPPORT
+QSize readPDFDimensions(const QString& uri)
+{
+    Poppler::Document* document = Poppler::Document::load(uri);
+    if(!document)
+        return QSize();
+
+    QSize dimensions;
+    Poppler::Page* page = document->numPages() > 0 ? document->page(0) : 0;
+    if(page)
+    {
+        dimensions = page->pageSize();
+        delete page;
+    }
+
+    delete document;
+    return dimensions;
+}
+#endif
+}
+
+class ContentDimensionsProber::ProbeTask : public QRunnable
+{
+public:
+    ProbeTask(ContentDimensionsProber& prober, const QString& uri)
+        : prober_(prober)
+        , uri_(uri)
+    {
+    }
+
+    void run()
+    {
+        const QSize dimensions = prober_.getDimensions(uri_);
+        if(dimensions.isValid())
+            emit(prober_.dimensionsProbed(uri_, dimensions.width(), dimensions.height()));
+    }
+
+private:
+    ContentDimensionsProber& prober_;
+    const QString uri_;
+};
+
+ContentDimensionsProber::ContentDimensionsProber()
+{
+    threadPool_.setMaxThreadCount(CONTENTDIMENSIONSPROBER_MAX_THREADS);
+
+    // not thread-safe, so do it before the pool threads use FFMPEG
+    Movie::initFFMPEGGlobalState();
+}
+
+ContentDimensionsProber::~ContentDimensionsProber()
+{
+    threadPool_.waitForDone();
+}
+
+void ContentDimensionsProber::probe(const QString& uri)
+{
+    threadPool_.start(new ProbeTask(*this, uri));
+}
+
+QSize ContentDimensionsProber::getDimensions(const QString& uri)
+{
+    const QFileInfo fileInfo(uri);
+    if(!fileInfo.exists())
+        return QSize();
+
+    {
+        QMutexLocker locker(&cacheMutex_);
+
+        QHash<QString, CacheEntry>::const_iterator it = cache_.find(fileInfo.absoluteFilePath());
+        if(it != cache_.end() && it->lastModified == fileInfo.lastModified() && it->fileSize == fileInfo.size())
+            return it->dimensions;
+    }
+
+    // probe without holding the lock, concurrent probes of the same file give the same result
+    CacheEntry entry;
+    entry.lastModified = fileInfo.lastModified();
+    entry.fileSize = fileInfo.size();
+    entry.dimensions = readDimensions(uri);
+
+    QMutexLocker locker(&cacheMutex_);
+    cache_[fileInfo.absoluteFilePath()] = entry;
+
+    return entry.dimensions;
+}
+
+QSize ContentDimensionsProber::readDimensions(const QString& uri)
+{
+    const QString extension = QFileInfo(uri).suffix().toLower();
+
+#if ENABLE_PDF_SUPPORT
+    if(PDFContent::getSupportedExtensions().contains(extension))
+        return readPDFDimensions(uri);
+#endif
+
+    // SVG can also be read as an image, but QImageReader would rasterize it
+    if(SVGContent::getSupportedExtensions().contains(extension))
+        return QSvgRenderer(uri).defaultSize();
+
+    if(extension == "pyr")
+    {
+        std::string imagePyramidPath;
+        int width, height;
+        if(!DynamicTexture::readPyramidMetadata(uri, imagePyramidPath, width, height))
+            return QSize();
+        return QSize(width, height);
+    }
+
+    if(MovieContent::getSupportedExtensions().contains(extension))
+        return readMovieDimensions(uri);
+
+    // only reads the image header for the formats supporting it
+    QImageReader imageReader(uri);
+    return imageReader.size();
+}
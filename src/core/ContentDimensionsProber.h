@@ -0,0 +1,114 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef CONTENTDIMENSIONSPROBER_H
+#define CONTENTDIMENSIONSPROBER_H
+
+#include <QObject>
+#include <QString>
+#include <QSize>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+
+// Number of threads probing the files concurrently
+#define CONTENTDIMENSIONSPROBER_MAX_THREADS 2
+
+/**
+ * Discover the dimensions of the file contents on rank 0.
+ *
+ * Only the headers of the files are read (image size, movie stream information, first page of a
+ * PDF, pyramid metadata), in a pool of threads so that adding contents does not block the
+ * application. The results are cached by path, modification time and file size, so that a file is
+ * only probed again after it changed.
+ */
+class ContentDimensionsProber : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** Construct a prober. Must be called from the main thread. */
+    ContentDimensionsProber();
+
+    /** Wait for the pending probes to finish. */
+    ~ContentDimensionsProber();
+
+    /**
+     * Probe the dimensions of a file in the thread pool.
+     * The dimensionsProbed() signal is emitted from the pool thread when they are known.
+     * @param uri The file to probe
+     */
+    void probe(const QString& uri);
+
+    /**
+     * Get the dimensions of a file, probing it now if it is not in the cache.
+     * Can be called from any thread.
+     * @param uri The file to probe
+     * @return The dimensions, invalid if the file could not be read
+     */
+    QSize getDimensions(const QString& uri);
+
+    /**
+     * Read the dimensions of a file from its header, without the cache.
+     * @param uri The file to probe
+     * @return The dimensions, invalid if the file could not be read
+     */
+    static QSize readDimensions(const QString& uri);
+
+signals:
+    /** The dimensions of a file are known. */
+    void dimensionsProbed(QString uri, int width, int height);
+
+private:
+    class ProbeTask;
+
+    struct CacheEntry
+    {
+        QDateTime lastModified;
+        qint64 fileSize;
+        QSize dimensions;
+    };
+
+    QThreadPool threadPool_;
+
+    QMutex cacheMutex_;
+    QHash<QString, CacheEntry> cache_;
+};
+
+#endif // CONTENTDIMENSIONSPROBER_H
@@ -584,6 +584,13 @@ void ContentWindowInterface::setEvent(Event event, ContentWindowInterface * sour
     }
 }
 
+void ContentWindowInterface::setControlState( const ControlState state )
+{
+    controlState_ = state;
+
+    emit(controlStateChanged(this));
+}
+
 void ContentWindowInterface::highlight(ContentWindowInterface * source)
 {
     if(source == this)
@@ -117,7 +117,7 @@ class ContentWindowInterface : public QObject
         SizeState getSizeState() const;
 
         /** Set the control state. */
-        void setControlState( const ControlState state ) { controlState_ = state; }
+        void setControlState( const ControlState state );
 
         /** Get the control state. */
         ControlState getControlState() const { return controlState_; }
@@ -180,6 +180,7 @@ class ContentWindowInterface : public QObject
         void eventChanged(Event event, ContentWindowInterface * source);
         void movedToFront(ContentWindowInterface * source);
         void closed(ContentWindowInterface * source);
+        void controlStateChanged(ContentWindowInterface * source);
 
     protected:
 
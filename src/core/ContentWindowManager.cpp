@@ -53,14 +53,18 @@
 #  include "PDFInteractionDelegate.h"
 #endif
 
+// Identifiers of the windows created on rank 0, starting at 1
+static QAtomicInt lastWindowId(0);
 
 ContentWindowManager::ContentWindowManager()
-    : interactionDelegate_( 0 )
+    : id_( 0 )
+    , interactionDelegate_( 0 )
 {
 }
 
 ContentWindowManager::ContentWindowManager(ContentPtr content)
-    : interactionDelegate_( 0 )
+    : id_( lastWindowId.fetchAndAddOrdered(1) + 1 )
+    , interactionDelegate_( 0 )
 {
     // ContentWindowManagers must always belong to the main thread!
     moveToThread(QApplication::instance()->thread());
@@ -110,6 +114,11 @@ ContentWindowManager::~ContentWindowManager()
     delete interactionDelegate_;
 }
 
+unsigned int ContentWindowManager::getId() const
+{
+    return id_;
+}
+
 ContentPtr ContentWindowManager::getContent()
 {
     return content_;
@@ -150,6 +159,10 @@ void ContentWindowManager::setDisplayGroupManager(DisplayGroupManagerPtr display
                 displayGroupManager.get(), SLOT(sendDisplayGroup()));
         connect(this, SIGNAL(windowStateChanged(ContentWindowInterface::WindowState, ContentWindowInterface *)),
                 displayGroupManager.get(), SLOT(sendDisplayGroup()));
+        connect(this, SIGNAL(highlighted(ContentWindowInterface *)),
+                displayGroupManager.get(), SLOT(sendDisplayGroup()));
+        connect(this, SIGNAL(controlStateChanged(ContentWindowInterface *)),
+                displayGroupManager.get(), SLOT(sendDisplayGroup()));
 
         // we don't call sendDisplayGroup() on movedToFront() or destroyed() since it happens already
     }
@@ -211,6 +224,11 @@ void ContentWindowManager::centerPositionAround(const QPointF& position, const b
 void ContentWindowManager::render()
 {
     content_->render(shared_from_this());
+}
+
+void ContentWindowManager::renderOverlays()
+{
+    content_->renderOverlays(shared_from_this());
 
     // optionally render the border
     bool showWindowBorders = true;
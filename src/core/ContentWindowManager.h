@@ -73,17 +73,20 @@ class ContentWindowManager : public ContentWindowInterface, public boost::enable
         QPointF getWindowCenterPosition() const;
         void centerPositionAround(const QPointF& position, const bool constrainToWindowBorders);
 
-        // GLWindow rendering
+        // GLWindow rendering: the textured quads, then the borders after the QuadBatch flush
         void render();
+        void renderOverlays();
 
-    protected:
-        friend class boost::serialization::access;
+        /** Get the identifier of the window, unique in the DisplayGroup. */
+        unsigned int getId() const;
 
+        /**
+         * Serialize the state of the window, excluding its identifier, DisplayGroupManager and Content.
+         * Used to update an existing window on the render processes.
+         */
         template<class Archive>
-        void serialize(Archive & ar, const unsigned int)
+        void serializeState(Archive & ar)
         {
-            ar & content_;
-            ar & displayGroupManager_;
             ar & contentWidth_;
             ar & contentHeight_;
             ar & x_;
@@ -98,7 +101,22 @@ class ContentWindowManager : public ContentWindowInterface, public boost::enable
             ar & highlightedTimestamp_;
         }
 
+    protected:
+        friend class boost::serialization::access;
+        friend class DisplayGroupManager;
+
+        template<class Archive>
+        void serialize(Archive & ar, const unsigned int)
+        {
+            ar & id_;
+            ar & displayGroupManager_;
+            ar & content_;
+            serializeState(ar);
+        }
+
     private:
+        unsigned int id_;
+
         ContentPtr content_;
 
         boost::weak_ptr<DisplayGroupManager> displayGroupManager_;
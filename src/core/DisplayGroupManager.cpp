@@ -39,15 +39,21 @@
 #include "DisplayGroupManager.h"
 #include "ContentWindowManager.h"
 #include "ContentFactory.h"
+#include "ContentDimensionsProber.h"
 #include "Content.h"
 #include "globals.h"
 #include "log.h"
 #include "MainWindow.h"
 #include "GLWindow.h"
+#include "ClockSynchronizer.h"
 #include "MessageHeader.h"
+#include "MPIChannel.h"
 #include "PixelStream.h"
+#include "PixelStreamRegistry.h"
+#include "WireFormat.h"
 
 #include <sstream>
+#include <set>
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/utility.hpp>
@@ -55,11 +61,30 @@
 #include <boost/algorithm/string.hpp>
 #include <mpi.h>
 #include <fstream>
+#include <limits>
 #include <QSvgRenderer>
 
+namespace
+{
+// objects can only be pushed from the thread they belong to, and contents can be shared by windows
+void moveObjectToThread(QObject * object, QThread * thread)
+{
+    if(object && object->thread() == QThread::currentThread())
+        object->moveToThread(thread);
+}
+}
+
+unsigned int DisplayGroupManager::receivedPixelStreamFrames_ = 0;
 
 DisplayGroupManager::DisplayGroupManager()
     : options_(new Options())
+    , version_(0)
+    , snapshotNeeded_(true)
+    , backgroundModified_(false)
+    , backgroundContentModified_(false)
+    , optionsModified_(false)
+    , markersModified_(false)
+    , skeletonsModified_(false)
 {
     // make Options trigger sendDisplayGroup() when it is updated
     connect(options_.get(), SIGNAL(updated()), this, SLOT(sendDisplayGroup()), Qt::QueuedConnection);
@@ -148,9 +173,14 @@ void DisplayGroupManager::addContentWindowManager(ContentWindowManagerPtr conten
 
         if (contentWindowManager->getContent()->getType() != CONTENT_TYPE_PIXEL_STREAM)
         {
-            // TODO initialize all content dimensions on creation so we can remove this procedure
             // make sure we have its dimensions so we can constrain its aspect ratio
-            sendContentsDimensionsRequest();
+            if (!dimensionsProber_)
+            {
+                dimensionsProber_.reset(new ContentDimensionsProber());
+                connect(dimensionsProber_.get(), SIGNAL(dimensionsProbed(QString, int, int)),
+                        this, SLOT(updateContentDimensions(QString, int, int)), Qt::QueuedConnection);
+            }
+            dimensionsProber_->probe(contentWindowManager->getContent()->getURI());
         }
     }
 }
@@ -186,83 +216,6 @@ void DisplayGroupManager::moveContentWindowManagerToFront(ContentWindowManagerPt
     }
 }
 
-void DisplayGroupManager::calibrateTimestampOffset()
-{
-    // can't calibrate timestamps unless we have at least 2 processes
-    if(g_mpiSize < 2)
-    {
-        put_flog(LOG_DEBUG, "cannot calibrate with g_mpiSize == %i", g_mpiSize);
-        return;
-    }
-
-    // synchronize all processes
-    MPI_Barrier(g_mpiRenderComm);
-
-    // get current timestamp immediately after
-    boost::posix_time::ptime timestamp(boost::posix_time::microsec_clock::universal_time());
-
-    // rank 1: send timestamp to rank 0
-    if(g_mpiRank == 1)
-    {
-        // serialize state
-        std::ostringstream oss(std::ostringstream::binary);
-
-        // brace this so destructor is called on archive before we use the stream
-        {
-            boost::archive::binary_oarchive oa(oss);
-            oa << timestamp;
-        }
-
-        // serialized data to string
-        std::string serializedString = oss.str();
-        int size = serializedString.size();
-
-        // send the header and the message
-        MessageHeader mh;
-        mh.size = size;
-
-        MPI_Send((void *)&mh, sizeof(MessageHeader), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
-        MPI_Send((void *)serializedString.data(), size, MPI_BYTE, 0, 0, MPI_COMM_WORLD);
-    }
-    // rank 0: receive timestamp from rank 1
-    else if(g_mpiRank == 0)
-    {
-        MessageHeader messageHeader;
-
-        MPI_Status status;
-        MPI_Recv((void *)&messageHeader, sizeof(MessageHeader), MPI_BYTE, 1, 0, MPI_COMM_WORLD, &status);
-
-        // receive serialized data
-        char * buf = new char[messageHeader.size];
-
-        // read message into the buffer
-        MPI_Recv((void *)buf, messageHeader.size, MPI_BYTE, 1, 0, MPI_COMM_WORLD, &status);
-
-        // de-serialize...
-        std::istringstream iss(std::istringstream::binary);
-
-        if(iss.rdbuf()->pubsetbuf(buf, messageHeader.size) == NULL)
-        {
-            put_flog(LOG_FATAL, "rank %i: error setting stream buffer", g_mpiRank);
-            exit(-1);
-        }
-
-        // read to a new timestamp
-        boost::posix_time::ptime rank1Timestamp;
-
-        boost::archive::binary_iarchive ia(iss);
-        ia >> rank1Timestamp;
-
-        // free mpi buffer
-        delete [] buf;
-
-        // now, calculate and store the timestamp offset
-        timestampOffset_ = rank1Timestamp - timestamp;
-
-        put_flog(LOG_DEBUG, "timestamp offset = %s", (boost::posix_time::to_simple_string(timestampOffset_)).c_str());
-    }
-}
-
 void DisplayGroupManager::setBackgroundContentWindowManager(ContentWindowManagerPtr contentWindowManager)
 {
     // This method can be used to remove the background by sending a NULL ptr
@@ -275,6 +228,8 @@ void DisplayGroupManager::setBackgroundContentWindowManager(ContentWindowManager
 
     backgroundContent_ = contentWindowManager;
 
+    // a new background window is only sent with a full snapshot
+    snapshotNeeded_ = true;
     sendDisplayGroup();
 }
 
@@ -322,6 +277,7 @@ void DisplayGroupManager::setBackgroundColor(QColor color)
     if(color == backgroundColor_)
         return;
     backgroundColor_ = color;
+    snapshotNeeded_ = true;
     sendDisplayGroup();
 }
 
@@ -360,7 +316,7 @@ void DisplayGroupManager::hideWindow(const QString uri)
     }
 }
 
-void DisplayGroupManager::receiveMessages()
+bool DisplayGroupManager::receiveMessages()
 {
     if(g_mpiRank == 0)
     {
@@ -368,56 +324,191 @@ void DisplayGroupManager::receiveMessages()
         exit(-1);
     }
 
-    // check to see if we have a message (non-blocking)
-    int flag;
-    MPI_Status status;
-    MPI_Iprobe(0, 0, MPI_COMM_WORLD, &flag, &status);
+    // the messages are received by a thread; only process the ones which all render processes have,
+    // this will "drop frames" and keep all processes synchronized
+    // the frame clock of rank 1 is agreed upon in the same collective: it is the only process which
+    // contributes a value lower than the maximum, negated so that it wins the minimum
+    int64_t frameState[2];
+    frameState[0] = g_mpiChannel->getReceivedCount();
+    frameState[1] = (g_mpiRank == 1) ? -ClockSynchronizer::getMicroseconds() : std::numeric_limits<int64_t>::max();
 
-    // check to see if all render processes have a message
-    int allFlag;
-    MPI_Allreduce(&flag, &allFlag, 1, MPI_INT, MPI_LAND, g_mpiRenderComm);
+    int64_t agreedFrameState[2];
+    MPI_Allreduce((void *)frameState, (void *)agreedFrameState, 2, MPI_INT64_T, MPI_MIN, g_mpiRenderComm);
 
-    // message header
-    MessageHeader mh;
+    const bool pixelStreamsReceived = processMessages(g_mpiChannel->takeMessages(agreedFrameState[0]));
 
-    // if all render processes have a message...
-    if(allFlag != 0)
+    // the display group may have been replaced by the messages
+    g_displayGroupManager->timestamp_ = ClockSynchronizer::toTimestamp(-agreedFrameState[1]);
+
+    return pixelStreamsReceived;
+}
+
+bool DisplayGroupManager::processMessages(const MPIMessages& messages)
+{
+    // a snapshot replaces g_displayGroupManager, keep this object alive until all messages are processed
+    DisplayGroupManagerPtr self = shared_from_this();
+
+    bool pixelStreamsReceived = false;
+
+    for(MPIMessages::const_iterator it = messages.begin(); it != messages.end(); ++it)
     {
-        // continue receiving messages until we get to the last one which all render processes have
-        // this will "drop frames" and keep all processes synchronized
-        while(allFlag)
+        const MPIMessage& message = *it;
+
+        if(message.header.type == MESSAGE_TYPE_CONTENTS)
+        {
+            receiveDisplayGroup(message);
+        }
+        else if(message.header.type == MESSAGE_TYPE_CONTENTS_DELTA)
+        {
+            receiveDisplayGroupUpdate(message);
+        }
+        else if(message.header.type == MESSAGE_TYPE_PIXELSTREAM_OPEN)
         {
-            // first, get message header
-            MPI_Recv((void *)&mh, sizeof(MessageHeader), MPI_BYTE, 0, 0, MPI_COMM_WORLD, &status);
+            receivePixelStreamOpen(message);
+        }
+        else if(message.header.type == MESSAGE_TYPE_PIXELSTREAM_CLOSE)
+        {
+            receivePixelStreamClose(message);
+        }
+        else if(message.header.type == MESSAGE_TYPE_PIXELSTREAM)
+        {
+            receivePixelStreams(message);
+            pixelStreamsReceived = true;
+        }
+        else if(message.header.type == MESSAGE_TYPE_QUIT)
+        {
+            QApplication::instance()->quit();
+            break;
+        }
+    }
 
-            if(mh.type == MESSAGE_TYPE_CONTENTS)
-            {
-                receiveDisplayGroup(mh);
-            }
-            else if(mh.type == MESSAGE_TYPE_CONTENTS_DIMENSIONS)
-            {
-                receiveContentsDimensionsRequest(mh);
-            }
-            else if(mh.type == MESSAGE_TYPE_PIXELSTREAM)
-            {
-                receivePixelStreams(mh);
-            }
-            else if(mh.type == MESSAGE_TYPE_QUIT)
-            {
-                QApplication::instance()->quit();
-                return;
-            }
+    return pixelStreamsReceived;
+}
 
-            // check to see if we have another message waiting, for this process and for all render processes
-            MPI_Iprobe(0, 0, MPI_COMM_WORLD, &flag, &status);
-            MPI_Allreduce(&flag, &allFlag, 1, MPI_INT, MPI_LAND, g_mpiRenderComm);
+unsigned int DisplayGroupManager::getReceivedPixelStreamFrameCount()
+{
+    return receivedPixelStreamFrames_;
+}
+
+void DisplayGroupManager::sendDisplayGroup()
+{
+    // record which object triggered the update, when it was invoked through a signal
+    markModified(sender());
+
+    if(snapshotNeeded_)
+    {
+        sendDisplayGroupSnapshot();
+        return;
+    }
+
+    std::vector<unsigned int> windowIds;
+    for(unsigned int i=0; i<contentWindowManagers_.size(); i++)
+    {
+        windowIds.push_back(contentWindowManagers_[i]->getId());
+    }
+
+    // the windows added since the last update are sent with their content
+    const std::set<unsigned int> sentWindowIds(sentWindowIds_.begin(), sentWindowIds_.end());
+    for(unsigned int i=0; i<windowIds.size(); i++)
+    {
+        if(!sentWindowIds.count(windowIds[i]))
+        {
+            modifiedWindows_.insert(windowIds[i]);
+            modifiedContents_.insert(windowIds[i]);
+        }
+    }
+
+    // serialize the modified objects only
+    std::ostringstream oss(std::ostringstream::binary);
+
+    // brace this so destructor is called on archive before we use the stream
+    {
+        boost::archive::binary_oarchive oa(oss);
+
+        oa << version_;
+        ++version_;
+
+        std::vector<ContentWindowManagerPtr> modifiedWindows;
+        for(unsigned int i=0; i<contentWindowManagers_.size(); i++)
+        {
+            if(modifiedWindows_.count(windowIds[i]))
+                modifiedWindows.push_back(contentWindowManagers_[i]);
+        }
+
+        // the other windows are patched in place, only their geometry and state are sent
+        const unsigned int modifiedWindowsCount = modifiedWindows.size();
+        oa << modifiedWindowsCount;
+        for(unsigned int i=0; i<modifiedWindowsCount; i++)
+        {
+            const unsigned int id = modifiedWindows[i]->getId();
+            oa << id;
+
+            const bool contentModified = modifiedContents_.count(id) > 0;
+            oa << contentModified;
+            if(contentModified)
+                oa << modifiedWindows[i]->content_;
+
+            modifiedWindows[i]->serializeState(oa);
+        }
+
+        // the background window is replaced by a snapshot, but moved or zoomed by updates
+        const bool backgroundModified = backgroundModified_ && backgroundContent_;
+        oa << backgroundModified;
+        if(backgroundModified)
+        {
+            oa << backgroundContentModified_;
+            if(backgroundContentModified_)
+                oa << backgroundContent_->content_;
+
+            backgroundContent_->serializeState(oa);
+        }
+
+        // added, removed or reordered windows
+        const bool windowsChanged = (windowIds != sentWindowIds_);
+        oa << windowsChanged;
+        if(windowsChanged)
+            oa << windowIds;
+
+        oa << optionsModified_;
+        if(optionsModified_)
+        {
+            const Options& options = *options_;
+            oa << options;
+        }
+
+        {
+            QMutexLocker locker(&markersMutex_);
+
+            oa << markersModified_;
+            if(markersModified_)
+                oa << markers_;
         }
 
-        // at this point, we've received the last message available for all render processes
+#if ENABLE_SKELETON_SUPPORT
+        oa << skeletonsModified_;
+        if(skeletonsModified_)
+            oa << skeletons_;
+#endif
     }
+
+    sentWindowIds_ = windowIds;
+    modifiedWindows_.clear();
+    modifiedContents_.clear();
+    backgroundModified_ = false;
+    backgroundContentModified_ = false;
+    optionsModified_ = false;
+    markersModified_ = false;
+    skeletonsModified_ = false;
+
+    // serialized data to string
+    std::string serializedString = oss.str();
+    int size = serializedString.size();
+
+    // send the header and the message together
+    g_mpiChannel->broadcast(MESSAGE_TYPE_CONTENTS_DELTA, serializedString.data(), size);
 }
 
-void DisplayGroupManager::sendDisplayGroup()
+void DisplayGroupManager::sendDisplayGroupSnapshot()
 {
     // serialize state
     std::ostringstream oss(std::ostringstream::binary);
@@ -429,79 +520,76 @@ void DisplayGroupManager::sendDisplayGroup()
         DisplayGroupManagerPtr dgm = shared_from_this();
 
         boost::archive::binary_oarchive oa(oss);
+        oa << version_;
         oa << dgm;
     }
+    ++version_;
+
+    // the following updates are relative to this snapshot
+    snapshotNeeded_ = false;
+    sentWindowIds_.clear();
+    for(unsigned int i=0; i<contentWindowManagers_.size(); i++)
+    {
+        sentWindowIds_.push_back(contentWindowManagers_[i]->getId());
+    }
+    modifiedWindows_.clear();
+    modifiedContents_.clear();
+    backgroundModified_ = false;
+    backgroundContentModified_ = false;
+    optionsModified_ = false;
+    markersModified_ = false;
+    skeletonsModified_ = false;
 
     // serialized data to string
     std::string serializedString = oss.str();
     int size = serializedString.size();
 
-    // send the header and the message
-    MessageHeader mh;
-    mh.size = size;
-    mh.type = MESSAGE_TYPE_CONTENTS;
-
-    // the header is sent via a send, so that we can probe it on the render processes
-    for(int i=1; i<g_mpiSize; i++)
-    {
-        MPI_Send((void *)&mh, sizeof(MessageHeader), MPI_BYTE, i, 0, MPI_COMM_WORLD);
-    }
-
-    // broadcast the message
-    MPI_Bcast((void *)serializedString.data(), size, MPI_BYTE, 0, MPI_COMM_WORLD);
+    // send the header and the message together
+    g_mpiChannel->broadcast(MESSAGE_TYPE_CONTENTS, serializedString.data(), size);
 }
 
-void DisplayGroupManager::sendContentsDimensionsRequest()
+void DisplayGroupManager::markModified(QObject * source)
 {
-    if(g_mpiSize < 2)
+    if(source == NULL)
+        return;
+
+    if(source == options_.get())
     {
-        put_flog(LOG_WARN, "cannot get contents dimension update for g_mpiSize == %i", g_mpiSize);
+        optionsModified_ = true;
         return;
     }
 
-    // send the header and the message
-    MessageHeader mh;
-    mh.type = MESSAGE_TYPE_CONTENTS_DIMENSIONS;
-
-    // the header is sent via a send, so that we can probe it on the render processes
-    for(int i=1; i<g_mpiSize; i++)
+    if(dynamic_cast<Marker *>(source) != NULL)
     {
-        MPI_Send((void *)&mh, sizeof(MessageHeader), MPI_BYTE, i, 0, MPI_COMM_WORLD);
+        markersModified_ = true;
+        return;
     }
 
-    // now, receive response from rank 1
-    MPI_Status status;
-    MPI_Recv((void *)&mh, sizeof(MessageHeader), MPI_BYTE, 1, 0, MPI_COMM_WORLD, &status);
-
-    // receive serialized data
-    char * buf = new char[mh.size];
-
-    // read message into the buffer
-    MPI_Recv((void *)buf, mh.size, MPI_BYTE, 1, 0, MPI_COMM_WORLD, &status);
-
-    // de-serialize...
-    std::istringstream iss(std::istringstream::binary);
-
-    if(iss.rdbuf()->pubsetbuf(buf, mh.size) == NULL)
+    ContentWindowManager * contentWindowManager = dynamic_cast<ContentWindowManager *>(source);
+    if(contentWindowManager != NULL)
     {
-        put_flog(LOG_FATAL, "rank %i: error setting stream buffer", g_mpiRank);
-        exit(-1);
+        if(contentWindowManager == backgroundContent_.get())
+            backgroundModified_ = true;
+        else
+            modifiedWindows_.insert(contentWindowManager->getId());
+        return;
     }
 
-    // read to a new vector
-    std::vector<std::pair<int, int> > dimensions;
-
-    boost::archive::binary_iarchive ia(iss);
-    ia >> dimensions;
-
-    // overwrite old dimensions
-    for(unsigned int i=0; i<dimensions.size() && i<contentWindowManagers_.size(); i++)
+    // a Content changed, e.g. the page of a PDF; it is sent again with its window
+    for(unsigned int i=0; i<contentWindowManagers_.size(); i++)
     {
-        contentWindowManagers_[i]->getContent()->setDimensions(dimensions[i].first, dimensions[i].second);
+        if(contentWindowManagers_[i]->getContent().get() == source)
+        {
+            modifiedWindows_.insert(contentWindowManagers_[i]->getId());
+            modifiedContents_.insert(contentWindowManagers_[i]->getId());
+        }
     }
 
-    // free mpi buffer
-    delete [] buf;
+    if(backgroundContent_ && backgroundContent_->getContent().get() == source)
+    {
+        backgroundModified_ = true;
+        backgroundContentModified_ = true;
+    }
 }
 
 void DisplayGroupManager::adjustPixelStreamContentDimensions(QString uri, int width, int height, bool changeViewSize)
@@ -526,6 +614,25 @@ void DisplayGroupManager::adjustPixelStreamContentDimensions(QString uri, int wi
     }
 }
 
+void DisplayGroupManager::updateContentDimensions(QString uri, int width, int height)
+{
+    // the same file can be opened in several windows
+    for(unsigned int i=0; i<contentWindowManagers_.size(); i++)
+    {
+        ContentPtr c = contentWindowManagers_[i]->getContent();
+
+        if(c->getType() == CONTENT_TYPE_PIXEL_STREAM || c->getURI() != uri)
+            continue;
+
+        int oldWidth, oldHeight;
+        c->getDimensions(oldWidth, oldHeight);
+
+        // the window forwards the new dimensions to the wall
+        if(width != oldWidth || height != oldHeight)
+            c->setDimensions(width, height);
+    }
+}
+
 void DisplayGroupManager::registerEventReceiver(QString uri, bool exclusive, EventReceiver* receiver)
 {
     bool success = false;
@@ -554,7 +661,22 @@ void DisplayGroupManager::registerEventReceiver(QString uri, bool exclusive, Eve
     emit eventRegistrationReply(uri, success);
 }
 
-void DisplayGroupManager::sendFrameClockUpdate()
+void DisplayGroupManager::setTimestampOffset(boost::posix_time::time_duration offset)
+{
+    timestampOffset_ = offset;
+}
+
+void DisplayGroupManager::sendQuit()
+{
+    // will send EVT_CLOSE through Event
+    ContentWindowManagerPtrs contentWindowManagers;
+    setContentWindowManagers( contentWindowManagers );
+
+    // this also stops the receiving threads of the render processes
+    g_mpiChannel->broadcast(MESSAGE_TYPE_QUIT, 0, 0);
+}
+
+void DisplayGroupManager::sendPixelStreamsReady()
 {
     // this should only be called by the rank 1 process
     if(g_mpiRank != 1)
@@ -563,95 +685,35 @@ void DisplayGroupManager::sendFrameClockUpdate()
         return;
     }
 
-    boost::posix_time::ptime timestamp(boost::posix_time::microsec_clock::universal_time());
-
-    // serialize state
-    std::ostringstream oss(std::ostringstream::binary);
-
-    // brace this so destructor is called on archive before we use the stream
-    {
-        boost::archive::binary_oarchive oa(oss);
-        oa << timestamp;
-    }
-
-    // serialized data to string
-    std::string serializedString = oss.str();
-    int size = serializedString.size();
-
-    // send the header and the message
-    MessageHeader mh;
-    mh.size = size;
-    mh.type = MESSAGE_TYPE_FRAME_CLOCK;
-
-    // the header is sent via a send, so that we can probe it on the render processes
-    for(int i=2; i<g_mpiSize; i++)
-    {
-        MPI_Send((void *)&mh, sizeof(MessageHeader), MPI_BYTE, i, 0, MPI_COMM_WORLD);
-    }
-
-    // broadcast it
-    MPI_Bcast((void *)serializedString.data(), size, MPI_BYTE, 0, g_mpiRenderComm);
-
-    // update timestamp
-    timestamp_ = timestamp;
+    MPI_Send((void *)&receivedPixelStreamFrames_, 1, MPI_UNSIGNED, 0, MPI_TAG_PIXELSTREAMS_READY, MPI_COMM_WORLD);
 }
 
-void DisplayGroupManager::receiveFrameClockUpdate()
+bool DisplayGroupManager::receivePixelStreamsReady(const unsigned int sentFrameCount)
 {
-    // we shouldn't run the broadcast if we're rank 1
-    if(g_mpiRank == 1)
+    // without render processes there is nobody to wait for
+    if(g_mpiSize < 2)
     {
-        return;
+        return true;
     }
 
-    // receive the message header
-    MessageHeader messageHeader;
+    bool ready = false;
+
+    int flag;
     MPI_Status status;
-    MPI_Recv((void *)&messageHeader, sizeof(MessageHeader), MPI_BYTE, 1, 0, MPI_COMM_WORLD, &status);
+    MPI_Iprobe(1, MPI_TAG_PIXELSTREAMS_READY, MPI_COMM_WORLD, &flag, &status);
 
-    if(messageHeader.type != MESSAGE_TYPE_FRAME_CLOCK)
+    // all pending notifications are consumed, but only the ones covering the last frames sent count
+    while(flag)
     {
-        put_flog(LOG_FATAL, "unexpected message type");
-        exit(-1);
-    }
-
-    // receive serialized data
-    char * buf = new char[messageHeader.size];
-
-    // read message into the buffer
-    MPI_Bcast((void *)buf, messageHeader.size, MPI_BYTE, 0, g_mpiRenderComm);
+        unsigned int receivedFrameCount = 0;
+        MPI_Recv((void *)&receivedFrameCount, 1, MPI_UNSIGNED, 1, MPI_TAG_PIXELSTREAMS_READY, MPI_COMM_WORLD, &status);
+        if(receivedFrameCount >= sentFrameCount)
+            ready = true;
 
-    // de-serialize...
-    std::istringstream iss(std::istringstream::binary);
-
-    if(iss.rdbuf()->pubsetbuf(buf, messageHeader.size) == NULL)
-    {
-        put_flog(LOG_FATAL, "rank %i: error setting stream buffer", g_mpiRank);
-        exit(-1);
+        MPI_Iprobe(1, MPI_TAG_PIXELSTREAMS_READY, MPI_COMM_WORLD, &flag, &status);
     }
 
-    boost::archive::binary_iarchive ia(iss);
-    ia >> timestamp_;
-
-    // free mpi buffer
-    delete [] buf;
-}
-
-void DisplayGroupManager::sendQuit()
-{
-    // send the header and the message
-    MessageHeader mh;
-    mh.type = MESSAGE_TYPE_QUIT;
-
-    // will send EVT_CLOSE through Event
-    ContentWindowManagerPtrs contentWindowManagers;
-    setContentWindowManagers( contentWindowManagers );
-
-    // the header is sent via a send, so that we can probe it on the render processes
-    for(int i=1; i<g_mpiSize; i++)
-    {
-        MPI_Send((void *)&mh, sizeof(MessageHeader), MPI_BYTE, i, 0, MPI_COMM_WORLD);
-    }
+    return ready;
 }
 
 void DisplayGroupManager::advanceContents()
@@ -707,103 +769,229 @@ void DisplayGroupManager::closePixelStream(const QString& uri)
 void DisplayGroupManager::setSkeletons(std::vector< boost::shared_ptr<SkeletonState> > skeletons)
 {
     skeletons_ = skeletons;
+    skeletonsModified_ = true;
 
     sendDisplayGroup();
 }
 #endif
 
-void DisplayGroupManager::receiveDisplayGroup(const MessageHeader& messageHeader)
+void DisplayGroupManager::stageMessage(MPIMessage& message)
 {
-    // receive serialized data
-    char * buf = new char[messageHeader.size];
+    if(message.header.type == MESSAGE_TYPE_CONTENTS)
+    {
+        // de-serialize...
+        std::istringstream iss(std::istringstream::binary);
 
-    // read message into the buffer
-    MPI_Bcast((void *)buf, messageHeader.size, MPI_BYTE, 0, MPI_COMM_WORLD);
+        if(iss.rdbuf()->pubsetbuf((char *)message.data(), message.header.size) == NULL)
+        {
+            put_flog(LOG_FATAL, "rank %i: error setting stream buffer", g_mpiRank);
+            exit(-1);
+        }
+
+        boost::archive::binary_iarchive ia(iss);
+        unsigned int version;
+        ia >> version;
+        ia >> message.displayGroup;
 
+        // the following updates are relative to this snapshot
+        message.displayGroup->version_ = version + 1;
+
+        // the new objects belong to the render loop from now on
+        message.displayGroup->moveObjectsToThread(QApplication::instance()->thread());
+        message.staged = true;
+    }
+    else if(message.header.type == MESSAGE_TYPE_PIXELSTREAM)
+    {
+        // read the stream id and the segments in place
+        message.staged = readPixelStreamFrame(message.data(), message.header.size, message.streamId, message.segments);
+
+        if(!message.staged)
+            put_flog(LOG_ERROR, "rank %i: invalid pixel stream frame", g_mpiRank);
+    }
+}
+
+void DisplayGroupManager::moveObjectsToThread(QThread * thread)
+{
+    moveObjectToThread(this, thread);
+    moveObjectToThread(options_.get(), thread);
+
+    for(unsigned int i=0; i<markers_.size(); i++)
+    {
+        moveObjectToThread(markers_[i].get(), thread);
+    }
+
+    ContentWindowManagerPtrs windows = contentWindowManagers_;
+    if(backgroundContent_)
+        windows.push_back(backgroundContent_);
+
+    for(unsigned int i=0; i<windows.size(); i++)
+    {
+        moveObjectToThread(windows[i].get(), thread);
+        moveObjectToThread(windows[i]->getContent().get(), thread);
+    }
+}
+
+void DisplayGroupManager::receiveDisplayGroup(const MPIMessage& message)
+{
+    // the snapshot was de-serialized by the receiving thread
+    if(message.staged)
+        g_displayGroupManager = message.displayGroup;
+}
+
+void DisplayGroupManager::receiveDisplayGroupUpdate(const MPIMessage& message)
+{
     // de-serialize...
     std::istringstream iss(std::istringstream::binary);
 
-    if(iss.rdbuf()->pubsetbuf(buf, messageHeader.size) == NULL)
+    if(iss.rdbuf()->pubsetbuf((char *)message.data(), message.header.size) == NULL)
     {
         put_flog(LOG_FATAL, "rank %i: error setting stream buffer", g_mpiRank);
         exit(-1);
     }
 
+    // patch the current replica in place; note that it may have been replaced earlier in the same frame
+    DisplayGroupManagerPtr dgm = g_displayGroupManager;
+
     boost::archive::binary_iarchive ia(iss);
-    ia >> g_displayGroupManager;
 
-    // free mpi buffer
-    delete [] buf;
-}
+    unsigned int version;
+    ia >> version;
+    if(version != dgm->version_)
+        put_flog(LOG_ERROR, "rank %i: display group update %u does not follow version %u", g_mpiRank, version, dgm->version_);
+    dgm->version_ = version + 1;
 
-void DisplayGroupManager::receiveContentsDimensionsRequest(const MessageHeader& messageHeader)
-{
-    if(g_mpiRank == 1)
+    std::map<unsigned int, ContentWindowManagerPtr> windows;
+    for(unsigned int i=0; i<dgm->contentWindowManagers_.size(); i++)
     {
-        // get dimensions of Content objects associated with each ContentWindowManager
-        // note that we must use g_displayGroupManager to access content window managers since earlier updates (in the same frame)
-        // of this display group may have occurred, and g_displayGroupManager would have then been replaced
-        std::vector<std::pair<int, int> > dimensions;
+        windows[dgm->contentWindowManagers_[i]->getId()] = dgm->contentWindowManagers_[i];
+    }
 
-        for(unsigned int i=0; i<g_displayGroupManager->contentWindowManagers_.size(); i++)
-        {
-            int w,h;
-            g_displayGroupManager->contentWindowManagers_[i]->getContent()->getFactoryObjectDimensions(w, h);
+    unsigned int modifiedWindowsCount;
+    ia >> modifiedWindowsCount;
+    for(unsigned int i=0; i<modifiedWindowsCount; i++)
+    {
+        unsigned int id;
+        ia >> id;
 
-            dimensions.push_back(std::pair<int,int>(w,h));
+        ContentWindowManagerPtr& window = windows[id];
+        if(!window)
+        {
+            window.reset(new ContentWindowManager());
+            window->id_ = id;
+            window->displayGroupManager_ = dgm;
         }
 
-        // serialize
-        std::ostringstream oss(std::ostringstream::binary);
+        // new windows always come with their content
+        bool contentModified;
+        ia >> contentModified;
+        if(contentModified)
+            ia >> window->content_;
+
+        window->serializeState(ia);
+    }
 
-        // brace this so destructor is called on archive before we use the stream
+    bool backgroundModified;
+    ia >> backgroundModified;
+    if(backgroundModified)
+    {
+        ContentWindowManagerPtr background = dgm->backgroundContent_;
+        if(!background)
         {
-            boost::archive::binary_oarchive oa(oss);
-            oa << dimensions;
+            put_flog(LOG_ERROR, "rank %i: update for a missing background window", g_mpiRank);
+            background.reset(new ContentWindowManager());
         }
 
-        // serialized data to string
-        std::string serializedString = oss.str();
-        int size = serializedString.size();
+        bool contentModified;
+        ia >> contentModified;
+        if(contentModified)
+            ia >> background->content_;
 
-        // send the header and the message
-        MessageHeader mh;
-        mh.size = size;
-        mh.type = MESSAGE_TYPE_CONTENTS_DIMENSIONS;
+        background->serializeState(ia);
+    }
+
+    bool windowsChanged;
+    ia >> windowsChanged;
+    if(windowsChanged)
+    {
+        std::vector<unsigned int> windowIds;
+        ia >> windowIds;
 
-        MPI_Send((void *)&mh, sizeof(MessageHeader), MPI_BYTE, 0, 0, MPI_COMM_WORLD);
-        MPI_Send((void *)serializedString.data(), size, MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+        ContentWindowManagerPtrs contentWindowManagers;
+        for(unsigned int i=0; i<windowIds.size(); i++)
+        {
+            if(windows[windowIds[i]])
+                contentWindowManagers.push_back(windows[windowIds[i]]);
+        }
+        dgm->contentWindowManagers_ = contentWindowManagers;
     }
+
+    bool optionsModified;
+    ia >> optionsModified;
+    if(optionsModified)
+        ia >> *dgm->options_;
+
+    bool markersModified;
+    ia >> markersModified;
+    if(markersModified)
+    {
+        QMutexLocker locker(&dgm->markersMutex_);
+        ia >> dgm->markers_;
+    }
+
+#if ENABLE_SKELETON_SUPPORT
+    bool skeletonsModified;
+    ia >> skeletonsModified;
+    if(skeletonsModified)
+        ia >> dgm->skeletons_;
+#endif
 }
 
-void DisplayGroupManager::receivePixelStreams(const MessageHeader& messageHeader)
+void DisplayGroupManager::receivePixelStreamOpen(const MPIMessage& message)
 {
-    // receive serialized data
-    char * buf = new char[messageHeader.size];
-
-    // read message into the buffer
-    MPI_Bcast((void *)buf, messageHeader.size, MPI_BYTE, 0, MPI_COMM_WORLD);
+    if(message.header.size != sizeof(PixelStreamId))
+    {
+        put_flog(LOG_ERROR, "rank %i: invalid pixel stream open message", g_mpiRank);
+        return;
+    }
 
-    // URI
-    const QString uri(messageHeader.uri);
+    PixelStreamId streamId = INVALID_PIXELSTREAM_ID;
+    memcpy(&streamId, message.data(), sizeof(PixelStreamId));
 
-    // de-serialize...
-    std::istringstream iss(std::istringstream::binary);
+    // the following frames of this stream only carry its id
+    g_pixelStreamRegistry.registerStream(QString(message.header.uri), streamId);
+}
 
-    if(iss.rdbuf()->pubsetbuf(buf, messageHeader.size) == NULL)
+void DisplayGroupManager::receivePixelStreamClose(const MPIMessage& message)
+{
+    if(message.header.size != sizeof(PixelStreamId))
     {
-        put_flog(LOG_FATAL, "rank %i: error setting stream buffer", g_mpiRank);
-        exit(-1);
+        put_flog(LOG_ERROR, "rank %i: invalid pixel stream close message", g_mpiRank);
+        return;
     }
 
-    // read to a new segments vector
-    std::vector<PixelStreamSegment> segments;
+    PixelStreamId streamId = INVALID_PIXELSTREAM_ID;
+    memcpy(&streamId, message.data(), sizeof(PixelStreamId));
 
-    boost::archive::binary_iarchive ia(iss);
-    ia >> segments;
+    // no frame of this stream follows, the ids are never reused
+    g_pixelStreamRegistry.unregisterStream(streamId);
+}
 
-    g_mainWindow->getGLWindow()->getPixelStreamFactory().getObject(uri)->insertNewFrame(segments);
+void DisplayGroupManager::receivePixelStreams(const MPIMessage& message)
+{
+    // all the ranks receive every frame message, even without segment data
+    ++receivedPixelStreamFrames_;
 
-    // free mpi buffer
-    delete [] buf;
+    // the frame was read by the receiving thread
+    if(!message.staged)
+        return;
+
+    // each rank only receives the segments it renders; the received buffer is kept with the frame,
+    // whose segments refer to it until they are replaced
+    const PixelStreamId streamId = message.streamId;
+
+    const QString uri = g_pixelStreamRegistry.getUri(streamId);
+    if(uri.isEmpty())
+        put_flog(LOG_WARN, "rank %i: received frame for unknown stream %u", g_mpiRank, streamId);
+    else
+        g_mainWindow->getGLWindow()->getPixelStreamFactory().getObject(uri)->insertNewFrame(message.segments, message.payload);
 }
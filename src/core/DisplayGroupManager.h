@@ -47,10 +47,12 @@
 
 #include <QtGui>
 #include <vector>
+#include <set>
 #ifndef Q_MOC_RUN
 // https://bugreports.qt.nokia.com/browse/QTBUG-22829: When Qt moc runs on CGAL
 // files, do not process <boost/type_traits/has_operator.hpp>
 #  include <boost/shared_ptr.hpp>
+#  include <boost/scoped_ptr.hpp>
 #  include <boost/enable_shared_from_this.hpp>
 #  include <boost/date_time/posix_time/posix_time.hpp>
 #endif
@@ -62,8 +64,12 @@
 #include "serializationHelpers.h"
 #include "types.h"
 
+// tag for the rank 1 -> rank 0 notifications
+#define MPI_TAG_PIXELSTREAMS_READY 1
+
 class ContentWindowManager;
-struct MessageHeader;
+class ContentDimensionsProber;
+struct MPIMessage;
 class EventReceiver;
 
 class DisplayGroupManager : public DisplayGroupInterface, public boost::enable_shared_from_this<DisplayGroupManager>
@@ -92,9 +98,6 @@ class DisplayGroupManager : public DisplayGroupInterface, public boost::enable_s
         void removeContentWindowManager(ContentWindowManagerPtr contentWindowManager, DisplayGroupInterface * source=NULL);
         void moveContentWindowManagerToFront(ContentWindowManagerPtr contentWindowManager, DisplayGroupInterface * source=NULL);
 
-        // find the offset between the rank 0 clock and the rank 1 clock. recall the rank 1 clock is used across rank 1 - n.
-        void calibrateTimestampOffset();
-
         QColor getBackgroundColor() const;
         void setBackgroundColor(QColor color);
 
@@ -115,6 +118,15 @@ class DisplayGroupManager : public DisplayGroupInterface, public boost::enable_s
          */
         ContentWindowManagerPtr getActiveWindow() const;
 
+        /**
+         * Deserialize a message received from rank 0 (ranks 1-n).
+         *
+         * Called by the receiving thread of the MPIChannel, so that the render loop only picks up
+         * the deserialized display group snapshots and pixel stream frames.
+         * @see MPIChannel::startReceiving()
+         */
+        static void stageMessage(MPIMessage& message);
+
 public slots:
 
         // this can be invoked from other threads to construct a DisplayGroupInterface and move it to that thread
@@ -137,14 +149,61 @@ public slots:
          */
         void hideWindow( const QString uri );
 
-        void receiveMessages();
+        /**
+         * Receive the messages sent by rank 0 (ranks 1-n).
+         * @return true if new pixel stream frames were received
+         */
+        bool receiveMessages();
+
+        /**
+         * Process the messages taken from the MPIChannel, in order (ranks 1-n).
+         *
+         * The display group snapshots among them replace g_displayGroupManager.
+         * @return true if new pixel stream frames were received
+         */
+        bool processMessages(const std::vector<MPIMessage>& messages);
+
+        /**
+         * Get the number of pixel stream frames received by this process so far (ranks 1-n).
+         *
+         * The count is kept across the display group snapshots which replace g_displayGroupManager.
+         */
+        static unsigned int getReceivedPixelStreamFrameCount();
 
+        /**
+         * Send the changes of the display group to the render processes (rank 0).
+         *
+         * Only the objects modified since the previous update are sent, unless a full snapshot is needed.
+         */
         void sendDisplayGroup();
-        void sendContentsDimensionsRequest();
-        void sendFrameClockUpdate();
-        void receiveFrameClockUpdate();
+
+        /**
+         * Send the entire display group to the render processes (rank 0).
+         */
+        void sendDisplayGroupSnapshot();
         void sendQuit();
 
+        /**
+         * Set the offset between the rank 0 clock and the rank 1 clock (rank 0).
+         * Recall the rank 1 clock is used across rank 1 - n.
+         * @see ClockSynchronizer
+         */
+        void setTimestampOffset(boost::posix_time::time_duration offset);
+
+        /**
+         * Notify rank 0 that the wall has consumed the last pixel stream frames (rank 1).
+         * The notification carries the number of frames received so far.
+         */
+        void sendPixelStreamsReady();
+
+        /**
+         * Check if the wall is ready to accept new pixel stream frames (rank 0).
+         * @param sentFrameCount The number of pixel stream frames sent so far
+         * @return true if rank 1 has notified since the last call that it consumed all these frames;
+         *         older notifications which arrive late are ignored
+         */
+        bool receivePixelStreamsReady(const unsigned int sentFrameCount);
+
         void advanceContents();
 
 #if ENABLE_SKELETON_SUPPORT
@@ -155,6 +214,12 @@ public slots:
         void closePixelStream(const QString& uri);
         void adjustPixelStreamContentDimensions(QString uri, int width, int height, bool changeViewSize);
 
+        /**
+         * Set the dimensions of the file contents once they are known (rank 0).
+         * @see ContentDimensionsProber
+         */
+        void updateContentDimensions(QString uri, int width, int height);
+
         void registerEventReceiver(QString uri, bool exclusive, EventReceiver* receiver);
 
     signals:
@@ -191,7 +256,7 @@ public slots:
         QMutex markersMutex_;
         MarkerPtrs markers_;
 
-        // frame timing
+        // frame timing, from the rank 1 clock
         boost::posix_time::ptime timestamp_;
 
 #if ENABLE_SKELETON_SUPPORT
@@ -204,10 +269,37 @@ public slots:
         typedef std::map<QString, QPointF> WindowPositions;
         WindowPositions windowPositions_;
 
+        // version of the last update sent (rank 0) or expected (ranks 1-n)
+        unsigned int version_;
+
+        // rank 0: changes since the last update sent
+        bool snapshotNeeded_;
+        std::vector<unsigned int> sentWindowIds_;
+        std::set<unsigned int> modifiedWindows_;
+        std::set<unsigned int> modifiedContents_;
+        bool backgroundModified_;
+        bool backgroundContentModified_;
+        bool optionsModified_;
+        bool markersModified_;
+        bool skeletonsModified_;
+
+        // ranks 1-n: number of pixel stream frames received, reported to rank 0 when they are consumed
+        static unsigned int receivedPixelStreamFrames_;
+
+        // rank 0: discovers the dimensions of the contents added
+        boost::scoped_ptr<ContentDimensionsProber> dimensionsProber_;
+
+        void markModified(QObject * source);
+
+        // ranks 1-n: hand the objects deserialized by the receiving thread over to another thread
+        void moveObjectsToThread(QThread * thread);
+
         // ranks 1-n recieve data through MPI
-        void receiveDisplayGroup(const MessageHeader& messageHeader);
-        void receiveContentsDimensionsRequest(const MessageHeader& messageHeader);
-        void receivePixelStreams(const MessageHeader& messageHeader);
+        void receiveDisplayGroup(const MPIMessage& message);
+        void receiveDisplayGroupUpdate(const MPIMessage& message);
+        void receivePixelStreamOpen(const MPIMessage& message);
+        void receivePixelStreamClose(const MPIMessage& message);
+        void receivePixelStreams(const MPIMessage& message);
 };
 
 #endif
@@ -92,32 +92,8 @@ DynamicTexture::DynamicTexture(QString uri, boost::shared_ptr<DynamicTexture> pa
         // see if this is an image pyramid metadata filename
         if(uri.endsWith(".pyr"))
         {
-            std::ifstream ifs(uri.toAscii());
-
-            // read the whole line
-            std::string lineString;
-            getline(ifs, lineString);
-
-            // parse the arguments, allowing escaped characters, quotes, etc., and assign them to a vector
-            std::string separator1("\\"); // allow escaped characters
-            std::string separator2(" "); // split on spaces
-            std::string separator3("\"\'"); // allow quoted arguments
-
-            boost::escaped_list_separator<char> els(separator1, separator2, separator3);
-            boost::tokenizer<boost::escaped_list_separator<char> > tok(lineString, els);
-
-            std::vector<std::string> tokVector;
-            tokVector.assign(tok.begin(), tok.end());
-
-            if(tokVector.size() < 3)
-            {
-                put_flog(LOG_ERROR, "require 3 arguments, got %i", tokVector.size());
+            if(!readPyramidMetadata(uri, imagePyramidPath_, imageWidth_, imageHeight_))
                 return;
-            }
-
-            imagePyramidPath_ = tokVector[0];
-            imageWidth_ = atoi(tokVector[1].c_str());
-            imageHeight_ = atoi(tokVector[2].c_str());
 
             useImagePyramid_ = true;
 
@@ -288,6 +264,38 @@ void DynamicTexture::loadImage(bool convertToGLFormat)
     }
 }
 
+bool DynamicTexture::readPyramidMetadata(const QString& uri, std::string& imagePyramidPath, int& width, int& height)
+{
+    std::ifstream ifs(uri.toAscii());
+
+    // read the whole line
+    std::string lineString;
+    getline(ifs, lineString);
+
+    // parse the arguments, allowing escaped characters, quotes, etc., and assign them to a vector
+    std::string separator1("\\"); // allow escaped characters
+    std::string separator2(" "); // split on spaces
+    std::string separator3("\"\'"); // allow quoted arguments
+
+    boost::escaped_list_separator<char> els(separator1, separator2, separator3);
+    boost::tokenizer<boost::escaped_list_separator<char> > tok(lineString, els);
+
+    std::vector<std::string> tokVector;
+    tokVector.assign(tok.begin(), tok.end());
+
+    if(tokVector.size() < 3)
+    {
+        put_flog(LOG_ERROR, "require 3 arguments, got %i", tokVector.size());
+        return false;
+    }
+
+    imagePyramidPath = tokVector[0];
+    width = atoi(tokVector[1].c_str());
+    height = atoi(tokVector[2].c_str());
+
+    return true;
+}
+
 void DynamicTexture::getDimensions(int &width, int &height)
 {
     // if we don't have a width and height, and the load image thread is running, wait for it to finish
@@ -302,6 +310,9 @@ void DynamicTexture::getDimensions(int &width, int &height)
 
 void DynamicTexture::render(float tX, float tY, float tW, float tH, bool computeOnDemand, bool considerChildren)
 {
+    // the GLWindows may be rendered in parallel, the root protects the whole tree
+    QMutexLocker locker(depth_ == 0 ? &renderMutex_ : 0);
+
     if(depth_ == 0)
     {
         updateRenderedFrameIndex();
@@ -382,31 +393,37 @@ void DynamicTexture::render(float tX, float tY, float tW, float tH, bool compute
 #endif
 
             // draw the texture
-            glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
+            // note we need to flip the y coordinate since the textures are loaded upside down
+            g_mainWindow->getActiveGLWindow()->getQuadBatch().addQuad(textureId_, QRectF(0., 0., 1., 1.), QRectF(tX, 1.-tY, tW, -tH));
+        }
+    }
+}
 
-            glEnable(GL_TEXTURE_2D);
-            glBindTexture(GL_TEXTURE_2D, textureId_);
+size_t DynamicTexture::getHostMemoryUsage() const
+{
+    size_t bytes = 0;
 
-            glBegin(GL_QUADS);
+    // the images are assigned by the loading thread, only count them once it is done
+    if(loadImageThreadStarted_ == true && loadImageThread_.isFinished() == true)
+        bytes += image_.byteCount() + scaledImage_.byteCount();
 
-            // note we need to flip the y coordinate since the textures are loaded upside down
-            glTexCoord2f(tX,1.-tY);
-            glVertex2f(0.,0.);
+    for(unsigned int i=0; i<children_.size(); i++)
+        bytes += children_[i]->getHostMemoryUsage();
 
-            glTexCoord2f(tX+tW,1.-tY);
-            glVertex2f(1.,0.);
+    return bytes;
+}
 
-            glTexCoord2f(tX+tW,1.-(tY+tH));
-            glVertex2f(1.,1.);
+size_t DynamicTexture::getGPUMemoryUsage() const
+{
+    size_t bytes = 0;
 
-            glTexCoord2f(tX,1.-(tY+tH));
-            glVertex2f(0.,1.);
+    if(textureBound_ == true)
+        bytes += TEXTURE_SIZE * TEXTURE_SIZE * 4;
 
-            glEnd();
+    for(unsigned int i=0; i<children_.size(); i++)
+        bytes += children_[i]->getGPUMemoryUsage();
 
-            glPopAttrib();
-        }
-    }
+    return bytes;
 }
 
 void DynamicTexture::clearOldChildren(uint64_t minFrameCount)
@@ -659,6 +676,9 @@ void DynamicTexture::uploadTexture()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+    // the other GLWindows may render the texture from their own contexts
+    glFlush();
+
     textureBound_ = true;
 
     // no longer need the scaled image
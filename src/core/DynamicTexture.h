@@ -62,10 +62,23 @@ class DynamicTexture : public boost::enable_shared_from_this<DynamicTexture>, pu
         void loadImage(bool convertToGLFormat=true); // thread needs access to this method
         void getDimensions(int &width, int &height);
         void render(float tX, float tY, float tW, float tH, bool computeOnDemand=true, bool considerChildren=true);
+
+        /** @copydoc FactoryObject::getHostMemoryUsage */
+        size_t getHostMemoryUsage() const;
+
+        /** @copydoc FactoryObject::getGPUMemoryUsage */
+        size_t getGPUMemoryUsage() const;
         void clearOldChildren(uint64_t minFrameCount); // clear children of nodes with renderChildrenFrameCount_ < minFrameCount
         void computeImagePyramid(std::string imagePyramidPath);
         void decrementThreadCount(); // thread needs access to this method
 
+        /**
+         * Read the metadata file of an image pyramid.
+         * @param uri The ".pyr" metadata file, made of the pyramid path, the image width and height
+         * @return false if the file could not be parsed
+         */
+        static bool readPyramidMetadata(const QString& uri, std::string& imagePyramidPath, int& width, int& height);
+
     private:
 
         int depth_;
@@ -73,8 +73,13 @@ void DynamicTextureContent::advance(ContentWindowManagerPtr window)
     if( blockAdvance_ )
         return;
 
+    // a culled window has no object until it is rendered, so do not create it here
+    Factory<DynamicTexture>& factory = g_mainWindow->getGLWindow()->getDynamicTextureFactory();
+    if( !factory.contains(getURI( )))
+        return;
+
     // recall that advance() is called after rendering and before g_frameCount is incremented for the current frame
-    g_mainWindow->getGLWindow()->getDynamicTextureFactory().getObject(getURI())->clearOldChildren(g_frameCount);
+    factory.getObject(getURI())->clearOldChildren(g_frameCount);
 }
 
 void DynamicTextureContent::getFactoryObjectDimensions(int &width, int &height)
@@ -41,16 +41,45 @@
 
 #include <map>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <boost/shared_ptr.hpp>
 #include <QtGui>
 
 #include "globals.h"
 
+/**
+ * Create and keep the objects of the contents, identified by their uri.
+ *
+ * The objects are referenced by the windows of the display group. When their last window closes,
+ * they are kept in a cache so that reopening them is immediate. The least recently rendered of
+ * them are only evicted when the memory used by all the objects exceeds the cache budget.
+ */
 template <class T>
 class Factory {
 
     public:
 
+        Factory()
+            : hostCacheBudget_(0)
+            , gpuCacheBudget_(0)
+        {
+        }
+
+        /**
+         * Set the memory which the objects may use before the unreferenced ones are evicted.
+         * With both budgets at 0, the objects are evicted as soon as they are unreferenced.
+         * @param hostMemory The host memory budget in bytes
+         * @param gpuMemory The GPU memory budget in bytes
+         */
+        void setCacheBudget(const size_t hostMemory, const size_t gpuMemory)
+        {
+            QMutexLocker locker(&mapMutex_);
+
+            hostCacheBudget_ = hostMemory;
+            gpuCacheBudget_ = gpuMemory;
+        }
+
         boost::shared_ptr<T> getObject(const QString& uri)
         {
             QMutexLocker locker(&mapMutex_);
@@ -85,39 +114,113 @@ class Factory {
             QMutexLocker locker(&mapMutex_);
 
             map_.clear();
+            references_.clear();
         }
 
         bool contains(const QString& uri) const
         {
+            QMutexLocker locker(&mapMutex_);
+
             return map_.count(uri);
         }
 
-        void clearStaleObjects()
+        /**
+         * Reference the object of a window of the display group. The object itself is only created
+         * by getObject(), so that windows which are not visible do not use any resources.
+         */
+        void acquireObject(const QString& uri)
+        {
+            QMutexLocker locker(&mapMutex_);
+
+            ++references_[uri];
+        }
+
+        /** Release the reference of a closed window, the object is cached after the last one. */
+        void releaseObject(const QString& uri)
+        {
+            QMutexLocker locker(&mapMutex_);
+
+            typename std::map<QString, unsigned int>::iterator it = references_.find(uri);
+            if(it == references_.end())
+                return;
+
+            if(--it->second == 0)
+                references_.erase(it);
+        }
+
+        /** Does a window of the display group reference the object. */
+        bool isReferenced(const QString& uri)
         {
             QMutexLocker locker(&mapMutex_);
 
-            typename std::map<QString, boost::shared_ptr<T> >::iterator it = map_.begin();
+            return references_.count(uri) > 0;
+        }
+
+        /**
+         * Evict the least recently rendered objects which no window references, until the memory
+         * used by all the objects fits in the cache budget.
+         */
+        void evictUnreferencedObjects()
+        {
+            QMutexLocker locker(&mapMutex_);
 
-            while(it != map_.end())
+            std::vector<ObjectIterator> unreferencedObjects;
+            for(ObjectIterator it = map_.begin(); it != map_.end(); it++)
             {
-                if(g_frameCount - it->second->getRenderedFrameIndex() > 1)
-                {
-                    map_.erase(it++);  // note the post increment; increments the iterator but returns original value for erase
-                }
-                else
-                {
-                    it++;
-                }
+                if(references_.count(it->first) == 0)
+                    unreferencedObjects.push_back(it);
+            }
+
+            // only measure the memory if there is something to evict
+            if(unreferencedObjects.empty())
+                return;
+
+            size_t hostMemory = 0;
+            size_t gpuMemory = 0;
+            for(ObjectIterator it = map_.begin(); it != map_.end(); it++)
+            {
+                hostMemory += it->second->getHostMemoryUsage();
+                gpuMemory += it->second->getGPUMemoryUsage();
+            }
+
+            std::sort(unreferencedObjects.begin(), unreferencedObjects.end(), isRenderedBefore);
+
+            const bool cacheEnabled = hostCacheBudget_ > 0 || gpuCacheBudget_ > 0;
+
+            for(size_t i=0; i<unreferencedObjects.size(); i++)
+            {
+                if(cacheEnabled && hostMemory <= hostCacheBudget_ && gpuMemory <= gpuCacheBudget_)
+                    break;
+
+                const boost::shared_ptr<T>& object = unreferencedObjects[i]->second;
+                hostMemory -= std::min(hostMemory, object->getHostMemoryUsage());
+                gpuMemory -= std::min(gpuMemory, object->getGPUMemoryUsage());
+
+                map_.erase(unreferencedObjects[i]);
             }
         }
 
     private:
 
-        // mutex for thread-safe access to map
-        QMutex mapMutex_;
+        typedef typename std::map<QString, boost::shared_ptr<T> >::iterator ObjectIterator;
+
+        // mutex for thread-safe access to map, also locked by the const accessors
+        mutable QMutex mapMutex_;
 
         // all existing objects
         std::map<QString, boost::shared_ptr<T> > map_;
+
+        // number of windows of the display group referencing each object
+        std::map<QString, unsigned int> references_;
+
+        // memory of all objects above which the unreferenced ones are evicted, in bytes
+        size_t hostCacheBudget_;
+        size_t gpuCacheBudget_;
+
+        static bool isRenderedBefore(const ObjectIterator& a, const ObjectIterator& b)
+        {
+            return a->second->getRenderedFrameIndex() < b->second->getRenderedFrameIndex();
+        }
 };
 
 #endif
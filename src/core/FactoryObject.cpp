@@ -39,11 +39,31 @@
 #include "FactoryObject.h"
 #include "globals.h"
 
+FactoryObject::FactoryObject()
+    : renderMutex_(QMutex::Recursive)
+    , renderedFrameIndex_(0)
+{
+}
+
+FactoryObject::~FactoryObject()
+{
+}
+
 uint64_t FactoryObject::getRenderedFrameIndex() const
 {
     return renderedFrameIndex_;
 }
 
+size_t FactoryObject::getHostMemoryUsage() const
+{
+    return 0;
+}
+
+size_t FactoryObject::getGPUMemoryUsage() const
+{
+    return 0;
+}
+
 void FactoryObject::updateRenderedFrameIndex()
 {
     renderedFrameIndex_ = g_frameCount;
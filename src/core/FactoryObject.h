@@ -40,23 +40,37 @@
 #define FACTORY_OBJECT_H
 
 #include <stdint.h>
+#include <cstddef>
+#include <QMutex>
 
 class FactoryObject
 {
     public:
+        FactoryObject();
+        virtual ~FactoryObject();
+
         /**
-         * Get the current frame index for this Object.
-         * Used by the Factory to check if the object is still being used/referenced
-         * by a ContentWindow.
+         * Get the index of the last frame in which this Object was rendered.
+         * The Factory keeps the objects referenced by the windows of the display group,
+         * and evicts the least recently rendered of the others first.
          */
         uint64_t getRenderedFrameIndex() const;
 
+        /** Get the host memory used by this Object in bytes, to evict cached objects. */
+        virtual size_t getHostMemoryUsage() const;
+
+        /** Get the GPU memory used by this Object in bytes, to evict cached objects. */
+        virtual size_t getGPUMemoryUsage() const;
+
     protected:
+        /** Must be called everytime a derived object is rendered. */
+        void updateRenderedFrameIndex();
+
         /**
-         * Must be called everytime a derived object is rendered.
-         * Failing that, it will be garbage collected by the factory.
+         * Must be held while rendering by the derived objects which modify their state, because the
+         * GLWindows of a process may render in parallel threads. It is recursive.
          */
-        void updateRenderedFrameIndex();
+        QMutex renderMutex_;
 
     private:
         /** Frame index when object was last rendered. */
@@ -0,0 +1,296 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "FrameProfiler.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <unistd.h>
+
+namespace
+{
+const char* framePhaseNames[FRAME_PHASE_COUNT] =
+{
+    "receive",
+    "render",
+    "barrier",
+    "swap",
+    "decode",
+    "advance",
+    "cleanup"
+};
+}
+
+const char* getFramePhaseName(const FramePhase phase)
+{
+    return (phase >= 0 && phase < FRAME_PHASE_COUNT) ? framePhaseNames[phase] : "unknown";
+}
+
+FrameProfile::FrameProfile()
+    : rankCount(0)
+    , frameCount(0)
+{
+}
+
+uint32_t FrameProfile::getDuration(const unsigned int rankIndex, const unsigned int frame, const FramePhase phase) const
+{
+    return durations[(rankIndex * frameCount + frame) * FRAME_PHASE_COUNT + phase];
+}
+
+uint32_t FrameProfile::getBusyDuration(const unsigned int rankIndex, const unsigned int frame) const
+{
+    uint32_t duration = 0;
+    for(int phase=0; phase<FRAME_PHASE_COUNT; phase++)
+    {
+        if(phase != FRAME_PHASE_BARRIER)
+            duration += getDuration(rankIndex, frame, (FramePhase)phase);
+    }
+    return duration;
+}
+
+uint32_t FrameProfile::getPercentile(const int rankIndex, const FramePhase phase, const double percentile) const
+{
+    std::vector<uint32_t> values;
+    for(unsigned int rank=0; rank<rankCount; rank++)
+    {
+        if(rankIndex >= 0 && (unsigned int)rankIndex != rank)
+            continue;
+
+        for(unsigned int frame=0; frame<frameCount; frame++)
+            values.push_back(getDuration(rank, frame, phase));
+    }
+
+    if(values.empty())
+        return 0;
+
+    // nearest rank method
+    const size_t nearestRank = (size_t)std::ceil(percentile / 100. * values.size());
+    const size_t index = std::min(std::max(nearestRank, (size_t)1), values.size()) - 1;
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+std::vector<unsigned int> FrameProfile::getSlowestRanks() const
+{
+    std::vector<unsigned int> slowestRanks(frameCount, 0);
+
+    for(unsigned int frame=0; frame<frameCount; frame++)
+    {
+        uint32_t slowestDuration = 0;
+        for(unsigned int rank=0; rank<rankCount; rank++)
+        {
+            const uint32_t duration = getBusyDuration(rank, frame);
+            if(duration > slowestDuration)
+            {
+                slowestDuration = duration;
+                slowestRanks[frame] = rank;
+            }
+        }
+    }
+    return slowestRanks;
+}
+
+FrameProfiler::FrameProfiler(MPI_Comm comm, MPI_Comm renderComm)
+    : comm_(comm)
+    , renderComm_(renderComm)
+    , phaseStart_(0)
+    , frameCount_(0)
+    , sendRequest_(MPI_REQUEST_NULL)
+{
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &size_);
+
+    timer_.setInterval(FRAMEPROFILER_POLL_INTERVAL_MS);
+    connect(&timer_, SIGNAL(timeout()), this, SLOT(receiveProfiles()));
+
+    durations_.reserve(FRAMEPROFILER_REPORT_INTERVAL * FRAME_PHASE_COUNT);
+    clock_.start();
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    // let the sends which have started complete, without notifying the receivers being destroyed
+    if(rank_ == 0 && size_ > 1)
+        receivePendingProfiles();
+
+    if(sendRequest_ == MPI_REQUEST_NULL)
+        return;
+
+    // rank 0 exits first and may not receive the last profile, so the wait is bounded
+    QElapsedTimer timer;
+    timer.start();
+
+    int completed = 0;
+    MPI_Test(&sendRequest_, &completed, MPI_STATUS_IGNORE);
+    while(!completed && timer.elapsed() < FRAMEPROFILER_SEND_TIMEOUT_MS)
+    {
+        usleep(1000);
+        MPI_Test(&sendRequest_, &completed, MPI_STATUS_IGNORE);
+    }
+
+    if(!completed)
+    {
+        put_flog(LOG_WARN, "the last frame profile was not received by rank 0");
+        MPI_Request_free(&sendRequest_);
+    }
+}
+
+void FrameProfiler::start()
+{
+    if(rank_ == 0 && size_ > 1)
+        timer_.start();
+}
+
+void FrameProfiler::startFrame()
+{
+    phaseStart_ = clock_.nsecsElapsed();
+}
+
+void FrameProfiler::finishPhase(const FramePhase phase)
+{
+    const qint64 now = clock_.nsecsElapsed();
+
+    // the phases are always finished in the same order, so they are not stored
+    assert(durations_.size() % FRAME_PHASE_COUNT == (size_t)phase && "phases must be finished in order");
+    durations_.push_back((uint32_t)((now - phaseStart_) / 1000));
+
+    phaseStart_ = now;
+}
+
+void FrameProfiler::finishFrame()
+{
+    // all render processes render the same frames, so they all send their profile together
+    if(++frameCount_ < FRAMEPROFILER_REPORT_INTERVAL)
+        return;
+
+    sendProfile();
+
+    durations_.clear();
+    frameCount_ = 0;
+}
+
+void FrameProfiler::sendProfile()
+{
+    int renderRank, renderSize;
+    MPI_Comm_rank(renderComm_, &renderRank);
+    MPI_Comm_size(renderComm_, &renderSize);
+
+    // the previous profile must have left before its buffer is reused, this only waits if rank 0 is very late
+    if(renderRank == 0)
+    {
+        MPI_Wait(&sendRequest_, MPI_STATUS_IGNORE);
+        sendBuffer_.resize(durations_.size() * renderSize);
+    }
+
+    MPI_Gather((void *)&durations_[0], durations_.size(), MPI_UINT32_T,
+               renderRank == 0 ? (void *)&sendBuffer_[0] : 0, durations_.size(), MPI_UINT32_T, 0, renderComm_);
+
+    if(renderRank == 0)
+    {
+        MPI_Isend((void *)&sendBuffer_[0], sendBuffer_.size(), MPI_UINT32_T, 0, MPI_TAG_FRAME_PROFILE, comm_, &sendRequest_);
+    }
+}
+
+const FrameProfile& FrameProfiler::getLastProfile() const
+{
+    return lastProfile_;
+}
+
+void FrameProfiler::receiveProfiles()
+{
+    if(!receivePendingProfiles())
+        return;
+
+    logProfile();
+    emit profileReceived();
+}
+
+bool FrameProfiler::receivePendingProfiles()
+{
+    int flag;
+    MPI_Status status;
+    MPI_Iprobe(1, MPI_TAG_FRAME_PROFILE, comm_, &flag, &status);
+
+    if(!flag)
+        return false;
+
+    // only the most recent profile is kept
+    while(flag)
+    {
+        int count;
+        MPI_Get_count(&status, MPI_UINT32_T, &count);
+
+        lastProfile_.durations.resize(count);
+        MPI_Recv(count > 0 ? (void *)&lastProfile_.durations[0] : 0, count, MPI_UINT32_T, 1, MPI_TAG_FRAME_PROFILE, comm_, MPI_STATUS_IGNORE);
+
+        MPI_Iprobe(1, MPI_TAG_FRAME_PROFILE, comm_, &flag, &status);
+    }
+
+    lastProfile_.rankCount = size_ - 1;
+    lastProfile_.frameCount = lastProfile_.durations.size() / (lastProfile_.rankCount * FRAME_PHASE_COUNT);
+
+    return true;
+}
+
+void FrameProfiler::logProfile() const
+{
+    std::ostringstream summary;
+    summary << "frame phases over " << lastProfile_.frameCount << " frames (p50/p95/p99 us):";
+
+    for(int phase=0; phase<FRAME_PHASE_COUNT; phase++)
+    {
+        summary << " " << getFramePhaseName((FramePhase)phase) << " "
+                << lastProfile_.getPercentile(-1, (FramePhase)phase, 50.) << "/"
+                << lastProfile_.getPercentile(-1, (FramePhase)phase, 95.) << "/"
+                << lastProfile_.getPercentile(-1, (FramePhase)phase, 99.);
+    }
+
+    // the rank which is most often the slowest holds back the wall
+    std::vector<unsigned int> slowestCounts(lastProfile_.rankCount, 0);
+    const std::vector<unsigned int> slowestRanks = lastProfile_.getSlowestRanks();
+    for(size_t i=0; i<slowestRanks.size(); i++)
+        ++slowestCounts[slowestRanks[i]];
+
+    const size_t slowestRank = std::max_element(slowestCounts.begin(), slowestCounts.end()) - slowestCounts.begin();
+    summary << "; slowest: rank " << slowestRank + 1 << " in " << slowestCounts[slowestRank] << " frames";
+
+    put_flog(LOG_INFO, "%s", summary.str().c_str());
+}
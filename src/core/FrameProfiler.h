@@ -0,0 +1,183 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <mpi.h>
+#include <stdint.h>
+#include <vector>
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// Number of frames profiled by each render process before they are sent to rank 0
+#define FRAMEPROFILER_REPORT_INTERVAL 120
+
+// Interval at which rank 0 checks for new profiles (ms)
+#define FRAMEPROFILER_POLL_INTERVAL_MS 500
+
+// Maximum time rank 1 waits for its last profile to be received when it exits (ms)
+#define FRAMEPROFILER_SEND_TIMEOUT_MS 1000
+
+// Tag of the profiles sent by rank 1 to rank 0
+#define MPI_TAG_FRAME_PROFILE 2
+
+/** The phases of a frame of the render processes, in their order of execution */
+enum FramePhase
+{
+    FRAME_PHASE_RECEIVE,    // receive the messages from rank 0
+    FRAME_PHASE_RENDER,     // render all the windows
+    FRAME_PHASE_BARRIER,    // wait for the other render processes
+    FRAME_PHASE_SWAP,       // swap the buffers of all the windows
+    FRAME_PHASE_DECODE,     // schedule the pixel stream decoding and agree on its state
+    FRAME_PHASE_ADVANCE,    // advance the contents
+    FRAME_PHASE_CLEANUP,    // clear the stale factory objects and textures
+    FRAME_PHASE_COUNT
+};
+
+/** Get the name of a phase, for the logs. */
+const char* getFramePhaseName(const FramePhase phase);
+
+/**
+ * The duration of the phases of consecutive frames on all the render processes.
+ * The durations are in microseconds.
+ */
+struct FrameProfile
+{
+    unsigned int rankCount;
+    unsigned int frameCount;
+
+    /** Indexed by render process, then frame, then phase */
+    std::vector<uint32_t> durations;
+
+    FrameProfile();
+
+    uint32_t getDuration(const unsigned int rankIndex, const unsigned int frame, const FramePhase phase) const;
+
+    /** The time spent in the frame without waiting for the other render processes. */
+    uint32_t getBusyDuration(const unsigned int rankIndex, const unsigned int frame) const;
+
+    /**
+     * Get a percentile of the duration of a phase.
+     * @param rankIndex The render process, or -1 for all of them
+     * @param phase The phase
+     * @param percentile In the range [0;100]
+     */
+    uint32_t getPercentile(const int rankIndex, const FramePhase phase, const double percentile) const;
+
+    /**
+     * Get the slowest render process of each frame, which is the one the others waited for.
+     * @return The index of the render process for each frame
+     */
+    std::vector<unsigned int> getSlowestRanks() const;
+};
+
+/**
+ * Measure how long the render processes spend in each phase of their frames.
+ *
+ * The render processes time their phases with a monotonic clock and gather the durations to
+ * rank 1 every FRAMEPROFILER_REPORT_INTERVAL frames, which sends them to rank 0 without
+ * waiting. Rank 0 polls for them, logs a summary and keeps the last profile.
+ */
+class FrameProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Construct a profiler, must be called on all ranks.
+     * @param comm The communicator in which rank 1 sends the profiles to rank 0
+     * @param renderComm The communicator of the render processes (ranks 1-n)
+     */
+    FrameProfiler(MPI_Comm comm, MPI_Comm renderComm);
+
+    /**
+     * Rank 0: receive the profiles which have arrived.
+     * Rank 1: wait for the last profile to be received, at most FRAMEPROFILER_SEND_TIMEOUT_MS.
+     */
+    ~FrameProfiler();
+
+    /** Rank 0: start polling for the profiles. */
+    void start();
+
+    /** Ranks 1-n: start timing a frame. */
+    void startFrame();
+
+    /** Ranks 1-n: finish a phase, which started at the end of the previous one. */
+    void finishPhase(const FramePhase phase);
+
+    /** Ranks 1-n: finish the frame, sending the profile every FRAMEPROFILER_REPORT_INTERVAL frames. */
+    void finishFrame();
+
+    /** Rank 0: get the last profile received. */
+    const FrameProfile& getLastProfile() const;
+
+public slots:
+    /** Rank 0: receive the profiles sent by rank 1. */
+    void receiveProfiles();
+
+signals:
+    /** Rank 0: a new profile was received. */
+    void profileReceived();
+
+private:
+    MPI_Comm comm_;
+    MPI_Comm renderComm_;
+    int rank_;
+    int size_;
+
+    QTimer timer_;
+    FrameProfile lastProfile_;
+
+    // ranks 1-n: durations of the current frames
+    QElapsedTimer clock_;
+    qint64 phaseStart_;
+    std::vector<uint32_t> durations_;
+    unsigned int frameCount_;
+
+    // rank 1: the profile being sent
+    std::vector<uint32_t> sendBuffer_;
+    MPI_Request sendRequest_;
+
+    void sendProfile();
+    bool receivePendingProfiles();
+    void logProfile() const;
+};
+
+#endif // FRAMEPROFILER_H
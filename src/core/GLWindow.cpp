@@ -45,7 +45,10 @@
 #include "MainWindow.h"
 #include "log.h"
 #include <QtOpenGL>
+#include <QtConcurrentRun>
 #include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <iterator>
 
 #ifdef __APPLE__
     #include <OpenGL/glu.h>
@@ -53,11 +56,23 @@
     #include <GL/glu.h>
 #endif
 
+namespace
+{
+void saveFrame(const QImage image, const QString filename)
+{
+    if(!image.save(filename))
+        put_flog(LOG_ERROR, "could not save frame %s", filename.toLocal8Bit().constData());
+}
+}
+
 GLWindow::GLWindow(int tileIndex)
     : configuration_(static_cast<WallConfiguration*>(g_configuration))
+    , resizePending_(true)
 {
     tileIndex_ = tileIndex;
 
+    setCacheBudgets();
+
     // disable automatic buffer swapping
     setAutoBufferSwap(false);
 }
@@ -65,6 +80,7 @@ GLWindow::GLWindow(int tileIndex)
 GLWindow::GLWindow(int tileIndex, QRect windowRect, QGLWidget * shareWidget)
   : QGLWidget(0, shareWidget)
   , configuration_(static_cast<WallConfiguration*>(g_configuration))
+  , resizePending_(true)
 {
     tileIndex_ = tileIndex;
     setGeometry(windowRect);
@@ -76,6 +92,8 @@ GLWindow::GLWindow(int tileIndex, QRect windowRect, QGLWidget * shareWidget)
         exit(-1);
     }
 
+    setCacheBudgets();
+
     // disable automatic buffer swapping
     setAutoBufferSwap(false);
 }
@@ -119,6 +137,179 @@ Factory<PixelStream> & GLWindow::getPixelStreamFactory()
     return pixelStreamFactory_;
 }
 
+void GLWindow::setCacheBudgets()
+{
+    const size_t hostMemory = configuration_->getContentCacheHostMemory();
+    const size_t gpuMemory = configuration_->getContentCacheGPUMemory();
+
+    textureFactory_.setCacheBudget(hostMemory, gpuMemory);
+    dynamicTextureFactory_.setCacheBudget(hostMemory, gpuMemory);
+    pdfFactory_.setCacheBudget(hostMemory, gpuMemory);
+    svgFactory_.setCacheBudget(hostMemory, gpuMemory);
+    movieFactory_.setCacheBudget(hostMemory, gpuMemory);
+
+    // a closed stream has no more frames to show, never keep it
+    pixelStreamFactory_.setCacheBudget(0, 0);
+}
+
+void GLWindow::updateContentReferences()
+{
+    ContentWindowManagerPtrs windows = g_displayGroupManager->getContentWindowManagers();
+
+    ContentWindowManagerPtr backgroundWindow = g_displayGroupManager->getBackgroundContentWindowManager();
+    if(backgroundWindow)
+        windows.push_back(backgroundWindow);
+
+    ContentReferences references;
+    for(ContentWindowManagerPtrs::iterator it = windows.begin(); it != windows.end(); it++)
+    {
+        ContentPtr content = (*it)->getContent();
+        references.insert(ContentReference(content->getType(), content->getURI()));
+    }
+
+    // the display group may have been replaced by a new snapshot, so compare the contents rather than the windows
+    ContentReferences acquired, released;
+    std::set_difference(references.begin(), references.end(), contentReferences_.begin(), contentReferences_.end(),
+                        std::inserter(acquired, acquired.end()));
+    std::set_difference(contentReferences_.begin(), contentReferences_.end(), references.begin(), references.end(),
+                        std::inserter(released, released.end()));
+
+    for(ContentReferences::const_iterator it = acquired.begin(); it != acquired.end(); it++)
+        updateContentReference(*it, true);
+
+    for(ContentReferences::const_iterator it = released.begin(); it != released.end(); it++)
+        updateContentReference(*it, false);
+
+    contentReferences_.swap(references);
+}
+
+template <class T>
+void updateFactoryReference(Factory<T>& factory, const QString& uri, const bool acquire)
+{
+    if(acquire)
+        factory.acquireObject(uri);
+    else
+        factory.releaseObject(uri);
+}
+
+void GLWindow::updateContentReference(const ContentReference& content, const bool acquire)
+{
+    const QString& uri = content.second;
+
+    switch(content.first)
+    {
+    case CONTENT_TYPE_TEXTURE:
+        updateFactoryReference(textureFactory_, uri, acquire);
+        break;
+    case CONTENT_TYPE_DYNAMIC_TEXTURE:
+        updateFactoryReference(dynamicTextureFactory_, uri, acquire);
+        break;
+    case CONTENT_TYPE_PDF:
+        updateFactoryReference(pdfFactory_, uri, acquire);
+        break;
+    case CONTENT_TYPE_SVG:
+        updateFactoryReference(svgFactory_, uri, acquire);
+        break;
+    case CONTENT_TYPE_MOVIE:
+        updateFactoryReference(movieFactory_, uri, acquire);
+        break;
+    case CONTENT_TYPE_PIXEL_STREAM:
+        updateFactoryReference(pixelStreamFactory_, uri, acquire);
+        break;
+    default:
+        put_flog(LOG_WARN, "unexpected content type for %s", uri.toLocal8Bit().constData());
+        break;
+    }
+}
+
+template <class T>
+void appendMemoryUsages(Factory<T>& factory, const CONTENT_TYPE type, const std::map<std::pair<CONTENT_TYPE, QString>, float>& visibleAreas,
+                        ContentMemoryUsages& usages)
+{
+    typedef std::map<QString, boost::shared_ptr<T> > Objects;
+    const Objects objects = factory.getMap();
+
+    for(typename Objects::const_iterator it = objects.begin(); it != objects.end(); ++it)
+    {
+        ContentMemoryUsage usage;
+        usage.type = type;
+        usage.uri = it->first;
+        usage.hostMemory = it->second->getHostMemoryUsage();
+        usage.gpuMemory = it->second->getGPUMemoryUsage();
+        usage.referenced = factory.isReferenced(it->first);
+        usage.renderedFrameIndex = it->second->getRenderedFrameIndex();
+
+        std::map<std::pair<CONTENT_TYPE, QString>, float>::const_iterator area = visibleAreas.find(std::make_pair(type, it->first));
+        if(area != visibleAreas.end())
+            usage.visibleArea = area->second;
+
+        // movies and pixel streams advance in every frame even when they are not visible, they would be created again
+        usage.evictable = !usage.referenced || (type != CONTENT_TYPE_MOVIE && type != CONTENT_TYPE_PIXEL_STREAM);
+
+        usages.push_back(usage);
+    }
+}
+
+ContentMemoryUsages GLWindow::getContentMemoryUsages()
+{
+    ContentWindowManagerPtrs windows = g_displayGroupManager->getContentWindowManagers();
+
+    ContentWindowManagerPtr backgroundWindow = g_displayGroupManager->getBackgroundContentWindowManager();
+    if(backgroundWindow)
+        windows.push_back(backgroundWindow);
+
+    // several windows may show the same content
+    std::map<ContentReference, float> visibleAreas;
+    for(ContentWindowManagerPtrs::iterator it = windows.begin(); it != windows.end(); it++)
+    {
+        ContentPtr content = (*it)->getContent();
+        visibleAreas[ContentReference(content->getType(), content->getURI())] += g_mainWindow->getVisibleArea((*it)->getCoordinates());
+    }
+
+    ContentMemoryUsages usages;
+    appendMemoryUsages(textureFactory_, CONTENT_TYPE_TEXTURE, visibleAreas, usages);
+    appendMemoryUsages(dynamicTextureFactory_, CONTENT_TYPE_DYNAMIC_TEXTURE, visibleAreas, usages);
+    appendMemoryUsages(pdfFactory_, CONTENT_TYPE_PDF, visibleAreas, usages);
+    appendMemoryUsages(svgFactory_, CONTENT_TYPE_SVG, visibleAreas, usages);
+    appendMemoryUsages(movieFactory_, CONTENT_TYPE_MOVIE, visibleAreas, usages);
+    appendMemoryUsages(pixelStreamFactory_, CONTENT_TYPE_PIXEL_STREAM, visibleAreas, usages);
+
+    return usages;
+}
+
+void GLWindow::evictContent(const ContentMemoryUsage& usage)
+{
+    switch(usage.type)
+    {
+    case CONTENT_TYPE_TEXTURE:
+        textureFactory_.removeObject(usage.uri);
+        break;
+    case CONTENT_TYPE_DYNAMIC_TEXTURE:
+        dynamicTextureFactory_.removeObject(usage.uri);
+        break;
+    case CONTENT_TYPE_PDF:
+        pdfFactory_.removeObject(usage.uri);
+        break;
+    case CONTENT_TYPE_SVG:
+        svgFactory_.removeObject(usage.uri);
+        break;
+    case CONTENT_TYPE_MOVIE:
+        movieFactory_.removeObject(usage.uri);
+        break;
+    case CONTENT_TYPE_PIXEL_STREAM:
+        pixelStreamFactory_.removeObject(usage.uri);
+        break;
+    default:
+        put_flog(LOG_WARN, "unexpected content type for %s", usage.uri.toLocal8Bit().constData());
+        break;
+    }
+}
+
+QuadBatch& GLWindow::getQuadBatch()
+{
+    return quadBatch_;
+}
+
 void GLWindow::insertPurgeTextureId(GLuint textureId)
 {
     QMutexLocker locker(&purgeTexturesMutex_);
@@ -144,6 +335,32 @@ void GLWindow::initializeGL()
 }
 
 void GLWindow::paintGL()
+{
+    if(resizePending_)
+    {
+        resizePending_ = false;
+        resizeGL(width(), height());
+    }
+
+    // in headless mode the window is never shown, so render in an offscreen buffer instead
+    if(configuration_->getHeadless())
+    {
+        if(!offscreenBuffer_)
+            offscreenBuffer_.reset(new QGLFramebufferObject(width(), height(), QGLFramebufferObject::Depth));
+
+        offscreenBuffer_->bind();
+    }
+
+    render();
+
+    if(offscreenBuffer_)
+    {
+        offscreenBuffer_->release();
+        dumpFrame();
+    }
+}
+
+void GLWindow::render()
 {
     setOrthographicView();
 
@@ -154,8 +371,14 @@ void GLWindow::paintGL()
         return;
     }
 
-    renderBackgroundContent();
-    renderContentWindows();
+    // All the textured quads of the screen are drawn in one flush, the borders and other
+    // overlays of the windows are drawn over them in a second pass at the same depths.
+    renderBackgroundContent(false);
+    renderContentWindows(false);
+    quadBatch_.flush();
+
+    renderBackgroundContent(true);
+    renderContentWindows(true);
 
     // Show the FPS for each window
     if (g_displayGroupManager->getOptions()->getShowStreamingStatistics())
@@ -203,16 +426,40 @@ void GLWindow::paintGL()
 
 void GLWindow::resizeGL(int width, int height)
 {
+    // recreated with the new size by the next paintGL()
+    offscreenBuffer_.reset();
+
     glViewport(0, 0, width, height);
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
+}
+
+void GLWindow::paintEvent(QPaintEvent*)
+{
+    // the next frame is rendered by updateGLWindows()
+}
+
+void GLWindow::resizeEvent(QResizeEvent*)
+{
+    resizePending_ = true;
+}
+
+void GLWindow::dumpFrame()
+{
+    const unsigned int interval = configuration_->getFrameDumpInterval();
+    if(interval == 0 || g_frameCount % interval != 0)
+        return;
+
+    const QString filename = QString("frame%1_rank%2_screen%3.png").arg((qulonglong)g_frameCount, 8, 10, QChar('0'))
+                                                                  .arg(g_mpiRank).arg(tileIndex_);
 
-    update();
+    // the frame is read back now, but encoded without holding back the rendering
+    QtConcurrent::run(saveFrame, offscreenBuffer_->toImage(), QDir(configuration_->getFrameDumpDirectory()).filePath(filename));
 }
 
-void GLWindow::renderBackgroundContent()
+void GLWindow::renderBackgroundContent(const bool overlays)
 {
     // Render background content window
     ContentWindowManagerPtr backgroundContentWindowManager = g_displayGroupManager->getBackgroundContentWindowManager();
@@ -221,13 +468,16 @@ void GLWindow::renderBackgroundContent()
         glPushMatrix();
         glTranslatef(0., 0., -1.f + std::numeric_limits<float>::epsilon());
 
-        backgroundContentWindowManager->render();
+        if (overlays)
+            backgroundContentWindowManager->renderOverlays();
+        else
+            backgroundContentWindowManager->render();
 
         glPopMatrix();
     }
 }
 
-void GLWindow::renderContentWindows()
+void GLWindow::renderContentWindows(const bool overlays)
 {
     // render content windows
     ContentWindowManagerPtrs contentWindowManagers = g_displayGroupManager->getContentWindowManagers();
@@ -236,12 +486,9 @@ void GLWindow::renderContentWindows()
     unsigned int i = 0;
     for(ContentWindowManagerPtrs::iterator it = contentWindowManagers.begin(); it != contentWindowManagers.end(); it++)
     {
-        // It is currently not possible to cull windows that are invisible as this conflics
-        // with the "garbage collection" mechanism for Contents. In fact, "stale" objects are objects
-        // which have not been rendered for more than one frame (implicitly: objects without a window)
-        // and those are destroyed by Factory::clearStaleObjects(). It is currently the only way to
-        // remove a Content.
-        //if ( isRegionVisible( (*it)->getCoordinates( )))
+        // The windows which are not on this screen are culled. Their contents are kept by the
+        // factories as long as the display group references them, see updateContentReferences().
+        if ( isRegionVisible( (*it)->getCoordinates( )))
         {
             // the visible depths are in the range (-1,1); make the content window depths be in the range (-1,0)
             const float depth = -(float)(windowCount - i) / (float)(windowCount + 1);
@@ -249,7 +496,10 @@ void GLWindow::renderContentWindows()
             glPushMatrix();
             glTranslatef(0.f, 0.f, depth);
 
-            (*it)->render();
+            if (overlays)
+                (*it)->renderOverlays();
+            else
+                (*it)->render();
             glPopMatrix();
         }
 
@@ -274,31 +524,13 @@ void GLWindow::setOrthographicView()
     // invert y-axis to put origin at lower-left corner
     glScalef(1.,-1.,1.);
 
-    // tiled display parameters
-    double tileI = (double)configuration_->getGlobalScreenIndex(tileIndex_).x();
-    double numTilesX = (double)configuration_->getTotalScreenCountX();
-    double screenWidth = (double)configuration_->getScreenWidth();
-    double mullionWidth = (double)configuration_->getMullionWidth();
-
-    double tileJ = (double)configuration_->getGlobalScreenIndex(tileIndex_).y();
-    double numTilesY = (double)configuration_->getTotalScreenCountY();
-    double screenHeight = (double)configuration_->getScreenHeight();
-    double mullionHeight = (double)configuration_->getMullionHeight();
-
-    // border calculations
-    left_ = tileI / numTilesX * ( numTilesX * screenWidth ) + tileI * mullionWidth;
-    right_ = left_ + screenWidth;
-    bottom_ = tileJ / numTilesY * ( numTilesY * screenHeight ) + tileJ * mullionHeight;
-    top_ = bottom_ + screenHeight;
-
-    // normalize to 0->1
-    double totalWidth = (double)configuration_->getTotalWidth();
-    double totalHeight = (double)configuration_->getTotalHeight();
+    // tiled display parameters, normalized to 0->1
+    const QRectF screenRect = configuration_->getNormalizedScreenRect(configuration_->getGlobalScreenIndex(tileIndex_));
 
-    left_ /= totalWidth;
-    right_ /= totalWidth;
-    bottom_ /= totalHeight;
-    top_ /= totalHeight;
+    left_ = screenRect.left();
+    right_ = screenRect.right();
+    bottom_ = screenRect.top();
+    top_ = screenRect.bottom();
 
     gluOrtho2D(left_, right_, bottom_, top_);
     glPushMatrix();
@@ -410,6 +642,14 @@ bool GLWindow::isRegionVisible(const QRectF& rect) const
     return screenRect.intersects(rect);
 }
 
+float GLWindow::getVisibleArea(const QRectF& rect) const
+{
+    const QRectF screenRect(left_, bottom_, right_-left_, top_-bottom_);
+    const QRectF visibleRect = screenRect.intersected(rect);
+
+    return visibleRect.isValid() ? visibleRect.width() * visibleRect.height() : 0.f;
+}
+
 void GLWindow::drawRectangle(double x, double y, double w, double h)
 {
     glBegin(GL_QUADS);
@@ -430,6 +670,7 @@ void GLWindow::finalize()
     svgFactory_.clear();
     movieFactory_.clear();
     pixelStreamFactory_.clear();
+    contentReferences_.clear();
 
     // The factories need to be cleared before we purge the textures
     purgeTextures();
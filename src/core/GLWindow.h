@@ -47,7 +47,13 @@
 #include "Movie.h"
 #include "PixelStream.h"
 #include "FpsCounter.h"
+#include "QuadBatch.h"
+#include "MemoryManager.h"
+#include "ContentType.h"
 #include <QGLWidget>
+#include <QGLFramebufferObject>
+#include <boost/scoped_ptr.hpp>
+#include <set>
 
 class WallConfiguration;
 
@@ -68,6 +74,24 @@ public:
     Factory<Movie> & getMovieFactory();
     Factory<PixelStream> & getPixelStreamFactory();
 
+    /**
+     * Reference the factory objects of the contents of the display group, and release those of the
+     * windows which were closed. Must be called once per frame, before rendering.
+     */
+    void updateContentReferences();
+
+    /**
+     * Get the memory used by the factory objects of all the contents, with their visibility on the
+     * screens of this process.
+     */
+    ContentMemoryUsages getContentMemoryUsages();
+
+    /** Destroy the factory object of a content to free its memory, it is created again when needed. */
+    void evictContent(const ContentMemoryUsage& usage);
+
+    /** The textured quads of the contents rendered in this window. */
+    QuadBatch& getQuadBatch();
+
     void insertPurgeTextureId(GLuint textureId);
     void purgeTextures();
 
@@ -82,6 +106,13 @@ public:
      */
     bool isRegionVisible(const QRectF& rect) const;
 
+    /**
+     * Get the area of the given region which is visible in this window.
+     * @param rect The region in normalized global screen space
+     * @return The visible area in normalized global screen space
+     */
+    float getVisibleArea(const QRectF& rect) const;
+
     /** Used by PDF and SVG renderers */
     QRectF getProjectedPixelRect(const bool clampToWindowArea);
 
@@ -96,6 +127,14 @@ protected:
     void paintGL();
     void resizeGL(int width, int height);
 
+    /**
+     * The frames are only rendered by updateGL(), possibly in a RenderThread. Expose events are
+     * ignored, and resize events are applied by the next paintGL(), so that the context is never
+     * made current by the event handlers of the GUI thread.
+     */
+    void paintEvent(QPaintEvent* event);
+    void resizeEvent(QResizeEvent* event);
+
 private:
     const WallConfiguration* configuration_;
 
@@ -107,6 +146,9 @@ private:
     double bottom_;
     double top_;
 
+    // the viewport is set for the new window size by the next paintGL()
+    bool resizePending_;
+
     Factory<Texture> textureFactory_;
     Factory<DynamicTexture> dynamicTextureFactory_;
     Factory<PDF> pdfFactory_;
@@ -121,8 +163,23 @@ private:
 
     FpsCounter fpsCounter;
 
-    void renderBackgroundContent();
-    void renderContentWindows();
+    QuadBatch quadBatch_;
+
+    // contents of the windows of the display group, as referenced in the factories
+    typedef std::pair<CONTENT_TYPE, QString> ContentReference;
+    typedef std::multiset<ContentReference> ContentReferences;
+    ContentReferences contentReferences_;
+
+    void updateContentReference(const ContentReference& content, const bool acquire);
+
+    // headless mode: the frame is rendered in this buffer instead of the window
+    boost::scoped_ptr<QGLFramebufferObject> offscreenBuffer_;
+
+    void setCacheBudgets();
+    void render();
+    void dumpFrame();
+    void renderBackgroundContent(const bool overlays);
+    void renderContentWindows(const bool overlays);
     void renderMarkers();
 
     void setOrthographicView();
@@ -52,32 +52,65 @@ ImageJpegDecompressor::~ImageJpegDecompressor()
 }
 
 QByteArray ImageJpegDecompressor::decompress(const QByteArray& jpegData)
+{
+    int width, height;
+    if(!readHeader(jpegData, width, height))
+        return QByteArray();
+
+    QByteArray decodedData;
+    decodedData.resize(height*width*tjPixelSize[TJPF_RGBX]);
+
+    if(!decompressImage(jpegData, (unsigned char *)decodedData.data(), width, height))
+        return QByteArray();
+
+    return decodedData;
+}
+
+bool ImageJpegDecompressor::decompress(const QByteArray& jpegData, unsigned char* buffer,
+                                       const int width, const int height)
+{
+    int jpegWidth, jpegHeight;
+    if(!readHeader(jpegData, jpegWidth, jpegHeight))
+        return false;
+
+    if(jpegWidth != width || jpegHeight != height)
+    {
+        put_flog(LOG_ERROR, "Jpeg image of %ix%i does not match the expected %ix%i",
+                 jpegWidth, jpegHeight, width, height);
+        return false;
+    }
+
+    return decompressImage(jpegData, buffer, width, height);
+}
+
+bool ImageJpegDecompressor::readHeader(const QByteArray& jpegData, int& width, int& height)
 {
     // get information from header
-    int width, height, jpegSubsamp;
+    int jpegSubsamp;
     int success = tjDecompressHeader2(tjHandle_, (unsigned char *)jpegData.data(), (unsigned long)jpegData.size(), &width, &height, &jpegSubsamp);
 
     if(success != 0)
     {
         put_flog(LOG_ERROR, "libjpeg-turbo header decompression failure");
-        return QByteArray();
+        return false;
     }
+    return true;
+}
 
+bool ImageJpegDecompressor::decompressImage(const QByteArray& jpegData, unsigned char* buffer,
+                                            const int width, const int height)
+{
     // decompress image data
     int pixelFormat = TJPF_RGBX; // Format for OpenGL texture (GL_RGBA)
     int pitch = width * tjPixelSize[pixelFormat];
     int flags = TJ_FASTUPSAMPLE;
 
-    QByteArray decodedData;
-    decodedData.resize(height*pitch);
-
-    success = tjDecompress2(tjHandle_, (unsigned char *)jpegData.data(), (unsigned long)jpegData.size(), (unsigned char *)decodedData.data(), width, pitch, height, pixelFormat, flags);
+    int success = tjDecompress2(tjHandle_, (unsigned char *)jpegData.data(), (unsigned long)jpegData.size(), buffer, width, pitch, height, pixelFormat, flags);
 
     if(success != 0)
     {
         put_flog(LOG_ERROR, "libjpeg-turbo image decompression failure");
-        return QByteArray();
+        return false;
     }
-
-    return decodedData;
+    return true;
 }
@@ -62,9 +62,27 @@ public:
      */
     QByteArray decompress(const QByteArray& jpegData);
 
+    /**
+     * Decompress a Jpeg image to existing memory
+     *
+     * @param jpegData The compressed Jpeg data
+     * @param buffer The memory for the decompressed image data in (GL_)RGBA
+     *        format, of size width * height * 4
+     * @param width The expected width of the image
+     * @param height The expected height of the image
+     * @return true if the image was decoded, false if it could not be decoded
+     *         or its dimensions are not the expected ones.
+     */
+    bool decompress(const QByteArray& jpegData, unsigned char* buffer,
+                    const int width, const int height);
+
 private:
     /** libjpeg-turbo handle for decompression */
     tjhandle tjHandle_;
+
+    bool readHeader(const QByteArray& jpegData, int& width, int& height);
+    bool decompressImage(const QByteArray& jpegData, unsigned char* buffer,
+                         const int width, const int height);
 };
 
 #endif // IMAGEJPEGDECOMPRESSOR_H
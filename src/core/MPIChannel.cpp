@@ -0,0 +1,634 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "MPIChannel.h"
+#include "log.h"
+
+#include <QThread>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <map>
+
+#define MPICHANNEL_TAG_PAYLOAD 0
+
+namespace
+{
+/** How the part of the payload which does not fit in the packet follows it */
+enum FollowUp
+{
+    FOLLOWUP_NONE,
+    FOLLOWUP_BROADCAST,
+    FOLLOWUP_SEND
+};
+
+/**
+ * A per-node payload starts with the offset and size of the payload of each rank of the node,
+ * relative to the end of this table. Ranks with the same payload point to the same data.
+ */
+struct NodePayloadEntry
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+void writeNodePayload(WireBuffer& buffer, const std::vector<int>& ranks, const std::vector<WireBufferPtr>& payloads)
+{
+    std::vector<NodePayloadEntry> entries(ranks.size());
+    std::map<WireBuffer*, size_t> offsets;
+    size_t dataSize = 0;
+
+    for(size_t i=0; i<ranks.size(); i++)
+    {
+        const WireBufferPtr& payload = payloads[ranks[i] - 1];
+        entries[i].size = payload ? payload->size() : 0;
+
+        std::map<WireBuffer*, size_t>::const_iterator it = offsets.find(payload.get());
+        if(it == offsets.end())
+        {
+            it = offsets.insert(std::make_pair(payload.get(), dataSize)).first;
+            dataSize += entries[i].size;
+        }
+        entries[i].offset = it->second;
+    }
+
+    const size_t tableSize = entries.size() * sizeof(NodePayloadEntry);
+    buffer.resize(tableSize + dataSize);
+    memcpy(&buffer[0], &entries[0], tableSize);
+
+    for(size_t i=0; i<ranks.size(); i++)
+    {
+        if(entries[i].size > 0)
+            memcpy(&buffer[tableSize + entries[i].offset], &(*payloads[ranks[i] - 1])[0], entries[i].size);
+    }
+}
+}
+
+struct MPIChannel::PacketHeader
+{
+    MessageHeader message;
+    uint32_t followUp;
+    /** The payload holds the payloads of all the ranks of a node, for their leader */
+    uint32_t perNode;
+};
+#define PACKET_INLINE_CAPACITY (MPICHANNEL_PACKET_SIZE - sizeof(PacketHeader))
+
+class MPIChannel::SendThread : public QThread
+{
+public:
+    SendThread(MPIChannel& channel)
+        : channel_(channel)
+    {
+    }
+
+protected:
+    void run()
+    {
+        while(channel_.sendNext())
+        {
+        }
+    }
+
+private:
+    MPIChannel& channel_;
+};
+
+class MPIChannel::ReceiveThread : public QThread
+{
+public:
+    ReceiveThread(MPIChannel& channel)
+        : channel_(channel)
+    {
+    }
+
+protected:
+    void run()
+    {
+        bool quit = false;
+        while(!quit)
+        {
+            MPIMessage message = channel_.receive();
+            quit = (message.header.type == MESSAGE_TYPE_QUIT);
+
+            // the message only becomes visible to the render loop once it is staged
+            if(channel_.staging_)
+                channel_.staging_(message);
+
+            QMutexLocker locker(&channel_.messagesMutex_);
+            channel_.messages_.push_back(message);
+            ++channel_.receivedCount_;
+        }
+    }
+
+private:
+    MPIChannel& channel_;
+};
+
+MPIMessage::MPIMessage()
+    : staged(false)
+    , streamId(INVALID_PIXELSTREAM_ID)
+{
+}
+
+const char* MPIMessage::data() const
+{
+    return (payload && !payload->empty()) ? &(*payload)[0] : 0;
+}
+
+MPIChannel::MPIChannel(MPI_Comm comm)
+    : leaderComm_(MPI_COMM_NULL)
+    , nodeComm_(MPI_COMM_NULL)
+    , nodeRank_(0)
+    , nodeWindow_(MPI_WIN_NULL)
+    , nodeMemory_(0)
+    , sendThread_(0)
+    , queuedCount_(0)
+    , sentCount_(0)
+    , stopSending_(false)
+    , receiveThread_(0)
+    , staging_(0)
+    , receivePacket_(MPICHANNEL_PACKET_SIZE)
+    , receivedCount_(0)
+    , takenCount_(0)
+{
+    MPI_Comm_dup(comm, &comm_);
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &size_);
+
+    setupNodes();
+
+    if(rank_ == 0 && size_ > 1)
+    {
+        sendThread_ = new SendThread(*this);
+        sendThread_->start();
+    }
+}
+
+MPIChannel::~MPIChannel()
+{
+    if(sendThread_)
+    {
+        {
+            QMutexLocker locker(&outgoingMutex_);
+            stopSending_ = true;
+            outgoingCondition_.wakeAll();
+        }
+        sendThread_->wait();
+        delete sendThread_;
+    }
+
+    if(receiveThread_)
+    {
+        // the thread ends after receiving MESSAGE_TYPE_QUIT
+        receiveThread_->wait();
+        delete receiveThread_;
+    }
+
+#if MPI_VERSION >= 3
+    if(nodeWindow_ != MPI_WIN_NULL)
+    {
+        MPI_Win_unlock_all(nodeWindow_);
+        MPI_Win_free(&nodeWindow_);
+    }
+#endif
+    if(nodeComm_ != MPI_COMM_NULL)
+        MPI_Comm_free(&nodeComm_);
+    if(leaderComm_ != MPI_COMM_NULL)
+        MPI_Comm_free(&leaderComm_);
+
+    MPI_Comm_free(&comm_);
+}
+
+void MPIChannel::setupNodes()
+{
+#if MPI_VERSION >= 3
+    // rank 0 only sends, so it is never part of a node
+    MPI_Comm_split_type(comm_, rank_ == 0 ? MPI_UNDEFINED : MPI_COMM_TYPE_SHARED, rank_, MPI_INFO_NULL, &nodeComm_);
+
+    int leader = 0;
+    if(nodeComm_ != MPI_COMM_NULL)
+    {
+        MPI_Comm_rank(nodeComm_, &nodeRank_);
+        leader = rank_;
+        MPI_Bcast(&leader, 1, MPI_INT, 0, nodeComm_);
+    }
+
+    std::vector<int> leaders(size_);
+    MPI_Allgather(&leader, 1, MPI_INT, &leaders[0], 1, MPI_INT, comm_);
+
+    // relaying only pays off if a node runs several ranks
+    bool sharedNodes = false;
+    for(int i=1; i<size_; i++)
+    {
+        sharedNodes = sharedNodes || (leaders[i] != i);
+    }
+
+    if(!sharedNodes)
+    {
+        if(nodeComm_ != MPI_COMM_NULL)
+            MPI_Comm_free(&nodeComm_);
+        return;
+    }
+
+    // rank 0 keeps rank 0, and the leaders are ordered like their ranks
+    MPI_Comm_split(comm_, (rank_ == 0 || leader == rank_) ? 0 : MPI_UNDEFINED, rank_, &leaderComm_);
+
+    if(rank_ == 0)
+    {
+        std::map<int, std::vector<int> > nodes;
+        for(int i=1; i<size_; i++)
+        {
+            nodes[leaders[i]].push_back(i);
+        }
+        for(std::map<int, std::vector<int> >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+        {
+            nodeRanks_.push_back(it->second);
+        }
+
+        put_flog(LOG_INFO, "%i ranks on %i nodes", size_ - 1, (int)nodeRanks_.size());
+        return;
+    }
+
+    // the leader allocates the memory of the node, the other ranks get a pointer to it
+    MPI_Win_allocate_shared(nodeRank_ == 0 ? MPICHANNEL_NODE_MEMORY_SIZE : 0, 1, MPI_INFO_NULL, nodeComm_,
+                            &nodeMemory_, &nodeWindow_);
+    if(nodeRank_ != 0)
+    {
+        MPI_Aint size;
+        int displacementUnit;
+        MPI_Win_shared_query(nodeWindow_, 0, &size, &displacementUnit, &nodeMemory_);
+    }
+
+    // the accesses are synchronized by the messages within the node
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, nodeWindow_);
+#endif
+}
+
+void MPIChannel::broadcast(const MessageType type, const char* data, const size_t size, const std::string& uri)
+{
+    if(size_ < 2)
+        return;
+
+    OutgoingMessage message;
+    message.header = MessageHeader(type, size, uri);
+    message.scatter = false;
+
+    // the caller's data may change as soon as this returns
+    WireBufferPtr payload = broadcastBuffers_.getBuffer(size);
+    if(size > 0)
+        memcpy(&(*payload)[0], data, size);
+    message.payloads.push_back(payload);
+
+    post(message);
+}
+
+unsigned int MPIChannel::scatter(const MessageType type, const std::vector<WireBufferPtr>& payloads)
+{
+    if(size_ < 2)
+        return 0;
+
+    assert(payloads.size() == (size_t)(size_ - 1) && "scatter() needs one payload per rank");
+
+    OutgoingMessage message;
+    message.header = MessageHeader(type, 0);
+    message.scatter = true;
+    message.payloads = payloads;
+
+    post(message);
+    return message.sequence;
+}
+
+MPISentMessages MPIChannel::takeSentMessages()
+{
+    QMutexLocker locker(&outgoingMutex_);
+
+    MPISentMessages sentMessages;
+    sentMessages.swap(sentMessages_);
+    return sentMessages;
+}
+
+void MPIChannel::waitUntilSent()
+{
+    QMutexLocker locker(&outgoingMutex_);
+
+    while(sentCount_ != queuedCount_)
+    {
+        outgoingCondition_.wait(&outgoingMutex_);
+    }
+}
+
+void MPIChannel::post(OutgoingMessage& message)
+{
+    QMutexLocker locker(&outgoingMutex_);
+
+    message.sequence = queuedCount_++;
+    outgoing_.push_back(message);
+    outgoingCondition_.wakeAll();
+}
+
+bool MPIChannel::sendNext()
+{
+    OutgoingMessage message;
+    {
+        QMutexLocker locker(&outgoingMutex_);
+
+        while(outgoing_.empty() && !stopSending_)
+        {
+            outgoingCondition_.wait(&outgoingMutex_);
+        }
+
+        // the queued messages are all sent before stopping
+        if(outgoing_.empty())
+            return false;
+
+        message = outgoing_.front();
+        outgoing_.pop_front();
+    }
+
+    const boost::posix_time::ptime sendStart = boost::posix_time::microsec_clock::universal_time();
+    const size_t sentSize = send(message);
+    const boost::posix_time::time_duration duration = boost::posix_time::microsec_clock::universal_time() - sendStart;
+
+    QMutexLocker locker(&outgoingMutex_);
+
+    ++sentCount_;
+    if(message.scatter)
+    {
+        MPISentMessage sentMessage;
+        sentMessage.sequence = message.sequence;
+        sentMessage.size = sentSize;
+        sentMessage.duration = duration;
+        sentMessages_.push_back(sentMessage);
+    }
+    outgoingCondition_.wakeAll();
+
+    // the payloads are released for reuse when message goes out of scope
+    return true;
+}
+
+size_t MPIChannel::send(const OutgoingMessage& message)
+{
+    if(leaderComm_ == MPI_COMM_NULL)
+        return send(comm_, message, message.payloads, false);
+
+    if(!message.scatter)
+        return send(leaderComm_, message, message.payloads, false);
+
+    // each leader receives the distinct payloads of the ranks of its node at once
+    std::vector<WireBufferPtr> nodePayloads;
+    for(size_t i=0; i<nodeRanks_.size(); i++)
+    {
+        WireBufferPtr nodePayload = nodeBuffers_.getBuffer(0);
+        writeNodePayload(*nodePayload, nodeRanks_[i], message.payloads);
+        nodePayloads.push_back(nodePayload);
+    }
+
+    return send(leaderComm_, message, nodePayloads, true);
+}
+
+size_t MPIChannel::send(MPI_Comm comm, const OutgoingMessage& message, const std::vector<WireBufferPtr>& payloads,
+                        const bool perNode)
+{
+    int commSize;
+    MPI_Comm_size(comm, &commSize);
+
+    packets_.resize(commSize * MPICHANNEL_PACKET_SIZE);
+
+    // each rank gets its own packet, which is the same for all of them when broadcasting
+    for(int i=1; i<commSize; i++)
+    {
+        const WireBufferPtr& payload = message.scatter ? payloads[i-1] : payloads[0];
+        const size_t size = payload ? payload->size() : 0;
+
+        PacketHeader packetHeader;
+        packetHeader.message = MessageHeader(message.header.type, size, message.header.uri);
+        packetHeader.followUp = FOLLOWUP_NONE;
+        if(size > PACKET_INLINE_CAPACITY)
+            packetHeader.followUp = message.scatter ? FOLLOWUP_SEND : FOLLOWUP_BROADCAST;
+        packetHeader.perNode = perNode;
+
+        writePacket(&packets_[i * MPICHANNEL_PACKET_SIZE], packetHeader, (size > 0) ? &(*payload)[0] : 0);
+    }
+
+    MPI_Scatter((void *)&packets_[0], MPICHANNEL_PACKET_SIZE, MPI_BYTE,
+                MPI_IN_PLACE, MPICHANNEL_PACKET_SIZE, MPI_BYTE, 0, comm);
+
+    if(!message.scatter)
+    {
+        const WireBuffer& payload = *payloads[0];
+        if(payload.size() > PACKET_INLINE_CAPACITY)
+        {
+            MPI_Bcast((void *)(&payload[0] + PACKET_INLINE_CAPACITY), payload.size() - PACKET_INLINE_CAPACITY,
+                      MPI_BYTE, 0, comm);
+        }
+        return payload.size();
+    }
+
+    // the rest of the payloads only goes to the ranks which have more data
+    size_t sentSize = 0;
+    std::vector<MPI_Request> requests;
+    for(int i=1; i<commSize; i++)
+    {
+        const WireBufferPtr& payload = payloads[i-1];
+        if(!payload)
+            continue;
+
+        sentSize += payload->size();
+        if(payload->size() <= PACKET_INLINE_CAPACITY)
+            continue;
+
+        MPI_Request request;
+        MPI_Isend((void *)(&(*payload)[0] + PACKET_INLINE_CAPACITY), payload->size() - PACKET_INLINE_CAPACITY,
+                  MPI_BYTE, i, MPICHANNEL_TAG_PAYLOAD, comm, &request);
+        requests.push_back(request);
+    }
+
+    if(!requests.empty())
+    {
+        MPI_Waitall(requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+    }
+
+    return sentSize;
+}
+
+void MPIChannel::startReceiving(MPIMessageStaging staging)
+{
+    if(rank_ == 0 || receiveThread_)
+    {
+        put_flog(LOG_WARN, "called by rank %i", rank_);
+        return;
+    }
+
+    staging_ = staging;
+    receiveThread_ = new ReceiveThread(*this);
+    receiveThread_->start();
+}
+
+unsigned int MPIChannel::getReceivedCount() const
+{
+    QMutexLocker locker(&messagesMutex_);
+    return receivedCount_;
+}
+
+MPIMessages MPIChannel::takeMessages(const unsigned int receivedCount)
+{
+    QMutexLocker locker(&messagesMutex_);
+
+    MPIMessages messages;
+    while(takenCount_ < receivedCount && !messages_.empty())
+    {
+        messages.push_back(messages_.front());
+        messages_.pop_front();
+        ++takenCount_;
+    }
+    return messages;
+}
+
+MPIMessage MPIChannel::receive()
+{
+    if(nodeComm_ != MPI_COMM_NULL)
+        return receiveThroughNode();
+
+    const PacketHeader packetHeader = receivePacket(comm_);
+
+    MPIMessage message;
+    message.header = packetHeader.message;
+    message.payload = payloadBuffers_.getBuffer(message.header.size);
+    if(message.header.size > 0)
+        receivePayload(comm_, packetHeader, &(*message.payload)[0]);
+
+    return message;
+}
+
+MPIMessage MPIChannel::receiveThroughNode()
+{
+    // the leader receives the message in the memory of the node, unless it does not fit
+    PacketHeader packetHeader;
+    if(nodeRank_ == 0)
+    {
+        packetHeader = receivePacket(leaderComm_);
+
+        const size_t size = packetHeader.message.size;
+        if(size > MPICHANNEL_NODE_MEMORY_SIZE)
+            relayBuffer_.resize(size);
+        if(size > 0)
+            receivePayload(leaderComm_, packetHeader, size > MPICHANNEL_NODE_MEMORY_SIZE ? &relayBuffer_[0] : nodeMemory_);
+    }
+
+#if MPI_VERSION >= 3
+    MPI_Win_sync(nodeWindow_);
+#endif
+    MPI_Bcast((void *)&packetHeader, sizeof(PacketHeader), MPI_BYTE, 0, nodeComm_);
+
+    const size_t size = packetHeader.message.size;
+    const bool shared = (size <= MPICHANNEL_NODE_MEMORY_SIZE);
+    const char* nodePayload = nodeMemory_;
+    if(shared)
+    {
+#if MPI_VERSION >= 3
+        MPI_Win_sync(nodeWindow_);
+#endif
+    }
+    else
+    {
+        relayBuffer_.resize(size);
+        MPI_Bcast((void *)&relayBuffer_[0], size, MPI_BYTE, 0, nodeComm_);
+        nodePayload = &relayBuffer_[0];
+    }
+
+    // each rank only keeps its own part of a per-node message
+    const char* data = nodePayload;
+    size_t dataSize = size;
+    if(packetHeader.perNode)
+    {
+        NodePayloadEntry entry;
+        memcpy(&entry, nodePayload + nodeRank_ * sizeof(NodePayloadEntry), sizeof(NodePayloadEntry));
+
+        int nodeSize;
+        MPI_Comm_size(nodeComm_, &nodeSize);
+        data = nodePayload + nodeSize * sizeof(NodePayloadEntry) + entry.offset;
+        dataSize = entry.size;
+    }
+
+    MPIMessage message;
+    message.header = packetHeader.message;
+    message.header.size = dataSize;
+    message.payload = payloadBuffers_.getBuffer(dataSize);
+    if(dataSize > 0)
+        memcpy(&(*message.payload)[0], data, dataSize);
+
+    // the leader can only receive the next message once all the ranks have their copy
+    if(shared && size > 0)
+        MPI_Barrier(nodeComm_);
+
+    return message;
+}
+
+MPIChannel::PacketHeader MPIChannel::receivePacket(MPI_Comm comm)
+{
+    MPI_Scatter(0, 0, MPI_BYTE, (void *)&receivePacket_[0], MPICHANNEL_PACKET_SIZE, MPI_BYTE, 0, comm);
+
+    PacketHeader packetHeader;
+    memcpy(&packetHeader, &receivePacket_[0], sizeof(PacketHeader));
+    return packetHeader;
+}
+
+void MPIChannel::receivePayload(MPI_Comm comm, const PacketHeader& packetHeader, char* data)
+{
+    const size_t size = packetHeader.message.size;
+    memcpy(data, &receivePacket_[sizeof(PacketHeader)], std::min(size, PACKET_INLINE_CAPACITY));
+
+    if(packetHeader.followUp == FOLLOWUP_BROADCAST)
+    {
+        MPI_Bcast((void *)(data + PACKET_INLINE_CAPACITY), size - PACKET_INLINE_CAPACITY, MPI_BYTE, 0, comm);
+    }
+    else if(packetHeader.followUp == FOLLOWUP_SEND)
+    {
+        MPI_Recv((void *)(data + PACKET_INLINE_CAPACITY), size - PACKET_INLINE_CAPACITY, MPI_BYTE,
+                 0, MPICHANNEL_TAG_PAYLOAD, comm, MPI_STATUS_IGNORE);
+    }
+}
+
+void MPIChannel::writePacket(char* packet, const PacketHeader& packetHeader, const char* data)
+{
+    memcpy(packet, &packetHeader, sizeof(PacketHeader));
+
+    const size_t inlineSize = std::min((size_t)packetHeader.message.size, PACKET_INLINE_CAPACITY);
+    if(inlineSize > 0)
+        memcpy(packet + sizeof(PacketHeader), data, inlineSize);
+}
@@ -0,0 +1,248 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef MPICHANNEL_H
+#define MPICHANNEL_H
+
+#include "MessageHeader.h"
+#include "WireFormat.h"
+#include "types.h"
+
+#include <mpi.h>
+#include <deque>
+#include <vector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+// Size of the fixed packet starting each message, which carries small payloads inline
+#define MPICHANNEL_PACKET_SIZE 4096
+
+// Size of the memory shared by the ranks of a node, larger payloads are relayed with a broadcast
+#define MPICHANNEL_NODE_MEMORY_SIZE (64 * 1024 * 1024)
+
+/** A message received from rank 0 */
+struct MPIMessage
+{
+    MessageHeader header;
+
+    /** The payload, of header.size bytes */
+    WireBufferPtr payload;
+
+    /** Has the payload been deserialized by the receiving thread into the following fields */
+    bool staged;
+
+    /** Staged MESSAGE_TYPE_CONTENTS: the new display group */
+    DisplayGroupManagerPtr displayGroup;
+
+    /** Staged MESSAGE_TYPE_PIXELSTREAM: the frame, whose segments refer to the payload */
+    PixelStreamId streamId;
+    PixelStreamSegments segments;
+
+    MPIMessage();
+
+    /** The payload data, or NULL if it is empty. */
+    const char* data() const;
+};
+
+typedef std::vector<MPIMessage> MPIMessages;
+
+/** Deserialize a message in the receiving thread, before the render loop can take it. */
+typedef void (*MPIMessageStaging)(MPIMessage& message);
+
+/** A scattered message which rank 0 has finished sending */
+struct MPISentMessage
+{
+    /** The number returned by MPIChannel::scatter() */
+    unsigned int sequence;
+
+    /** The size of the payloads sent to all ranks */
+    size_t size;
+
+    /** The time spent sending the message, without the time it waited in the queue */
+    boost::posix_time::time_duration duration;
+};
+
+typedef std::vector<MPISentMessage> MPISentMessages;
+
+/**
+ * Send messages from rank 0 to all the other ranks.
+ *
+ * Each message starts with a single MPI_Scatter of fixed-size packets holding the header together
+ * with the beginning of the payload, so small messages cost one collective instead of one send per
+ * rank followed by a broadcast. The rest of a large payload follows as a broadcast when it is the
+ * same for all ranks, or as a point-to-point transfer to the ranks which have their own payload.
+ *
+ * On rank 0, the messages are queued and sent by a thread, so that the caller never waits for the
+ * interconnect. Their payloads are kept in pooled buffers until they have left.
+ *
+ * On ranks 1-n, a thread receives the messages as soon as they arrive, deserializes them into a
+ * staging queue and makes them available once complete, so that the render loop only has to agree
+ * on how many of them to process.
+ *
+ * When several ranks run on the same node, only one of them, the node leader, receives the messages
+ * from rank 0. It receives them in a shared memory window of the node, from which the other ranks
+ * copy them, so the interconnect carries each message once per node. A scattered message is sent
+ * to the leader as the set of distinct payloads of the ranks of its node.
+ *
+ * The channel uses its own communicators, so that its collectives never mix with other MPI traffic.
+ */
+class MPIChannel
+{
+public:
+    /**
+     * Construct a channel, must be called on all ranks of the communicator.
+     * @param comm The communicator to duplicate, rank 0 being the sender
+     */
+    MPIChannel(MPI_Comm comm);
+
+    /** Finish sending the queued messages or stop receiving, and free the communicator. */
+    ~MPIChannel();
+
+    /**
+     * Rank 0: queue the same message for all other ranks.
+     * Calls must not overlap, the messages are received in the order they are queued.
+     * @param type The type of the message
+     * @param data The payload, copied before returning
+     * @param size The size of the payload
+     * @param uri Optional uri stored in the header
+     */
+    void broadcast(const MessageType type, const char* data, const size_t size, const std::string& uri = "");
+
+    /**
+     * Rank 0: queue a different message for each other rank.
+     * @param type The type of the messages
+     * @param payloads The payload for each rank 1 to n, NULL pointers meaning an empty payload.
+     *        The buffers are referenced until the message has been sent and must not be modified.
+     * @return The sequence number of the message, reported by takeSentMessages() once it has been sent
+     */
+    unsigned int scatter(const MessageType type, const std::vector<WireBufferPtr>& payloads);
+
+    /** Rank 0: take the scattered messages which have been sent since the last call. */
+    MPISentMessages takeSentMessages();
+
+    /** Rank 0: wait until all the queued messages have been sent. */
+    void waitUntilSent();
+
+    /**
+     * Ranks 1-n: start the thread receiving the messages, until MESSAGE_TYPE_QUIT.
+     * @param staging Optional function called by the thread for each message it receives
+     */
+    void startReceiving(MPIMessageStaging staging = 0);
+
+    /** Ranks 1-n: the number of messages received so far. */
+    unsigned int getReceivedCount() const;
+
+    /**
+     * Ranks 1-n: take the messages not taken yet.
+     * @param receivedCount Only take the messages among the first receivedCount received,
+     *        as returned by getReceivedCount() on this or on any other rank
+     */
+    MPIMessages takeMessages(const unsigned int receivedCount);
+
+private:
+    class ReceiveThread;
+    friend class ReceiveThread;
+    class SendThread;
+    friend class SendThread;
+    struct PacketHeader;
+
+    struct OutgoingMessage
+    {
+        unsigned int sequence;
+        MessageHeader header;
+        bool scatter;
+        std::vector<WireBufferPtr> payloads;
+    };
+
+    MPI_Comm comm_;
+    int rank_;
+    int size_;
+
+    // ranks sharing a node receive through their leader, if any node runs several ranks 1-n
+    MPI_Comm leaderComm_; // rank 0 and the node leaders, MPI_COMM_NULL on the other ranks
+    MPI_Comm nodeComm_; // ranks 1-n of the same node, MPI_COMM_NULL on rank 0
+    int nodeRank_;
+    MPI_Win nodeWindow_;
+    char* nodeMemory_;
+    std::vector<char> relayBuffer_;
+
+    // rank 0: the ranks of the node of each leader, and the pooled buffers of their payloads
+    std::vector<std::vector<int> > nodeRanks_;
+    WireBufferPool nodeBuffers_;
+
+    // rank 0: sending thread, its queue and the pooled buffers of the broadcast payloads
+    SendThread* sendThread_;
+    QMutex outgoingMutex_;
+    QWaitCondition outgoingCondition_;
+    std::deque<OutgoingMessage> outgoing_;
+    unsigned int queuedCount_;
+    unsigned int sentCount_;
+    bool stopSending_;
+    MPISentMessages sentMessages_;
+    WireBufferPool broadcastBuffers_;
+
+    // rank 0: the packets of all ranks for the scatter, used by the sending thread
+    std::vector<char> packets_;
+
+    // ranks 1-n: receiving thread and its reused buffers
+    ReceiveThread* receiveThread_;
+    MPIMessageStaging staging_;
+    std::vector<char> receivePacket_;
+    WireBufferPool payloadBuffers_;
+
+    // ranks 1-n: messages received and not taken yet
+    mutable QMutex messagesMutex_;
+    std::deque<MPIMessage> messages_;
+    unsigned int receivedCount_;
+    unsigned int takenCount_;
+
+    void setupNodes();
+    void post(OutgoingMessage& message);
+    bool sendNext();
+    size_t send(const OutgoingMessage& message);
+    size_t send(MPI_Comm comm, const OutgoingMessage& message, const std::vector<WireBufferPtr>& payloads,
+                const bool perNode);
+    MPIMessage receive();
+    MPIMessage receiveThroughNode();
+    PacketHeader receivePacket(MPI_Comm comm);
+    void receivePayload(MPI_Comm comm, const PacketHeader& packetHeader, char* data);
+    void writePacket(char* packet, const PacketHeader& packetHeader, const char* data);
+};
+
+#endif // MPICHANNEL_H
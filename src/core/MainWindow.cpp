@@ -53,6 +53,7 @@
 #include "localstreamer/DockPixelStreamer.h"
 
 #include "GLWindow.h"
+#include "RenderThread.h"
 
 #if ENABLE_PYTHON_SUPPORT
     #include "PythonConsole.h"
@@ -67,7 +68,10 @@
 #define DOCK_WIDTH_RELATIVE_TO_WALL   0.175
 
 MainWindow::MainWindow()
-    : backgroundWidget_(0)
+    : pixelStreamFramesPending_(false)
+    , decodingAgreementRequest_(MPI_REQUEST_NULL)
+    , frameProfiler_(MPI_COMM_WORLD, g_mpiRenderComm)
+    , backgroundWidget_(0)
 #if ENABLE_TUIO_TOUCH_LISTENER
     , touchListener_(0)
 #endif
@@ -89,10 +93,17 @@ MainWindow::MainWindow()
         setupMasterWindowUI();
 
         show();
+
+        frameProfiler_.start();
     }
     else
     {
         setupWallOpenGLWindows();
+        setupRenderThreads();
+
+        pixelStreamScheduler_.setBudget(static_cast<WallConfiguration*>(g_configuration)->getPixelStreamDecodeBudget());
+
+        setupMemoryBudget();
 
         // setup connection so updateGLWindows() will be called continuously
         // must be queued so we return to the main event loop and avoid infinite recursion
@@ -349,6 +360,12 @@ void MainWindow::setupWallOpenGLWindows()
 
     WallConfiguration* configuration = static_cast<WallConfiguration*>(g_configuration);
 
+    if(configuration->getHeadless())
+    {
+        setupHeadlessOpenGLWindows();
+        return;
+    }
+
     if(configuration->getScreenCount() == 1)
     {
         move(configuration->getScreenPosition(0));
@@ -397,6 +414,25 @@ void MainWindow::setupWallOpenGLWindows()
     }
 }
 
+void MainWindow::setupHeadlessOpenGLWindows()
+{
+    WallConfiguration* configuration = static_cast<WallConfiguration*>(g_configuration);
+
+    for(int i=0; i<configuration->getScreenCount(); i++)
+    {
+        // the windows are only shown to get their OpenGL context, they render offscreen
+        QRect windowRect = QRect(QPoint(0, 0), QSize(configuration->getScreenWidth(), configuration->getScreenHeight()));
+
+        GLWindow * shareWidget = (i > 0) ? glWindows_[0].get() : NULL;
+
+        GLWindowPtr glw(new GLWindow(i, windowRect, shareWidget));
+        glw->setAttribute(Qt::WA_DontShowOnScreen);
+        glWindows_.push_back(glw);
+
+        glw->show();
+    }
+}
+
 GLWindowPtr MainWindow::getGLWindow(int index)
 {
     return glWindows_[index];
@@ -404,9 +440,25 @@ GLWindowPtr MainWindow::getGLWindow(int index)
 
 GLWindowPtr MainWindow::getActiveGLWindow()
 {
+    // with render threads, each GLWindow is rendered with its context current in its thread
+    if(!renderThreads_.empty())
+    {
+        const QGLContext* context = QGLContext::currentContext();
+        for(size_t i=0; i<glWindows_.size(); i++)
+        {
+            if(glWindows_[i]->context() == context)
+                return glWindows_[i];
+        }
+    }
+
     return activeGLWindow_;
 }
 
+const FrameProfiler& MainWindow::getFrameProfiler() const
+{
+    return frameProfiler_;
+}
+
 bool MainWindow::isRegionVisible(double x, double y, double w, double h) const
 {
     for(unsigned int i=0; i<glWindows_.size(); i++)
@@ -419,6 +471,19 @@ bool MainWindow::isRegionVisible(double x, double y, double w, double h) const
     return false;
 }
 
+float MainWindow::getVisibleArea(const QRectF& rect) const
+{
+    float area = 0.f;
+    for(unsigned int i=0; i<glWindows_.size(); i++)
+        area += glWindows_[i]->getVisibleArea(rect);
+    return area;
+}
+
+const MemoryManager& MainWindow::getMemoryManager() const
+{
+    return memoryManager_;
+}
+
 void MainWindow::openContent()
 {
     QString filename = QFileDialog::getOpenFileName(this, tr("Choose content"), QString(), ContentFactory::getSupportedFilesFilterAsString());
@@ -731,66 +796,280 @@ void MainWindow::openDock(const QPointF pos)
 
 void MainWindow::updateGLWindows()
 {
+    frameProfiler_.startFrame();
+
     if( g_displayGroupManager->getOptions()->getShowMouseCursor( ))
         unsetCursor();
     else
         setCursor( QCursor( Qt::BlankCursor ));
 
-    // receive any waiting messages
-    g_displayGroupManager->receiveMessages();
-
-    // synchronize clock
-    // do this right after receiving messages to ensure we have an accurate clock for rendering, etc. below
-    if(g_mpiRank == 1)
+    // receive any waiting messages, together with the frame clock used for rendering, etc. below
+    if(g_displayGroupManager->receiveMessages())
     {
-        g_displayGroupManager->sendFrameClockUpdate();
+        pixelStreamFramesPending_ = true;
     }
-    else
+
+    // the contents of the windows which were closed are released
+    if(glWindows_.size() > 0)
     {
-        g_displayGroupManager->receiveFrameClockUpdate();
+        glWindows_[0]->updateContentReferences();
     }
 
+    frameProfiler_.finishPhase(FRAME_PHASE_RECEIVE);
+
     // render all GLWindows
-    for(size_t i=0; i<glWindows_.size(); i++)
-    {
-        activeGLWindow_ = glWindows_[i];
-        glWindows_[i]->updateGL();
-    }
+    renderGLWindows();
+
+    // the decoding states of all pixel streams are reduced while waiting for the other processes
+    startPixelStreamDecodingAgreement();
+
+    frameProfiler_.finishPhase(FRAME_PHASE_RENDER);
 
     // all render processes render simultaneously
     MPI_Barrier(g_mpiRenderComm);
 
+    frameProfiler_.finishPhase(FRAME_PHASE_BARRIER);
+
     // swap buffers on all windows
-    for(size_t i=0; i<glWindows_.size(); i++)
-    {
-        glWindows_[i]->swapBuffers();
-    }
+    swapGLWindows();
+
+    frameProfiler_.finishPhase(FRAME_PHASE_SWAP);
+
+    // the most visible pixel streams are updated first, the others may have to wait for the next frames
+    schedulePixelStreamUpdates();
+
+    // the pixel streams can only swap their frames once no render process is decoding them
+    finishPixelStreamDecodingAgreement();
+
+    frameProfiler_.finishPhase(FRAME_PHASE_DECODE);
 
     // advance all contents
     g_displayGroupManager->advanceContents();
 
-    // clear old factory objects and purge any textures
+    // let rank 0 dispatch the next pixel stream frames as soon as the previous ones are being decoded
+    // all render processes agree on the decoding state, so rank 1 can speak for all of them
+    if(pixelStreamFramesPending_ && !hasPendingPixelStreamFrames())
+    {
+        if(g_mpiRank == 1)
+        {
+            g_displayGroupManager->sendPixelStreamsReady();
+        }
+        pixelStreamFramesPending_ = false;
+    }
+
+    frameProfiler_.finishPhase(FRAME_PHASE_ADVANCE);
+
+    // evict the cached factory objects of contents without windows over budget and purge any textures
     if(glWindows_.size() > 0)
     {
-        glWindows_[0]->getTextureFactory().clearStaleObjects();
-        glWindows_[0]->getDynamicTextureFactory().clearStaleObjects();
-        glWindows_[0]->getPDFFactory().clearStaleObjects();
-        glWindows_[0]->getSVGFactory().clearStaleObjects();
-        glWindows_[0]->getMovieFactory().clearStaleObjects();
-        glWindows_[0]->getPixelStreamFactory().clearStaleObjects();
-        glWindows_[0]->getPDFFactory().clearStaleObjects();
+        glWindows_[0]->getTextureFactory().evictUnreferencedObjects();
+        glWindows_[0]->getDynamicTextureFactory().evictUnreferencedObjects();
+        glWindows_[0]->getPDFFactory().evictUnreferencedObjects();
+        glWindows_[0]->getSVGFactory().evictUnreferencedObjects();
+        glWindows_[0]->getMovieFactory().evictUnreferencedObjects();
+        glWindows_[0]->getPixelStreamFactory().evictUnreferencedObjects();
+
+        enforceMemoryBudget();
 
         glWindows_[0]->purgeTextures();
     }
 
+    frameProfiler_.finishPhase(FRAME_PHASE_CLEANUP);
+    frameProfiler_.finishFrame();
+
     // increment frame counter
     ++g_frameCount;
 
     emit(updateGLWindowsFinished());
 }
 
+bool MainWindow::hasPendingPixelStreamFrames()
+{
+    if(glWindows_.empty())
+        return false;
+
+    typedef std::map<QString, boost::shared_ptr<PixelStream> > PixelStreams;
+    const PixelStreams pixelStreams = glWindows_[0]->getPixelStreamFactory().getMap();
+
+    for(PixelStreams::const_iterator it = pixelStreams.begin(); it != pixelStreams.end(); ++it)
+    {
+        // deferred frames will be replaced by newer ones, so they must not hold back rank 0
+        if(it->second->hasPendingFrame() && it->second->isFrameUpdateAllowed())
+            return true;
+    }
+    return false;
+}
+
+void MainWindow::setupRenderThreads()
+{
+    if(glWindows_.size() < 2 || !static_cast<WallConfiguration*>(g_configuration)->getRenderThreads())
+        return;
+
+    for(size_t i=0; i<glWindows_.size(); i++)
+        renderThreads_.push_back(RenderThreadPtr(new RenderThread(glWindows_[i])));
+
+    put_flog(LOG_INFO, "rendering %u screens in parallel threads", (unsigned int)renderThreads_.size());
+}
+
+void MainWindow::renderGLWindows()
+{
+    if(renderThreads_.empty())
+    {
+        for(size_t i=0; i<glWindows_.size(); i++)
+        {
+            activeGLWindow_ = glWindows_[i];
+            glWindows_[i]->updateGL();
+        }
+        return;
+    }
+
+    // a context can only be current in one thread
+    glWindows_[0]->doneCurrent();
+
+    for(size_t i=0; i<renderThreads_.size(); i++)
+        renderThreads_[i]->startRendering();
+
+    for(size_t i=0; i<renderThreads_.size(); i++)
+        renderThreads_[i]->waitForTask();
+}
+
+void MainWindow::swapGLWindows()
+{
+    if(renderThreads_.empty())
+    {
+        for(size_t i=0; i<glWindows_.size(); i++)
+            glWindows_[i]->swapBuffers();
+        return;
+    }
+
+    // the swaps wait for the vertical retrace of each screen at the same time
+    for(size_t i=0; i<renderThreads_.size(); i++)
+        renderThreads_[i]->startSwapping();
+
+    for(size_t i=0; i<renderThreads_.size(); i++)
+        renderThreads_[i]->waitForTask();
+
+    // the frame is advanced and the textures are uploaded in the context of the first window
+    glWindows_[0]->makeCurrent();
+}
+
+void MainWindow::setupMemoryBudget()
+{
+    const WallConfiguration* configuration = static_cast<WallConfiguration*>(g_configuration);
+
+    size_t gpuBudget = configuration->getGPUMemoryBudget();
+    if(gpuBudget == 0 && !glWindows_.empty())
+    {
+        // by default, leave some of the memory reported by the driver to the other allocations
+        glWindows_[0]->makeCurrent();
+        gpuBudget = (size_t)(MemoryManager::queryGPUMemory() * MEMORYMANAGER_DEFAULT_GPU_BUDGET_FRACTION);
+    }
+
+    memoryManager_.setBudget(configuration->getHostMemoryBudget(), gpuBudget);
+
+    put_flog(LOG_INFO, "contents memory budget: host %u MB, GPU %u MB (0: unlimited)",
+             (unsigned int)(memoryManager_.getHostBudget() / (1024 * 1024)),
+             (unsigned int)(memoryManager_.getGPUBudget() / (1024 * 1024)));
+}
+
+void MainWindow::enforceMemoryBudget()
+{
+    const ContentMemoryUsages evictions = memoryManager_.update(glWindows_[0]->getContentMemoryUsages());
+
+    for(ContentMemoryUsages::const_iterator it = evictions.begin(); it != evictions.end(); ++it)
+        glWindows_[0]->evictContent(*it);
+
+    if(g_frameCount % MEMORYMANAGER_REPORT_INTERVAL == 0)
+        memoryManager_.report();
+}
+
+void MainWindow::schedulePixelStreamUpdates()
+{
+    if(glWindows_.empty())
+        return;
+
+    typedef std::map<QString, boost::shared_ptr<PixelStream> > PixelStreams;
+    const PixelStreams pixelStreams = glWindows_[0]->getPixelStreamFactory().getMap();
+
+    // all render processes have received the same frames, so they all take the same decisions
+    std::map<PixelStreamId, size_t> costs;
+    for(PixelStreams::const_iterator it = pixelStreams.begin(); it != pixelStreams.end(); ++it)
+    {
+        if(it->second->hasPendingFrame())
+            costs[g_pixelStreamRegistry.getId(it->first)] = it->second->getPendingFramePixelCount();
+    }
+
+    pixelStreamScheduler_.updatePriorities(g_displayGroupManager->getContentWindowManagers());
+    const std::set<PixelStreamId> scheduledStreams = pixelStreamScheduler_.schedule(costs);
+
+    for(PixelStreams::const_iterator it = pixelStreams.begin(); it != pixelStreams.end(); ++it)
+    {
+        const PixelStreamId streamId = g_pixelStreamRegistry.getId(it->first);
+        it->second->setFrameUpdateAllowed(!costs.count(streamId) || scheduledStreams.count(streamId));
+    }
+}
+
+void MainWindow::startPixelStreamDecodingAgreement()
+{
+    decodingAgreementStreams_.clear();
+    localDecodingStates_.clear();
+
+    if(!glWindows_.empty())
+    {
+        // the streams are taken in the order of the display group windows, which is the same on all
+        // render processes, unlike the local factory where culled streams are only created later
+        const ContentWindowManagerPtrs contentWindows = g_displayGroupManager->getContentWindowManagers();
+        std::set<QString> uris;
+
+        for(ContentWindowManagerPtrs::const_iterator it = contentWindows.begin(); it != contentWindows.end(); ++it)
+        {
+            ContentPtr content = (*it)->getContent();
+            if(content->getType() != CONTENT_TYPE_PIXEL_STREAM || !uris.insert(content->getURI()).second)
+                continue;
+
+            decodingAgreementStreams_.push_back(glWindows_[0]->getPixelStreamFactory().getObject(content->getURI()));
+        }
+
+        // one bit per stream
+        localDecodingStates_.assign((decodingAgreementStreams_.size() + 31) / 32, 0);
+
+        for(size_t i=0; i<decodingAgreementStreams_.size(); i++)
+        {
+            if(decodingAgreementStreams_[i]->isLocalDecodingInProgress())
+                localDecodingStates_[i / 32] |= 1u << (i % 32);
+        }
+    }
+
+    globalDecodingStates_.resize(localDecodingStates_.size());
+
+    if(localDecodingStates_.empty())
+        return;
+
+    // a single collective for all the streams, completed in finishPixelStreamDecodingAgreement()
+#if MPI_VERSION >= 3
+    MPI_Iallreduce((void *)&localDecodingStates_[0], (void *)&globalDecodingStates_[0], localDecodingStates_.size(),
+                   MPI_UNSIGNED, MPI_BOR, g_mpiRenderComm, &decodingAgreementRequest_);
+#else
+    MPI_Allreduce((void *)&localDecodingStates_[0], (void *)&globalDecodingStates_[0], localDecodingStates_.size(),
+                  MPI_UNSIGNED, MPI_BOR, g_mpiRenderComm);
+#endif
+}
+
+void MainWindow::finishPixelStreamDecodingAgreement()
+{
+    MPI_Wait(&decodingAgreementRequest_, MPI_STATUS_IGNORE);
+
+    for(size_t i=0; i<decodingAgreementStreams_.size(); i++)
+    {
+        decodingAgreementStreams_[i]->setDecodingInProgress(globalDecodingStates_[i / 32] & (1u << (i % 32)));
+    }
+    decodingAgreementStreams_.clear();
+}
+
 void MainWindow::finalize()
 {
+    renderThreads_.clear();
+
     for(size_t i=0; i<glWindows_.size(); i++)
     {
         glWindows_[i]->finalize();
@@ -41,14 +41,20 @@
 
 #include "config.h"
 #include "types.h"
+#include "PixelStreamScheduler.h"
+#include "FrameProfiler.h"
+#include "MemoryManager.h"
 
 #include <QtGui>
 #include <QGLWidget>
 #include <boost/shared_ptr.hpp>
+#include <mpi.h>
 
 class MultiTouchListener;
 class BackgroundWidget;
 class GLWindow;
+class PixelStream;
+class RenderThread;
 
 class MainWindow : public QMainWindow
 {
@@ -63,6 +69,15 @@ class MainWindow : public QMainWindow
 
         bool isRegionVisible(double x, double y, double w, double h) const;
 
+        /** Get the area of a region which is visible on the screens of this process, in normalized global screen space. */
+        float getVisibleArea(const QRectF& rect) const;
+
+        /** Render processes: the memory used by the contents. */
+        const MemoryManager& getMemoryManager() const;
+
+        /** Rank 0: the duration of the frame phases of the render processes. */
+        const FrameProfiler& getFrameProfiler() const;
+
         void finalize();
 
     signals:
@@ -104,6 +119,7 @@ class MainWindow : public QMainWindow
     private:
         void setupMasterWindowUI();
         void setupWallOpenGLWindows();
+        void setupHeadlessOpenGLWindows();
 
         void addContentDirectory(const QString &directoryName, unsigned int gridX=0, unsigned int gridY=0);
         void loadState(const QString &filename);
@@ -117,6 +133,39 @@ class MainWindow : public QMainWindow
         GLWindowPtrs glWindows_;
         GLWindowPtr activeGLWindow_;
 
+        // The screens of the process are rendered in parallel, one thread per GLWindow
+        std::vector<boost::shared_ptr<RenderThread> > renderThreads_;
+
+        void setupRenderThreads();
+        void renderGLWindows();
+        void swapGLWindows();
+
+        // Pixel stream frames were received and rank 0 has not been notified of their consumption yet
+        bool pixelStreamFramesPending_;
+
+        // Select the pixel streams which can be updated in this frame within the decoding budget
+        PixelStreamScheduler pixelStreamScheduler_;
+
+        // All render processes agree once per frame on which pixel streams are still being decoded
+        std::vector<boost::shared_ptr<PixelStream> > decodingAgreementStreams_;
+        std::vector<unsigned int> localDecodingStates_;
+        std::vector<unsigned int> globalDecodingStates_;
+        MPI_Request decodingAgreementRequest_;
+
+        bool hasPendingPixelStreamFrames();
+        void schedulePixelStreamUpdates();
+        void startPixelStreamDecodingAgreement();
+        void finishPixelStreamDecodingAgreement();
+
+        // Keep the memory of the contents of this process within budget
+        MemoryManager memoryManager_;
+
+        void setupMemoryBudget();
+        void enforceMemoryBudget();
+
+        // Time the phases of the frames of all render processes
+        FrameProfiler frameProfiler_;
+
         BackgroundWidget* backgroundWidget_;
 
 #if ENABLE_TUIO_TOUCH_LISTENER
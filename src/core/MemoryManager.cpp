@@ -0,0 +1,221 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "MemoryManager.h"
+
+#include "log.h"
+
+#include <QGLWidget>
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX 0x9047
+#endif
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#endif
+
+namespace
+{
+
+bool hasExtension(const char* extension)
+{
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions && strstr(extensions, extension);
+}
+
+// Contents without windows go first, then the ones not visible on this process
+bool isEvictedBefore(const ContentMemoryUsage& a, const ContentMemoryUsage& b)
+{
+    if(a.referenced != b.referenced)
+        return !a.referenced;
+
+    if(a.renderedFrameIndex != b.renderedFrameIndex)
+        return a.renderedFrameIndex < b.renderedFrameIndex;
+
+    // keep a deterministic order
+    if(a.type != b.type)
+        return a.type < b.type;
+    return a.uri < b.uri;
+}
+
+size_t toMB(const size_t bytes)
+{
+    return bytes / (1024 * 1024);
+}
+
+}
+
+ContentMemoryUsage::ContentMemoryUsage()
+    : type(CONTENT_TYPE_ANY)
+    , hostMemory(0)
+    , gpuMemory(0)
+    , referenced(false)
+    , visibleArea(0.f)
+    , renderedFrameIndex(0)
+    , evictable(true)
+{
+}
+
+MemoryManager::MemoryManager(const size_t hostBudget, const size_t gpuBudget)
+    : hostBudget_(hostBudget)
+    , gpuBudget_(gpuBudget)
+    , overcommitted_(false)
+{
+}
+
+void MemoryManager::setBudget(const size_t hostBudget, const size_t gpuBudget)
+{
+    hostBudget_ = hostBudget;
+    gpuBudget_ = gpuBudget;
+}
+
+size_t MemoryManager::getHostBudget() const
+{
+    return hostBudget_;
+}
+
+size_t MemoryManager::getGPUBudget() const
+{
+    return gpuBudget_;
+}
+
+ContentMemoryUsages MemoryManager::update(const ContentMemoryUsages& usages)
+{
+    size_t hostMemory = 0;
+    size_t gpuMemory = 0;
+    for(size_t i=0; i<usages.size(); i++)
+    {
+        hostMemory += usages[i].hostMemory;
+        gpuMemory += usages[i].gpuMemory;
+    }
+
+    ContentMemoryUsages candidates, kept;
+    for(size_t i=0; i<usages.size(); i++)
+    {
+        // a visible content would be created again by the next frame, and evicted again
+        if(usages[i].evictable && usages[i].visibleArea <= 0.f)
+            candidates.push_back(usages[i]);
+        else
+            kept.push_back(usages[i]);
+    }
+    std::sort(candidates.begin(), candidates.end(), isEvictedBefore);
+
+    ContentMemoryUsages evictions;
+    for(size_t i=0; i<candidates.size(); i++)
+    {
+        const bool hostExceeded = hostBudget_ > 0 && hostMemory > hostBudget_;
+        const bool gpuExceeded = gpuBudget_ > 0 && gpuMemory > gpuBudget_;
+
+        // only evict the contents which free the memory that is lacking
+        const ContentMemoryUsage& candidate = candidates[i];
+        if((hostExceeded && candidate.hostMemory > 0) || (gpuExceeded && candidate.gpuMemory > 0))
+        {
+            hostMemory -= candidate.hostMemory;
+            gpuMemory -= candidate.gpuMemory;
+            evictions.push_back(candidate);
+        }
+        else
+            kept.push_back(candidate);
+    }
+
+    const bool overcommitted = (hostBudget_ > 0 && hostMemory > hostBudget_) ||
+                               (gpuBudget_ > 0 && gpuMemory > gpuBudget_);
+    if(overcommitted && !overcommitted_)
+        put_flog(LOG_WARN, "memory budget exceeded by the visible or non-evictable contents: host %u / %u MB, GPU %u / %u MB",
+                 (unsigned int)toMB(hostMemory), (unsigned int)toMB(hostBudget_),
+                 (unsigned int)toMB(gpuMemory), (unsigned int)toMB(gpuBudget_));
+    overcommitted_ = overcommitted;
+
+    usages_.swap(kept);
+    return evictions;
+}
+
+const ContentMemoryUsages& MemoryManager::getUsages() const
+{
+    return usages_;
+}
+
+size_t MemoryManager::getHostMemoryUsage() const
+{
+    size_t bytes = 0;
+    for(size_t i=0; i<usages_.size(); i++)
+        bytes += usages_[i].hostMemory;
+    return bytes;
+}
+
+size_t MemoryManager::getGPUMemoryUsage() const
+{
+    size_t bytes = 0;
+    for(size_t i=0; i<usages_.size(); i++)
+        bytes += usages_[i].gpuMemory;
+    return bytes;
+}
+
+void MemoryManager::report() const
+{
+    put_flog(LOG_INFO, "contents memory: host %u / %u MB, GPU %u / %u MB (0: unlimited)",
+             (unsigned int)toMB(getHostMemoryUsage()), (unsigned int)toMB(hostBudget_),
+             (unsigned int)toMB(getGPUMemoryUsage()), (unsigned int)toMB(gpuBudget_));
+
+    for(size_t i=0; i<usages_.size(); i++)
+    {
+        const ContentMemoryUsage& usage = usages_[i];
+        put_flog(LOG_DEBUG, "  %s %s: host %u KB, GPU %u KB, visible area %f",
+                 getContentTypeString(usage.type).toLocal8Bit().constData(), usage.uri.toLocal8Bit().constData(),
+                 (unsigned int)(usage.hostMemory / 1024), (unsigned int)(usage.gpuMemory / 1024), usage.visibleArea);
+    }
+}
+
+size_t MemoryManager::queryGPUMemory()
+{
+    GLint memoryKB[4] = { 0, 0, 0, 0 };
+
+    if(hasExtension("GL_NVX_gpu_memory_info"))
+        glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, memoryKB);
+    // only the free memory is known, which is the total at startup
+    else if(hasExtension("GL_ATI_meminfo"))
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, memoryKB);
+
+    if(glGetError() != GL_NO_ERROR || memoryKB[0] <= 0)
+        return 0;
+
+    return (size_t)memoryKB[0] * 1024;
+}
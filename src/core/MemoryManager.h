@@ -0,0 +1,144 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef MEMORYMANAGER_H
+#define MEMORYMANAGER_H
+
+#include "ContentType.h"
+
+#include <stdint.h>
+#include <vector>
+#include <QString>
+
+// Fraction of the GPU memory reported by the driver used as default budget
+#define MEMORYMANAGER_DEFAULT_GPU_BUDGET_FRACTION 0.8
+
+// Number of frames between two reports of the memory used by each content
+#define MEMORYMANAGER_REPORT_INTERVAL 1000
+
+/**
+ * The memory used by the factory object of a content on a render process.
+ */
+struct ContentMemoryUsage
+{
+    ContentMemoryUsage();
+
+    CONTENT_TYPE type;
+    QString uri;
+
+    /** Host and GPU memory in bytes, including textures and staging buffers. */
+    size_t hostMemory;
+    size_t gpuMemory;
+
+    /** Does a window of the display group show the content. */
+    bool referenced;
+
+    /** The fraction of the wall covered by the windows of the content on the screens of this process [0;1]. */
+    float visibleArea;
+
+    /** Index of the last frame in which the content was rendered. */
+    uint64_t renderedFrameIndex;
+
+    /** Can the object be destroyed and created again when needed. */
+    bool evictable;
+};
+
+typedef std::vector<ContentMemoryUsage> ContentMemoryUsages;
+
+/**
+ * Enforce the host and GPU memory budgets of a render process across all the contents.
+ *
+ * When the contents use more memory than the budget, they are evicted by priority: first the ones
+ * without windows, then the ones whose windows are not visible on this process. Within each group,
+ * the least recently rendered go first. The visible contents are never evicted, since they would be
+ * created again by the next frame; if they alone exceed the budget, a warning is logged instead.
+ * Without a budget, a driver which is out of memory can stall a single process and with it the whole
+ * wall at the swap barrier.
+ */
+class MemoryManager
+{
+public:
+    /**
+     * Construct a memory manager
+     * @param hostBudget The host memory of all the contents in bytes, 0 for unlimited
+     * @param gpuBudget The GPU memory of all the contents in bytes, 0 for unlimited
+     */
+    MemoryManager(const size_t hostBudget = 0, const size_t gpuBudget = 0);
+
+    /** Set the memory budgets in bytes, 0 for unlimited. */
+    void setBudget(const size_t hostBudget, const size_t gpuBudget);
+
+    size_t getHostBudget() const;
+    size_t getGPUBudget() const;
+
+    /**
+     * Select the contents to evict so that the others fit in the budgets.
+     * @param usages The memory used by all the contents of the process
+     * @return The contents to evict, in order of eviction
+     */
+    ContentMemoryUsages update(const ContentMemoryUsages& usages);
+
+    /** Get the memory used by the contents which were kept by the last update(). */
+    const ContentMemoryUsages& getUsages() const;
+
+    /** Get the total host memory of the contents kept by the last update() in bytes. */
+    size_t getHostMemoryUsage() const;
+
+    /** Get the total GPU memory of the contents kept by the last update() in bytes. */
+    size_t getGPUMemoryUsage() const;
+
+    /** Log the memory used by each content kept by the last update(). */
+    void report() const;
+
+    /**
+     * Get the GPU memory of the current GL context, if the driver exposes it.
+     * @return The dedicated video memory in bytes, or 0 if unknown
+     */
+    static size_t queryGPUMemory();
+
+private:
+    size_t hostBudget_;
+    size_t gpuBudget_;
+
+    ContentMemoryUsages usages_;
+
+    // the budget was exceeded by the contents which can not be evicted, warned once until it recovers
+    bool overcommitted_;
+};
+
+#endif // MEMORYMANAGER_H
@@ -41,8 +41,11 @@
 #include "DisplayGroupManager.h"
 #include "MainWindow.h"
 #include "GLWindow.h"
+#include "configuration/WallConfiguration.h"
 #include "log.h"
 
+#include <QtConcurrentRun>
+
 Movie::Movie(QString uri)
     : uri_(uri)
     , textureId_(0)
@@ -51,7 +54,6 @@ Movie::Movie(QString uri)
     , avCodecContext_(NULL)
     , swsContext_(NULL)
     , avFrame_(NULL)
-    , avFrameRGB_(NULL)
     , streamIdx_(-1)
     , videostream_(NULL)
     // Internal
@@ -63,6 +65,7 @@ Movie::Movie(QString uri)
     , skipped_frames_(false)
     , paused_(false)
     , loop_(true)
+    , decodeAhead_(static_cast<WallConfiguration*>(g_configuration)->getMovieDecodeAhead())
 {
     Movie::initFFMPEGGlobalState();
 
@@ -130,12 +133,9 @@ Movie::Movie(QString uri)
     // allocate video frame for video decoding
     avFrame_ = avcodec_alloc_frame();
 
-    // allocate video frame for RGB conversion
-    avFrameRGB_ = avcodec_alloc_frame();
-
-    if( !avFrame_ || !avFrameRGB_ )
+    if( !avFrame_ )
     {
-        put_flog(LOG_ERROR, "error allocating frames");
+        put_flog(LOG_ERROR, "error allocating frame");
         return;
     }
 
@@ -159,15 +159,17 @@ Movie::Movie(QString uri)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    // assign buffer to pFrameRGB
-    avpicture_alloc( (AVPicture *)avFrameRGB_, PIX_FMT_RGBA, avCodecContext_->width, avCodecContext_->height);
-
     // create sws scaler context
     swsContext_ = sws_getContext(avCodecContext_->width, avCodecContext_->height, avCodecContext_->pix_fmt, avCodecContext_->width, avCodecContext_->height, PIX_FMT_RGBA, SWS_FAST_BILINEAR, NULL, NULL, NULL);
+
+    // start decoding the first frames while the window is being set up
+    startDecoding();
 }
 
 Movie::~Movie()
 {
+    waitForDecoding();
+
     if(textureId_)
         g_mainWindow->getGLWindow()->deleteTexture(textureId_);
 
@@ -179,10 +181,8 @@ Movie::~Movie()
     // free scaler context
     sws_freeContext(swsContext_);
 
-    // free frames
-    avpicture_free( (AVPicture *)avFrameRGB_ );
+    // free frame
     av_free(avFrame_);
-    av_free(avFrameRGB_);
 }
 
 void Movie::initFFMPEGGlobalState()
@@ -202,6 +202,23 @@ void Movie::getDimensions(int &width, int &height)
     height = avCodecContext_->height;
 }
 
+size_t Movie::getHostMemoryUsage() const
+{
+    if(!avCodecContext_)
+        return 0;
+
+    // the decoded frame plus the RGBA frames of the pipeline, at most 4 bytes per pixel
+    return (size_t)avCodecContext_->width * avCodecContext_->height * 4 * (decodeAhead_ + 2);
+}
+
+size_t Movie::getGPUMemoryUsage() const
+{
+    if(!textureId_ || !avCodecContext_)
+        return 0;
+
+    return (size_t)avCodecContext_->width * avCodecContext_->height * 4;
+}
+
 void Movie::render(float tX, float tY, float tW, float tH)
 {
     updateRenderedFrameIndex();
@@ -210,28 +227,7 @@ void Movie::render(float tX, float tY, float tW, float tH)
         return;
 
     // draw the texture
-    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
-
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, textureId_);
-
-    glBegin(GL_QUADS);
-
-    glTexCoord2f(tX,tY);
-    glVertex2f(0.,0.);
-
-    glTexCoord2f(tX+tW,tY);
-    glVertex2f(1.,0.);
-
-    glTexCoord2f(tX+tW,tY+tH);
-    glVertex2f(1.,1.);
-
-    glTexCoord2f(tX,tY+tH);
-    glVertex2f(0.,1.);
-
-    glEnd();
-
-    glPopAttrib();
+    g_mainWindow->getActiveGLWindow()->getQuadBatch().addQuad(textureId_, QRectF(0., 0., 1., 1.), QRectF(tX, tY, tW, tH));
 }
 
 void Movie::nextFrame(bool skip)
@@ -265,17 +261,19 @@ void Movie::nextFrame(bool skip)
         return;
     }
 
-    // keep track of a desired timestamp if we seek in this frame
-    int64_t desiredTimestamp = 0;
+    // the decoding job owns the FFMPEG contexts until it has finished
+    waitForDecoding();
+
     if( skipped_frames_ )
     {
-        // need to seek
+        // need to seek, the frames decoded ahead are no longer valid
+        recycleDecodedFrames();
 
         // frame number we want
         const int64_t index = (frame_index_-1) % (num_frames_+1);
 
         // timestamp we want
-        desiredTimestamp = start_time_ + av_rescale(index, den2_, num2_);
+        const int64_t desiredTimestamp = start_time_ + av_rescale(index, den2_, num2_);
 
         // seek to the nearest keyframe before desiredTimestamp and flush buffers
         if(avformat_seek_file(avFormatContext_, streamIdx_, 0, desiredTimestamp, desiredTimestamp, 0) != 0)
@@ -287,15 +285,92 @@ void Movie::nextFrame(bool skip)
         avcodec_flush_buffers(avCodecContext_);
 
         skipped_frames_ = false;
+
+        // decode the frame we seeked to synchronously, it has to be displayed now
+        decodeFrames(desiredTimestamp, 1);
+    }
+    else if( decodedFrames_.empty( ))
+    {
+        // no frame was decoded ahead, e.g. with decodeAhead set to 0
+        decodeFrames(0, 1);
+    }
+
+    MovieFramePtr frame = decodedFrames_.front();
+
+    if( frame->endOfStream )
+    {
+        // see if we need to loop, otherwise keep the last frame displayed
+        if( loop_ )
+        {
+            recycleDecodedFrames();
+            av_seek_frame(avFormatContext_, streamIdx_, 0, AVSEEK_FLAG_BACKWARD);
+            frame_index_ = 0;
+            startDecoding();
+        }
+        return;
     }
 
-    int avReadStatus = 0;
+    decodedFrames_.pop_front();
+
+    // put the RGB image to the already-created texture
+    // glTexSubImage2D uses the existing texture and is more efficient than other means
+    glBindTexture(GL_TEXTURE_2D, textureId_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0,0, avCodecContext_->width, avCodecContext_->height, GL_RGBA, GL_UNSIGNED_BYTE, &frame->pixels[0]);
+
+    freeFrames_.push_back(frame);
+
+    // decode the next frames while this one is rendered and swapped
+    startDecoding();
+}
+
+void Movie::startDecoding()
+{
+    if( !swsContext_ || decodeAhead_ == 0 )
+        return;
+
+    decodeFuture_ = QtConcurrent::run(this, &Movie::decodeFrames, (int64_t)0, decodeAhead_);
+}
 
+void Movie::waitForDecoding()
+{
+    decodeFuture_.waitForFinished();
+}
+
+void Movie::recycleDecodedFrames()
+{
+    freeFrames_.insert(freeFrames_.end(), decodedFrames_.begin(), decodedFrames_.end());
+    decodedFrames_.clear();
+}
+
+void Movie::decodeFrames(int64_t desiredTimestamp, unsigned int count)
+{
+    while( decodedFrames_.size() < count &&
+           (decodedFrames_.empty() || !decodedFrames_.back()->endOfStream) )
+    {
+        MovieFramePtr frame;
+        if( freeFrames_.empty( ))
+            frame.reset(new MovieFrame());
+        else
+        {
+            frame = freeFrames_.back();
+            freeFrames_.pop_back();
+        }
+
+        frame->endOfStream = !decodeFrame(*frame, desiredTimestamp);
+        decodedFrames_.push_back(frame);
+
+        // only the first frame after a seek has a desired timestamp
+        desiredTimestamp = 0;
+    }
+}
+
+bool Movie::decodeFrame(MovieFrame& frame, int64_t desiredTimestamp)
+{
     AVPacket packet;
     av_init_packet(&packet);
     int frameFinished;
 
-    while((avReadStatus = av_read_frame(avFormatContext_, &packet)) >= 0)
+    while(av_read_frame(avFormatContext_, &packet) >= 0)
     {
         // make sure packet is from video stream
         if(packet.stream_index == streamIdx_)
@@ -312,17 +387,17 @@ void Movie::nextFrame(bool skip)
                 if(desiredTimestamp == 0 || (avFrame_->pkt_dts >= desiredTimestamp))
                 {
                     // convert the frame from its native format to RGB
-                    sws_scale(swsContext_, avFrame_->data, avFrame_->linesize, 0, avCodecContext_->height, avFrameRGB_->data, avFrameRGB_->linesize);
+                    frame.pixels.resize((size_t)avCodecContext_->width * avCodecContext_->height * 4);
 
-                    // put the RGB image to the already-created texture
-                    // glTexSubImage2D uses the existing texture and is more efficient than other means
-                    glBindTexture(GL_TEXTURE_2D, textureId_);
-                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0,0, avCodecContext_->width, avCodecContext_->height, GL_RGBA, GL_UNSIGNED_BYTE, avFrameRGB_->data[0]);
+                    uint8_t* data[4] = { &frame.pixels[0], NULL, NULL, NULL };
+                    int linesize[4] = { avCodecContext_->width * 4, 0, 0, 0 };
+
+                    sws_scale(swsContext_, avFrame_->data, avFrame_->linesize, 0, avCodecContext_->height, data, linesize);
 
                     // free the packet that was allocated by av_read_frame
                     av_free_packet(&packet);
 
-                    break;
+                    return true;
                 }
             }
         }
@@ -331,12 +406,7 @@ void Movie::nextFrame(bool skip)
         av_free_packet(&packet);
     }
 
-    // see if we need to loop
-    if(avReadStatus < 0 && loop_)
-    {
-        av_seek_frame(avFormatContext_, streamIdx_, 0, AVSEEK_FLAG_BACKWARD);
-        frame_index_ = 0;
-    }
+    return false;
 }
 
 void Movie::setPause(const bool pause)
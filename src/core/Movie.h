@@ -41,7 +41,11 @@
 
 #include "FactoryObject.h"
 #include <QGLWidget>
+#include <QFuture>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/shared_ptr.hpp>
+#include <deque>
+#include <vector>
 
 // required for FFMPEG includes below, specifically for the Linux build
 #ifdef __cplusplus
@@ -64,6 +68,19 @@ extern "C" {
     #include <libavutil/mathematics.h>
 }
 
+/** A frame decoded ahead of its display, converted to RGBA. */
+struct MovieFrame
+{
+    std::vector<uint8_t> pixels;
+
+    /** Set if the end of the stream was reached instead of decoding a frame. */
+    bool endOfStream;
+
+    MovieFrame() : endOfStream(false) {}
+};
+
+typedef boost::shared_ptr<MovieFrame> MovieFramePtr;
+
 class Movie : public FactoryObject {
 
     public:
@@ -75,6 +92,12 @@ class Movie : public FactoryObject {
 
         void getDimensions(int &width, int &height);
         void render(float tX, float tY, float tW, float tH);
+
+        /** @copydoc FactoryObject::getHostMemoryUsage */
+        size_t getHostMemoryUsage() const;
+
+        /** @copydoc FactoryObject::getGPUMemoryUsage */
+        size_t getGPUMemoryUsage() const;
         void nextFrame(bool skip);
         void setPause(const bool pause);
         void setLoop(const bool loop);
@@ -92,7 +115,6 @@ class Movie : public FactoryObject {
         AVCodecContext * avCodecContext_; // this is a member of AVFormatContext, saved for convenience; no need to free
         SwsContext * swsContext_;
         AVFrame * avFrame_;
-        AVFrame * avFrameRGB_;
         int streamIdx_;
         AVStream * videostream_;    // shortcut; no need to free
 
@@ -113,6 +135,24 @@ class Movie : public FactoryObject {
 
         // frame timing
         boost::posix_time::ptime nextTimestamp_;
+
+        // decoding pipeline: frames are decoded by an asynchronous job while the
+        // previous ones are rendered. The FFMPEG contexts and the frame queues are
+        // only accessed from nextFrame() once the job has finished.
+        unsigned int decodeAhead_;
+        std::deque<MovieFramePtr> decodedFrames_;
+        std::vector<MovieFramePtr> freeFrames_;
+        QFuture<void> decodeFuture_;
+
+        void startDecoding();
+        void waitForDecoding();
+        void recycleDecodedFrames();
+
+        /** Decode frames until the queue holds count frames or the end of the stream. */
+        void decodeFrames(int64_t desiredTimestamp, unsigned int count);
+
+        /** Decode the next frame, at or after desiredTimestamp if not 0. @return false at the end of the stream */
+        bool decodeFrame(MovieFrame& frame, int64_t desiredTimestamp);
 };
 
 #endif
@@ -44,6 +44,7 @@
 #include "log.h"
 
 #include "CommandHandler.h"
+#include "TranscodingCommandHandler.h"
 
 const int NetworkListener::defaultPortNumber_ = 1701;
 
@@ -53,6 +54,10 @@ NetworkListener::NetworkListener(DisplayGroupManager& displayGroupManager, int p
     , commandHandler_(new CommandHandler())
 {
     qRegisterMetaType<size_t>("size_t");
+    qRegisterMetaType<PixelStreamId>("PixelStreamId");
+
+    // The streams set their own transcoding policy
+    commandHandler_->registerCommandHandler(new TranscodingCommandHandler(*pixelStreamDispatcher_));
 
     if( !listen(QHostAddress::Any, port) )
     {
@@ -63,8 +68,8 @@ NetworkListener::NetworkListener(DisplayGroupManager& displayGroupManager, int p
 
 NetworkListener::~NetworkListener()
 {
-    delete pixelStreamDispatcher_;
     delete commandHandler_;
+    delete pixelStreamDispatcher_;
 }
 
 CommandHandler& NetworkListener::getCommandHandler() const
@@ -102,14 +107,14 @@ void NetworkListener::incomingConnection(int socketDescriptor)
              SLOT( registerEventReceiver( QString, bool, EventReceiver* )));
 
     // PixelStreamDispatcher
-    connect(worker, SIGNAL(receivedAddPixelStreamSource(QString,size_t)),
-            pixelStreamDispatcher_, SLOT(addSource(QString,size_t)));
-    connect(worker, SIGNAL(receivedPixelStreamSegement(QString,size_t,PixelStreamSegment)),
-            pixelStreamDispatcher_, SLOT(processSegment(QString,size_t,PixelStreamSegment)));
-    connect(worker, SIGNAL(receivedPixelStreamFinishFrame(QString,size_t)),
-            pixelStreamDispatcher_, SLOT(processFrameFinished(QString,size_t)));
-    connect(worker, SIGNAL(receivedRemovePixelStreamSource(QString,size_t)),
-            pixelStreamDispatcher_, SLOT(removeSource(QString,size_t)));
+    connect(worker, SIGNAL(receivedAddPixelStreamSource(PixelStreamId,size_t)),
+            pixelStreamDispatcher_, SLOT(addSource(PixelStreamId,size_t)));
+    connect(worker, SIGNAL(receivedPixelStreamSegement(PixelStreamId,size_t,PixelStreamSegment)),
+            pixelStreamDispatcher_, SLOT(processSegment(PixelStreamId,size_t,PixelStreamSegment)));
+    connect(worker, SIGNAL(receivedPixelStreamFinishFrame(PixelStreamId,size_t)),
+            pixelStreamDispatcher_, SLOT(processFrameFinished(PixelStreamId,size_t)));
+    connect(worker, SIGNAL(receivedRemovePixelStreamSource(PixelStreamId,size_t)),
+            pixelStreamDispatcher_, SLOT(removeSource(PixelStreamId,size_t)));
 
     thread->start();
 }
@@ -41,6 +41,7 @@
 // increment this every time the network protocol changes in a major way
 #include "NetworkProtocol.h"
 #include "PixelStream.h"
+#include "globals.h"
 #include "log.h"
 
 #include <stdint.h>
@@ -50,6 +51,7 @@
 NetworkListenerThread::NetworkListenerThread(int socketDescriptor)
     : socketDescriptor_(socketDescriptor)
     , tcpSocket_(new QTcpSocket(this)) // Make sure that tcpSocket_ parent is *this* so it also gets moved to thread!
+    , pixelStreamId_(INVALID_PIXELSTREAM_ID)
     , registeredToEvents_(false)
 {
     if( !tcpSocket_->setSocketDescriptor(socketDescriptor_) )
@@ -71,8 +73,8 @@ NetworkListenerThread::~NetworkListenerThread()
     // If the sender crashed, we may not recieve the quit message.
     // We still want to remove this source so that the stream does not get stuck if other
     // senders are still active / resp. the window gets closed if no more senders contribute to it.
-    if (!pixelStreamUri_.isEmpty())
-        emit receivedRemovePixelStreamSource(pixelStreamUri_, socketDescriptor_);
+    if (pixelStreamId_ != INVALID_PIXELSTREAM_ID)
+        emit receivedRemovePixelStreamSource(pixelStreamId_, socketDescriptor_);
 
     if( tcpSocket_->state() == QAbstractSocket::ConnectedState )
         sendQuit();
@@ -178,23 +180,26 @@ void NetworkListenerThread::handleMessage(const MessageHeader& messageHeader, co
     case MESSAGE_TYPE_QUIT:
         if (pixelStreamUri_ == uri)
         {
-            emit receivedRemovePixelStreamSource(uri, socketDescriptor_);
+            emit receivedRemovePixelStreamSource(pixelStreamId_, socketDescriptor_);
             pixelStreamUri_ = QString();
+            pixelStreamId_ = INVALID_PIXELSTREAM_ID;
         }
         break;
 
     case MESSAGE_TYPE_PIXELSTREAM_OPEN:
         if (pixelStreamUri_.isEmpty())
         {
+            // From now on, the stream is identified by a compact id instead of its uri
             pixelStreamUri_ = uri;
-            emit receivedAddPixelStreamSource(uri, socketDescriptor_);
+            pixelStreamId_ = g_pixelStreamRegistry.registerStream(uri);
+            emit receivedAddPixelStreamSource(pixelStreamId_, socketDescriptor_);
         }
         break;
 
     case MESSAGE_TYPE_PIXELSTREAM_FINISH_FRAME:
         if (pixelStreamUri_ == uri)
         {
-            emit receivedPixelStreamFinishFrame(uri, socketDescriptor_);
+            emit receivedPixelStreamFinishFrame(pixelStreamId_, socketDescriptor_);
         }
         break;
 
@@ -238,7 +243,7 @@ void NetworkListenerThread::handlePixelStreamMessage(const QString& uri, const Q
 
     if (pixelStreamUri_ == uri)
     {
-        emit(receivedPixelStreamSegement(uri, socketDescriptor_, segment));
+        emit(receivedPixelStreamSegement(pixelStreamId_, socketDescriptor_, segment));
     }
     else
     {
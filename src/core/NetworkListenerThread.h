@@ -43,6 +43,7 @@
 #include "Event.h"
 #include "PixelStreamSegment.h"
 #include "EventReceiver.h"
+#include "PixelStreamRegistry.h"
 
 #include <QtNetwork/QTcpSocket>
 #include <QQueue>
@@ -70,10 +71,10 @@ signals:
 
     void finished();
 
-    void receivedAddPixelStreamSource(QString uri, size_t sourceIndex);
-    void receivedPixelStreamSegement(QString uri, size_t SourceIndex, PixelStreamSegment segment);
-    void receivedPixelStreamFinishFrame(QString uri, size_t SourceIndex);
-    void receivedRemovePixelStreamSource(QString uri, size_t sourceIndex);
+    void receivedAddPixelStreamSource(PixelStreamId streamId, size_t sourceIndex);
+    void receivedPixelStreamSegement(PixelStreamId streamId, size_t SourceIndex, PixelStreamSegment segment);
+    void receivedPixelStreamFinishFrame(PixelStreamId streamId, size_t SourceIndex);
+    void receivedRemovePixelStreamSource(PixelStreamId streamId, size_t sourceIndex);
 
     void registerToEvents(QString uri, bool exclusive, EventReceiver* receiver);
 
@@ -94,6 +95,7 @@ private:
     QTcpSocket* tcpSocket_;
 
     QString pixelStreamUri_;
+    PixelStreamId pixelStreamId_;
 
     bool registeredToEvents_;
     QQueue<Event> events_;
@@ -62,7 +62,6 @@ PDF::PDF(QString uri)
     , pdfDoc_(0)
     , pdfPage_(0)
     , pdfPageNumber(INVALID_PAGE_NUMBER)
-    , textureId_(0)
 {
     openDocument(uri_);
 }
@@ -75,7 +74,7 @@ PDF::~PDF()
 void PDF::closePage()
 {
     if (pdfPage_) {
-        deleteTexture();
+        deleteTextures();
         delete pdfPage_;
         pdfPage_ = 0;
         pdfPageNumber = INVALID_PAGE_NUMBER;
@@ -91,16 +90,23 @@ void PDF::closeDocument()
     }
 }
 
-void PDF::deleteTexture()
+void PDF::deleteTexture(PDFTextureData& textureData)
 {
-    if (textureId_)
+    if (textureData.textureId)
     {
-        g_mainWindow->getGLWindow()->deleteTexture(textureId_);
-        textureId_ = 0;
-        textureRect_ = QRect();
+        g_mainWindow->getGLWindow()->deleteTexture(textureData.textureId);
+        textureData.textureId = 0;
+        textureData.region = QRect();
     }
 }
 
+void PDF::deleteTextures()
+{
+    for (std::map<int, PDFTextureData>::iterator it = textureData_.begin(); it != textureData_.end(); ++it)
+        deleteTexture(it->second);
+    textureData_.clear();
+}
+
 
 void PDF::openDocument(QString filename)
 {
@@ -120,6 +126,8 @@ void PDF::openDocument(QString filename)
 
 void PDF::setPage(int pageNumber)
 {
+    QMutexLocker locker(&renderMutex_);
+
     if (pageNumber != pdfPageNumber && pageNumber < pdfDoc_->numPages())
     {
         closePage();
@@ -150,25 +158,45 @@ void PDF::getDimensions(int &width, int &height) const
     height = pdfPage_ ? pdfPage_->pageSize().height() : 0;
 }
 
+size_t PDF::getGPUMemoryUsage() const
+{
+    size_t bytes = 0;
+
+    for(std::map<int, PDFTextureData>::const_iterator it = textureData_.begin(); it != textureData_.end(); ++it)
+    {
+        if(it->second.textureId)
+            bytes += (size_t)it->second.region.width() * it->second.region.height() * 4;
+    }
+    return bytes;
+}
+
 void PDF::render(float tX, float tY, float tW, float tH)
 {
+    // the GLWindows may be rendered in parallel, and Poppler documents are not thread-safe
+    QMutexLocker locker(&renderMutex_);
+
     updateRenderedFrameIndex();
 
+    GLWindowPtr glWindow = g_mainWindow->getActiveGLWindow();
+
     // get on-screen and full rectangle corresponding to the window
-    QRectF screenRect = g_mainWindow->getGLWindow()->getProjectedPixelRect(true);
-    QRectF fullRect = g_mainWindow->getGLWindow()->getProjectedPixelRect(false);
+    QRectF screenRect = glWindow->getProjectedPixelRect(true);
+    QRectF fullRect = glWindow->getProjectedPixelRect(false);
+
+    // each GLWindow has its own texture, so that they do not regenerate each other's
+    PDFTextureData& textureData = textureData_[glWindow->getTileIndex()];
 
-    // if we're not visible or we don't have a valid SVG, we're done...
+    // if we're not visible, we're done...
     if(screenRect.isEmpty())
     {
-        // TODO clear existing FBO for this OpenGL window
+        deleteTexture(textureData);
         return;
     }
 
     // generate texture corresponding to the visible part of these texture coordinates
-    generateTexture(screenRect, fullRect, tX, tY, tW, tH);
+    generateTexture(textureData, screenRect, fullRect, tX, tY, tW, tH);
 
-    if(textureId_ == 0)
+    if(textureData.textureId == 0)
     {
         return;
     }
@@ -184,32 +212,11 @@ void PDF::render(float tX, float tY, float tW, float tH)
     double hp = screenRect.height() / fullRect.height();
 
     // draw the texture
-    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
-
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, textureId_);
-
-    glBegin(GL_QUADS);
-
-    glTexCoord2f(tX,tY);
-    glVertex2f(xp, yp);
-
-    glTexCoord2f(tX+tW,tY);
-    glVertex2f(xp+wp,yp);
-
-    glTexCoord2f(tX+tW,(tY+tH));
-    glVertex2f(xp+wp,yp+hp);
-
-    glTexCoord2f(tX,(tY+tH));
-    glVertex2f(xp,yp+hp);
-
-    glEnd();
-
-    glPopAttrib();
+    glWindow->getQuadBatch().addQuad(textureData.textureId, QRectF(xp, yp, wp, hp), QRectF(tX, tY, tW, tH));
 }
 
 
-void PDF::generateTexture(QRectF screenRect, QRectF fullRect, float tX, float tY, float tW, float tH)
+void PDF::generateTexture(PDFTextureData& textureData, QRectF screenRect, QRectF fullRect, float tX, float tY, float tW, float tH)
 {
     // figure out the coordinates of the topLeft corner of the texture in the PDF page
     double tXp = tX/tW*fullRect.width()  + (screenRect.x() - fullRect.x());
@@ -218,9 +225,7 @@ void PDF::generateTexture(QRectF screenRect, QRectF fullRect, float tX, float tY
     // Compute the actual texture dimensions
     QRect textureRect(tXp, tYp, screenRect.width(), screenRect.height());
 
-    // TODO The instance of this class seems to be shared, causing the texture to be
-    // constantly regenerated because the size changes... find a way around this!
-    if(textureRect == textureRect_)
+    if(textureRect == textureData.region)
     {
         // no need to regenerate texture
         return;
@@ -243,11 +248,11 @@ void PDF::generateTexture(QRectF screenRect, QRectF fullRect, float tX, float tY
         return;
     }
 
-    if (textureRect.size() != textureRect_.size())
+    if (textureRect.size() != textureData.region.size())
     {
         // Lets recreate a texture of the appropriate size
-        deleteTexture();
-        textureId_ = g_mainWindow->getGLWindow()->bindTexture(image, GL_TEXTURE_2D, GL_RGBA, QGLContext::NoBindOption);
+        deleteTexture(textureData);
+        textureData.textureId = g_mainWindow->getGLWindow()->bindTexture(image, GL_TEXTURE_2D, GL_RGBA, QGLContext::NoBindOption);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -256,11 +261,11 @@ void PDF::generateTexture(QRectF screenRect, QRectF fullRect, float tX, float tY
     {
         // put the RGB image to the already-created texture
         // glTexSubImage2D uses the existing texture and is more efficient than other means
-        glBindTexture(GL_TEXTURE_2D, textureId_);
+        glBindTexture(GL_TEXTURE_2D, textureData.textureId);
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0,0, image.width(), image.height(), GL_BGRA, GL_UNSIGNED_BYTE, image.bits());
     }
 
     // keep rendered texture information so we know when to rerender
-    textureRect_ = textureRect;
+    textureData.region = textureRect;
 }
 
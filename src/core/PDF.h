@@ -43,12 +43,27 @@
 #include "FactoryObject.h"
 #include <QString>
 #include <QGLFramebufferObject>
+#include <map>
 
 namespace Poppler {
     class Document;
     class Page;
 }
 
+/**
+ * Hold the texture and the page region rendered for one GLWindow.
+ */
+struct PDFTextureData
+{
+    PDFTextureData() : textureId(0) {}
+
+    /** Texture */
+    GLuint textureId;
+
+    /** Page region, in pixels of the rendered page */
+    QRect region;
+};
+
 class PDF : public FactoryObject
 {
 public:
@@ -57,6 +72,9 @@ public:
 
     void getDimensions(int &width, int &height) const;
     void render(float tX, float tY, float tW, float tH);
+
+    /** @copydoc FactoryObject::getGPUMemoryUsage */
+    size_t getGPUMemoryUsage() const;
     void setPage(int pageNumber);
     int getPageCount() const;
 
@@ -71,16 +89,16 @@ private:
     Poppler::Page* pdfPage_;
     int pdfPageNumber;
 
-    // texture information
-    QRect textureRect_;
-    GLuint textureId_;
+    // texture information for each GLWindow
+    std::map<int, PDFTextureData> textureData_;
 
     void openDocument(QString filename);
     void closeDocument();
     void closePage();
 
-    void generateTexture(QRectF screenRect, QRectF fullRect, float tX, float tY, float tW, float tH);
-    void deleteTexture();
+    void generateTexture(PDFTextureData& textureData, QRectF screenRect, QRectF fullRect, float tX, float tY, float tW, float tH);
+    void deleteTexture(PDFTextureData& textureData);
+    void deleteTextures();
 };
 
 #endif // PDF_H
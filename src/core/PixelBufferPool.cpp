@@ -0,0 +1,348 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "PixelBufferPool.h"
+
+#include "log.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+namespace
+{
+typedef void (APIENTRY *GenBuffersFunc)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRY *DeleteBuffersFunc)(GLsizei n, const GLuint* buffers);
+typedef void (APIENTRY *BindBufferFunc)(GLenum target, GLuint buffer);
+typedef void (APIENTRY *BufferDataFunc)(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+typedef void (APIENTRY *BufferStorageFunc)(GLenum target, GLsizeiptr size, const GLvoid* data, GLbitfield flags);
+typedef GLvoid* (APIENTRY *MapBufferFunc)(GLenum target, GLenum access);
+typedef GLvoid* (APIENTRY *MapBufferRangeFunc)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLboolean (APIENTRY *UnmapBufferFunc)(GLenum target);
+typedef GLsync (APIENTRY *FenceSyncFunc)(GLenum condition, GLbitfield flags);
+typedef GLenum (APIENTRY *ClientWaitSyncFunc)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+typedef void (APIENTRY *DeleteSyncFunc)(GLsync sync);
+
+const GLbitfield persistentMapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+/**
+ * The buffer functions are not part of OpenGL 1.1, so they are resolved from the first context
+ * used. All the GLWindows share their context, so the same functions are valid for all of them.
+ */
+struct BufferFunctions
+{
+    BufferFunctions()
+        : resolved(false)
+        , supported(false)
+        , persistent(false)
+        , genBuffers(0), deleteBuffers(0), bindBuffer(0), bufferData(0), bufferStorage(0)
+        , mapBuffer(0), mapBufferRange(0), unmapBuffer(0)
+        , fenceSync(0), clientWaitSync(0), deleteSync(0)
+    {}
+
+    bool resolved;
+    bool supported;
+    bool persistent;
+
+    GenBuffersFunc genBuffers;
+    DeleteBuffersFunc deleteBuffers;
+    BindBufferFunc bindBuffer;
+    BufferDataFunc bufferData;
+    BufferStorageFunc bufferStorage;
+    MapBufferFunc mapBuffer;
+    MapBufferRangeFunc mapBufferRange;
+    UnmapBufferFunc unmapBuffer;
+    FenceSyncFunc fenceSync;
+    ClientWaitSyncFunc clientWaitSync;
+    DeleteSyncFunc deleteSync;
+};
+
+bool hasVersionOrExtension(const int major, const int minor, const char* extension)
+{
+    int contextMajor = 0, contextMinor = 0;
+    const char* version = (const char*)glGetString(GL_VERSION);
+    if(version && sscanf(version, "%d.%d", &contextMajor, &contextMinor) == 2 &&
+            (contextMajor > major || (contextMajor == major && contextMinor >= minor)))
+        return true;
+
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions && strstr(extensions, extension);
+}
+
+BufferFunctions& getFunctions()
+{
+    static BufferFunctions functions;
+
+    const QGLContext* context = QGLContext::currentContext();
+    if(functions.resolved || !context)
+        return functions;
+
+    functions.resolved = true;
+
+    if(hasVersionOrExtension(2, 1, "GL_ARB_pixel_buffer_object"))
+    {
+        functions.genBuffers = (GenBuffersFunc)context->getProcAddress("glGenBuffers");
+        functions.deleteBuffers = (DeleteBuffersFunc)context->getProcAddress("glDeleteBuffers");
+        functions.bindBuffer = (BindBufferFunc)context->getProcAddress("glBindBuffer");
+        functions.bufferData = (BufferDataFunc)context->getProcAddress("glBufferData");
+        functions.mapBuffer = (MapBufferFunc)context->getProcAddress("glMapBuffer");
+        functions.unmapBuffer = (UnmapBufferFunc)context->getProcAddress("glUnmapBuffer");
+
+        functions.supported = functions.genBuffers && functions.deleteBuffers && functions.bindBuffer &&
+                functions.bufferData && functions.mapBuffer && functions.unmapBuffer;
+    }
+
+    if(functions.supported && hasVersionOrExtension(3, 2, "GL_ARB_sync"))
+    {
+        functions.fenceSync = (FenceSyncFunc)context->getProcAddress("glFenceSync");
+        functions.clientWaitSync = (ClientWaitSyncFunc)context->getProcAddress("glClientWaitSync");
+        functions.deleteSync = (DeleteSyncFunc)context->getProcAddress("glDeleteSync");
+
+        if(!functions.fenceSync || !functions.clientWaitSync || !functions.deleteSync)
+            functions.fenceSync = 0;
+    }
+
+    // persistently mapped buffers are written while the GL may read them, so they need the fences
+    if(functions.fenceSync && hasVersionOrExtension(4, 4, "GL_ARB_buffer_storage"))
+    {
+        functions.bufferStorage = (BufferStorageFunc)context->getProcAddress("glBufferStorage");
+        functions.mapBufferRange = (MapBufferRangeFunc)context->getProcAddress("glMapBufferRange");
+
+        functions.persistent = functions.bufferStorage && functions.mapBufferRange;
+    }
+
+    put_flog(LOG_INFO, "pixel buffer objects supported: %i, persistent mapping: %i",
+             functions.supported, functions.persistent);
+
+    return functions;
+}
+}
+
+PixelBufferPool::Buffer::Buffer()
+    : id(0)
+    , size(0)
+    , data(0)
+    , fence(0)
+{
+}
+
+PixelBufferPool::PixelBufferPool()
+    : buffers_(PIXELBUFFERPOOL_BUFFER_COUNT)
+    , currentBuffer_(0)
+    , mapped_(false)
+{
+}
+
+PixelBufferPool::~PixelBufferPool()
+{
+    for(size_t i=0; i<buffers_.size(); i++)
+    {
+        release(buffers_[i]);
+    }
+}
+
+bool PixelBufferPool::isSupported()
+{
+    return getFunctions().supported;
+}
+
+unsigned char* PixelBufferPool::map(const size_t size)
+{
+    if(!isSupported())
+        return 0;
+
+    Buffer& buffer = buffers_[currentBuffer_];
+
+    if(mapped_)
+    {
+        if(buffer.size == size)
+            return buffer.data;
+        unmap();
+    }
+
+    waitForTransfer(buffer);
+
+    if(buffer.size != size)
+        allocate(buffer, size);
+
+    BufferFunctions& gl = getFunctions();
+    if(!gl.persistent && buffer.id)
+    {
+        gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+        // orphan the previous storage, the GL may still be transferring it
+        gl.bufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_STREAM_DRAW);
+        buffer.data = (unsigned char*)gl.mapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+        gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    if(!buffer.data)
+    {
+        put_flog(LOG_ERROR, "could not map pixel buffer of %u bytes", (unsigned int)size);
+        return 0;
+    }
+
+    mapped_ = true;
+    return buffer.data;
+}
+
+bool PixelBufferPool::isMapped() const
+{
+    return mapped_;
+}
+
+void PixelBufferPool::upload(const GLuint textureId, const int width, const int height)
+{
+    assert(mapped_);
+
+    BufferFunctions& gl = getFunctions();
+    Buffer& buffer = buffers_[currentBuffer_];
+
+    gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+
+    if(!gl.persistent)
+    {
+        gl.unmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        buffer.data = 0;
+    }
+
+    // the pixels are read from the bound buffer, starting at offset 0
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    if(gl.fenceSync)
+        buffer.fence = gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    mapped_ = false;
+    currentBuffer_ = (currentBuffer_ + 1) % buffers_.size();
+}
+
+void PixelBufferPool::unmap()
+{
+    if(!mapped_)
+        return;
+
+    BufferFunctions& gl = getFunctions();
+    Buffer& buffer = buffers_[currentBuffer_];
+
+    if(!gl.persistent)
+    {
+        gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+        gl.unmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        buffer.data = 0;
+    }
+
+    mapped_ = false;
+}
+
+size_t PixelBufferPool::getMemoryUsage() const
+{
+    size_t bytes = 0;
+    for(size_t i=0; i<buffers_.size(); i++)
+        bytes += buffers_[i].size;
+    return bytes;
+}
+
+void PixelBufferPool::waitForTransfer(Buffer& buffer)
+{
+    if(!buffer.fence)
+        return;
+
+    BufferFunctions& gl = getFunctions();
+
+    const GLenum result = gl.clientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, PIXELBUFFERPOOL_FENCE_TIMEOUT);
+    if(result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+        put_flog(LOG_WARN, "transfer of pixel buffer %u did not complete", buffer.id);
+
+    gl.deleteSync(buffer.fence);
+    buffer.fence = 0;
+}
+
+void PixelBufferPool::allocate(Buffer& buffer, const size_t size)
+{
+    release(buffer);
+
+    BufferFunctions& gl = getFunctions();
+
+    gl.genBuffers(1, &buffer.id);
+    gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+
+    if(gl.persistent)
+    {
+        gl.bufferStorage(GL_PIXEL_UNPACK_BUFFER, size, 0, persistentMapFlags);
+        buffer.data = (unsigned char*)gl.mapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, persistentMapFlags);
+    }
+    else
+    {
+        gl.bufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_STREAM_DRAW);
+    }
+
+    gl.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    buffer.size = size;
+}
+
+void PixelBufferPool::release(Buffer& buffer)
+{
+    if(!buffer.id)
+        return;
+
+    BufferFunctions& gl = getFunctions();
+
+    if(buffer.fence)
+    {
+        gl.deleteSync(buffer.fence);
+        buffer.fence = 0;
+    }
+
+    // deleting a buffer also unmaps it
+    gl.deleteBuffers(1, &buffer.id);
+
+    buffer.id = 0;
+    buffer.size = 0;
+    buffer.data = 0;
+}
@@ -0,0 +1,126 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef PIXELBUFFERPOOL_H
+#define PIXELBUFFERPOOL_H
+
+#include <QGLWidget>
+
+#include <vector>
+
+// Number of pixel buffer objects, so that a buffer can be written while the previous one is being transferred
+#define PIXELBUFFERPOOL_BUFFER_COUNT 2
+
+// Maximum time to wait for the transfer of a buffer to complete before reusing it (ns)
+#define PIXELBUFFERPOOL_FENCE_TIMEOUT 100000000
+
+/**
+ * A ring of pixel buffer objects to upload textures asynchronously.
+ *
+ * A buffer is mapped so that its pixels can be written by any thread, typically a decoder. Its
+ * upload then only schedules the transfer to the texture, which the GL performs while the render
+ * thread continues. A fence tracks the end of the transfer before the buffer is written again.
+ *
+ * The buffers stay mapped when the GL supports persistent mapping (GL 4.4 or ARB_buffer_storage),
+ * otherwise they are orphaned and mapped again for each upload.
+ *
+ * All methods except the writing of the mapped memory must be called with a GL context current.
+ */
+class PixelBufferPool
+{
+public:
+    /** Construct a pool, the buffers are created on first use. */
+    PixelBufferPool();
+
+    /** Destruct the pool and its buffers. */
+    ~PixelBufferPool();
+
+    /** Can the current GL context upload textures from pixel buffer objects. */
+    static bool isSupported();
+
+    /**
+     * Get the memory of the next buffer to write pixels to.
+     *
+     * Waits for the previous transfer from that buffer to complete if it is still in progress.
+     * Calling it again before upload() or unmap() returns the same memory.
+     * @param size The size of the pixels to write in bytes
+     * @return The mapped memory, or 0 if pixel buffer objects are not supported or mapping failed
+     */
+    unsigned char* map(const size_t size);
+
+    /** Is a buffer mapped and waiting to be uploaded. */
+    bool isMapped() const;
+
+    /**
+     * Start the transfer of the mapped buffer to a texture.
+     *
+     * The texture must already have storage for the given dimensions. The pixels are in
+     * (GL_)RGBA format and must have been completely written.
+     * @param textureId The texture to update
+     * @param width The width of the pixels in the buffer
+     * @param height The height of the pixels in the buffer
+     */
+    void upload(const GLuint textureId, const int width, const int height);
+
+    /** Discard the content of the mapped buffer. */
+    void unmap();
+
+    /** Get the size of the allocated buffers in bytes. */
+    size_t getMemoryUsage() const;
+
+private:
+    struct Buffer
+    {
+        Buffer();
+
+        GLuint id;
+        size_t size;
+        unsigned char* data;
+        GLsync fence;
+    };
+
+    std::vector<Buffer> buffers_;
+    size_t currentBuffer_;
+    bool mapped_;
+
+    void waitForTransfer(Buffer& buffer);
+    void allocate(Buffer& buffer, const size_t size);
+    void release(Buffer& buffer);
+};
+
+#endif // PIXELBUFFERPOOL_H
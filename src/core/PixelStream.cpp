@@ -46,6 +46,7 @@
 
 #include "PixelStreamSegmentRenderer.h"
 #include "PixelStreamSegmentDecoder.h"
+#include "PixelBufferPool.h"
 
 #include "PixelStreamSegmentParameters.h"
 
@@ -54,6 +55,10 @@ PixelStream::PixelStream(const QString &uri)
     , width_(0)
     , height_ (0)
     , buffersSwapped_(false)
+    , frameUpdateAllowed_(true)
+    , decodingStateAgreed_(true)
+    , decodingInProgress_(false)
+    , hasWindow_(false)
 {
 }
 
@@ -65,9 +70,14 @@ void PixelStream::getDimensions(int &width, int &height) const
 
 void PixelStream::preRenderUpdate()
 {
-    if( isDecodingInProgress( ))
+    // All render processes must take the same decisions, so wait until none of them is decoding
+    if( !decodingStateAgreed_ || decodingInProgress_ )
         return;
 
+    decodingStateAgreed_ = false;
+
+    updateWindowCoordinates();
+
     // After swapping the buffers, wait until decoding has finished to update the renderers.
     if ( buffersSwapped_ )
     {
@@ -80,7 +90,7 @@ void PixelStream::preRenderUpdate()
     // The window may have moved, so always check if some segments have become visible to upload them.
     updateVisibleTextures();
 
-    if ( !backBuffer_.empty( ))
+    if ( !backBuffer_.empty( ) && frameUpdateAllowed_ )
     {
         swapBuffers();
         adjustFrameDecodersCount(frontBuffer_.size());
@@ -107,16 +117,25 @@ void PixelStream::updateVisibleTextures()
 {
     for(size_t i=0; i<frontBuffer_.size(); i++)
     {
-        if (segmentRenderers_[i]->textureNeedsUpdate() && !frontBuffer_[i].parameters.compressed &&
-                isVisible(frontBuffer_[i]))
+        const PixelStreamSegment& segment = frontBuffer_[i];
+
+        if (!segmentRenderers_[i]->textureNeedsUpdate() || segment.parameters.compressed || !isVisible(segment))
+            continue;
+
+        if (hasImageData(segment))
         {
-            const QImage textureWrapper((const uchar*)frontBuffer_[i].imageData.constData(),
-                                        frontBuffer_[i].parameters.width,
-                                        frontBuffer_[i].parameters.height,
+            const QImage textureWrapper((const uchar*)segment.imageData.constData(),
+                                        segment.parameters.width,
+                                        segment.parameters.height,
                                         QImage::Format_RGB32);
 
             segmentRenderers_[i]->updateTexture(textureWrapper);
         }
+        // the segment was decoded to the pixel buffer
+        else if (uploadBuffers_[i]->isMapped())
+        {
+            segmentRenderers_[i]->updateTexture(*uploadBuffers_[i], segment.parameters.width, segment.parameters.height);
+        }
     }
 }
 
@@ -124,8 +143,14 @@ void PixelStream::swapBuffers()
 {
     assert(!backBuffer_.empty());
 
+    // The buffers which were not uploaded hold segments of the previous frame
+    for(size_t i=0; i<uploadBuffers_.size(); i++)
+        uploadBuffers_[i]->unmap();
+
     frontBuffer_ = backBuffer_;
+    frontBufferData_ = backBufferData_;
     backBuffer_.clear();
+    backBufferData_.reset();
 
     buffersSwapped_ = true;
 }
@@ -146,25 +171,54 @@ void PixelStream::recomputeDimensions(const PixelStreamSegments &segments)
 void PixelStream::decodeVisibleTextures()
 {
     assert(frameDecoders_.size() == frontBuffer_.size());
+    assert(uploadBuffers_.size() == frontBuffer_.size());
 
-    std::vector<PixelStreamSegmentDecoderPtr>::iterator frameDecoder_it = frameDecoders_.begin();
-    PixelStreamSegments::iterator segment_it = frontBuffer_.begin();
-    for ( ; segment_it != frontBuffer_.end(); ++segment_it, ++frameDecoder_it )
+    for(size_t i=0; i<frontBuffer_.size(); i++)
     {
-        if ( segment_it->parameters.compressed && isVisible(*segment_it) )
+        PixelStreamSegment& segment = frontBuffer_[i];
+
+        if ( segment.parameters.compressed && hasImageData(segment) && isVisible(segment) )
         {
-            (*frameDecoder_it)->startDecoding(*segment_it);
+            // Decode to the memory of a pixel buffer so that the texture upload is asynchronous.
+            // If pixel buffers are not available, the segment is decoded to its own image data.
+            const size_t size = (size_t)segment.parameters.width * segment.parameters.height * 4;
+            frameDecoders_[i]->startDecoding(segment, uploadBuffers_[i]->map(size));
         }
     }
 }
 
 void PixelStream::render(const float tX, const float tY, const float tW, const float tH)
 {
+    // the GLWindows may be rendered in parallel, the textures are only updated in preRenderUpdate()
+    QMutexLocker locker(&renderMutex_);
+
     updateRenderedFrameIndex();
+    updateWindowCoordinates();
+
+    glPushMatrix();
+    glScalef(1.f/(float)width_, 1.f/(float)height_, 0.f);
 
+    for(std::vector<PixelStreamSegmentRendererPtr>::iterator it=segmentRenderers_.begin(); it != segmentRenderers_.end(); it++)
+    {
+        if (isVisible( (*it)->getRect( )))
+        {
+            (*it)->render();
+        }
+    }
+
+    glPopMatrix();
+}
+
+void PixelStream::renderOverlays()
+{
     const bool showSegmentBorders = g_displayGroupManager->getOptions()->getShowStreamingSegments();
     const bool showSegmentStatistics = g_displayGroupManager->getOptions()->getShowStreamingStatistics();
 
+    if(!showSegmentBorders && !showSegmentStatistics)
+        return;
+
+    QMutexLocker locker(&renderMutex_);
+
     glPushMatrix();
     glScalef(1.f/(float)width_, 1.f/(float)height_, 0.f);
 
@@ -172,13 +226,37 @@ void PixelStream::render(const float tX, const float tY, const float tW, const f
     {
         if (isVisible( (*it)->getRect( )))
         {
-            (*it)->render(showSegmentBorders, showSegmentStatistics);
+            (*it)->renderOverlay(showSegmentBorders, showSegmentStatistics);
         }
     }
 
     glPopMatrix();
 }
 
+size_t PixelStream::getHostMemoryUsage() const
+{
+    size_t bytes = 0;
+
+    for(size_t i=0; i<frontBuffer_.size(); i++)
+        bytes += frontBuffer_[i].imageData.size();
+    for(size_t i=0; i<backBuffer_.size(); i++)
+        bytes += backBuffer_[i].imageData.size();
+
+    return bytes;
+}
+
+size_t PixelStream::getGPUMemoryUsage() const
+{
+    size_t bytes = 0;
+
+    for(size_t i=0; i<segmentRenderers_.size(); i++)
+        bytes += segmentRenderers_[i]->getTextureMemoryUsage();
+    for(size_t i=0; i<uploadBuffers_.size(); i++)
+        bytes += uploadBuffers_[i]->getMemoryUsage();
+
+    return bytes;
+}
+
 void PixelStream::adjustFrameDecodersCount(const size_t count)
 {
     // We need to insert NEW objects in the vector if it is smaller
@@ -186,6 +264,11 @@ void PixelStream::adjustFrameDecodersCount(const size_t count)
         frameDecoders_.push_back( PixelStreamSegmentDecoderPtr(new PixelStreamSegmentDecoder()) );
     // Or resize it if it is bigger
     frameDecoders_.resize( count );
+
+    // The upload buffers follow the decoders which write to them
+    for (size_t i=uploadBuffers_.size(); i<count; ++i)
+        uploadBuffers_.push_back( PixelBufferPoolPtr(new PixelBufferPool()) );
+    uploadBuffers_.resize( count );
 }
 
 void PixelStream::adjustSegmentRendererCount(const size_t count)
@@ -199,53 +282,85 @@ void PixelStream::adjustSegmentRendererCount(const size_t count)
     }
 }
 
-void PixelStream::insertNewFrame(const PixelStreamSegments &segments)
+void PixelStream::insertNewFrame(const PixelStreamSegments &segments, WireBufferPtr data)
 {
     backBuffer_ = segments;
+    backBufferData_ = data;
 }
 
+bool PixelStream::hasPendingFrame() const
+{
+    return !backBuffer_.empty();
+}
+
+size_t PixelStream::getPendingFramePixelCount() const
+{
+    size_t pixelCount = 0;
+    for(PixelStreamSegments::const_iterator it = backBuffer_.begin(); it != backBuffer_.end(); ++it)
+        pixelCount += (size_t)it->parameters.width * it->parameters.height;
+    return pixelCount;
+}
+
+void PixelStream::setFrameUpdateAllowed(const bool allowed)
+{
+    frameUpdateAllowed_ = allowed;
+}
 
-bool PixelStream::isDecodingInProgress()
+bool PixelStream::isFrameUpdateAllowed() const
 {
-    // determine if threads are running on any processes for this PixelStream
+    return frameUpdateAllowed_;
+}
 
-    // first, for this local process
-    int localThreadsRunning = 0;
 
+bool PixelStream::isLocalDecodingInProgress() const
+{
     std::vector<PixelStreamSegmentDecoderPtr>::const_iterator it;
     for (it = frameDecoders_.begin(); it != frameDecoders_.end(); it++)
     {
         if ((*it)->isRunning())
-            ++localThreadsRunning;
+            return true;
     }
+    return false;
+}
 
-    // now, globally for all render processes
-    int globalThreadsRunning;
+void PixelStream::setDecodingInProgress(const bool inProgress)
+{
+    decodingInProgress_ = inProgress;
+    decodingStateAgreed_ = true;
+}
 
-    MPI_Allreduce((void *)&localThreadsRunning, (void *)&globalThreadsRunning, 1, MPI_INT, MPI_SUM, g_mpiRenderComm);
+void PixelStream::updateWindowCoordinates()
+{
+    // Look up the window once per frame rather than for every segment
+    ContentWindowManagerPtr contentWindow = g_displayGroupManager->getContentWindowManager(uri_, CONTENT_TYPE_PIXEL_STREAM);
 
-    return globalThreadsRunning > 0;
+    hasWindow_ = contentWindow.get() != 0;
+    if(hasWindow_)
+        windowCoordinates_ = contentWindow->getCoordinates();
+    else
+        put_flog(LOG_WARN, "could not find window for stream");
 }
 
 bool PixelStream::isVisible(const QRect& segment)
 {
-    ContentWindowManagerPtr contentWindow = g_displayGroupManager->getContentWindowManager(uri_, CONTENT_TYPE_PIXEL_STREAM);
+    if(!hasWindow_)
+        return false;
 
-    if(contentWindow)
-    {
-        const QRectF& window = contentWindow->getCoordinates();
+    const QRectF& window = windowCoordinates_;
 
-        // coordinates of segment in global tiled display space
-        const double segmentX = window.x() + (double)segment.x() / (double)width_ * window.width();
-        const double segmentY = window.y() + (double)segment.y() / (double)height_ * window.height();
-        const double segmentW = (double)segment.width() / (double)width_ * window.width();
-        const double segmentH = (double)segment.height() / (double)height_ * window.height();
+    // coordinates of segment in global tiled display space
+    const double segmentX = window.x() + (double)segment.x() / (double)width_ * window.width();
+    const double segmentY = window.y() + (double)segment.y() / (double)height_ * window.height();
+    const double segmentW = (double)segment.width() / (double)width_ * window.width();
+    const double segmentH = (double)segment.height() / (double)height_ * window.height();
 
-        return g_mainWindow->isRegionVisible(segmentX, segmentY, segmentW, segmentH);
-    }
+    return g_mainWindow->isRegionVisible(segmentX, segmentY, segmentW, segmentH);
+}
 
-    put_flog(LOG_WARN, "could not find window for segment");
-    return false;
+bool PixelStream::hasImageData(const dc::PixelStreamSegment& segment) const
+{
+    // The master only sends the image data of the segments rendered by this process
+    return !segment.imageData.isEmpty();
 }
 
 bool PixelStream::isVisible(const dc::PixelStreamSegment& segment)
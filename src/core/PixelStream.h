@@ -42,6 +42,7 @@
 #include "FactoryObject.h"
 #include "PixelStreamSegment.h"
 #include "types.h"
+#include "WireFormat.h"
 
 #include <QtGui>
 #include <boost/shared_ptr.hpp>
@@ -54,7 +55,9 @@ typedef std::vector<PixelStreamSegment> PixelStreamSegments;
 
 class PixelStreamSegmentRenderer;
 class PixelStreamSegmentDecoder;
+class PixelBufferPool;
 typedef boost::shared_ptr<PixelStreamSegmentDecoder> PixelStreamSegmentDecoderPtr;
+typedef boost::shared_ptr<PixelBufferPool> PixelBufferPoolPtr;
 typedef boost::shared_ptr<PixelStreamSegmentRenderer> PixelStreamSegmentRendererPtr;
 
 class PixelStream : public FactoryObject
@@ -67,7 +70,42 @@ public:
     void preRenderUpdate();
     void render(const float tX, const float tY, const float tW, const float tH);
 
-    void insertNewFrame(const PixelStreamSegments& segments);
+    /** Draw the segment borders and statistics, once the textures added by render() are flushed. */
+    void renderOverlays();
+
+    /** @copydoc FactoryObject::getHostMemoryUsage */
+    size_t getHostMemoryUsage() const;
+
+    /** @copydoc FactoryObject::getGPUMemoryUsage */
+    size_t getGPUMemoryUsage() const;
+
+    /**
+     * Insert a frame received from the master process.
+     * @param segments The segments of the frame
+     * @param data The message holding the image data of the segments, if they refer to it
+     */
+    void insertNewFrame(const PixelStreamSegments& segments, WireBufferPtr data = WireBufferPtr());
+
+    /** Is a received frame waiting for the decoding of the previous one to finish */
+    bool hasPendingFrame() const;
+
+    /** Get the number of pixels of the received frame, 0 if there is none */
+    size_t getPendingFramePixelCount() const;
+
+    /** Allow or defer the update to the received frame, to be set before each preRenderUpdate() */
+    void setFrameUpdateAllowed(const bool allowed);
+
+    /** Can the received frame replace the current one in the next preRenderUpdate() */
+    bool isFrameUpdateAllowed() const;
+
+    /** Are decoding threads running for this stream on this process */
+    bool isLocalDecodingInProgress() const;
+
+    /**
+     * Set whether any render process is still decoding this stream, as agreed by all of them once
+     * per frame. Only the next preRenderUpdate() uses it, the following ones in the same frame return.
+     */
+    void setDecodingInProgress(const bool inProgress);
 
 private:
     // pixel stream identifier
@@ -81,11 +119,26 @@ private:
     PixelStreamSegments frontBuffer_;
     // The back buffer contains the next frame to process (last frame received)
     PixelStreamSegments backBuffer_;
+    // The received messages which hold the image data of the front and back buffers
+    WireBufferPtr frontBufferData_;
+    WireBufferPtr backBufferData_;
     bool buffersSwapped_;
+    bool frameUpdateAllowed_;
+
+    // Decoding state agreed by all render processes for this frame
+    bool decodingStateAgreed_;
+    bool decodingInProgress_;
+
+    // The coordinates of the window showing this stream, updated once per frame
+    bool hasWindow_;
+    QRectF windowCoordinates_;
 
     // The list of decoded images for the next frame
     std::vector<PixelStreamSegmentDecoderPtr> frameDecoders_;
 
+    // For each segment, the pixel buffers which the decoders write to, mapped until they are uploaded
+    std::vector<PixelBufferPoolPtr> uploadBuffers_;
+
     // For each segment, object for image decoding, rendering and storing parameters
     std::vector<PixelStreamSegmentRendererPtr> segmentRenderers_;
 
@@ -98,8 +151,8 @@ private:
     void adjustFrameDecodersCount(const size_t count);
     void adjustSegmentRendererCount(const size_t count);
 
-    bool isDecodingInProgress();
-
+    void updateWindowCoordinates();
+    bool hasImageData(const PixelStreamSegment& segment) const;
     bool isVisible(const QRect& segment);
     bool isVisible(const PixelStreamSegment& segment);
 };
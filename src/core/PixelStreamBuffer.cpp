@@ -39,10 +39,47 @@
 
 #include "PixelStreamBuffer.h"
 
+namespace
+{
+size_t computeDataSize(const PixelStreamSegments& segments)
+{
+    size_t size = 0;
+    for(size_t i=0; i<segments.size(); i++)
+        size += segments[i].imageData.size();
+    return size;
+}
+}
 
 PixelStreamBuffer::PixelStreamBuffer()
     : lastFrameComplete_(0)
+    , maxFrameLag_(0)
+    , maxBufferSize_(0)
+    , stragglerPolicy_(STRAGGLER_PARTIAL_FRAME)
+{
+}
+
+void PixelStreamBuffer::setLimits(const unsigned int maxFrameLag, const size_t maxBufferSize)
 {
+    maxFrameLag_ = maxFrameLag;
+    maxBufferSize_ = maxBufferSize;
+}
+
+void PixelStreamBuffer::setStragglerPolicy(const StragglerPolicy policy)
+{
+    stragglerPolicy_ = policy;
+}
+
+const PixelStreamBufferStatistics& PixelStreamBuffer::getStatistics() const
+{
+    return statistics_;
+}
+
+size_t PixelStreamBuffer::getBufferSize() const
+{
+    size_t size = 0;
+    for(SourceBufferMap::const_iterator it = sourceBuffers_.begin(); it != sourceBuffers_.end(); it++)
+        size += it->second.bufferSize;
+    return size;
 }
 
 void PixelStreamBuffer::addSource(const size_t sourceIndex)
@@ -50,7 +87,9 @@ void PixelStreamBuffer::addSource(const size_t sourceIndex)
     assert(!sourceBuffers_.count(sourceIndex));
 
     sourceBuffers_[sourceIndex] = SourceBuffer();
-    sourceBuffers_[sourceIndex].segments.push(PixelStreamSegments());
+    // A source joining an ongoing stream starts at the current frame
+    sourceBuffers_[sourceIndex].frameIndex = lastFrameComplete_;
+    sourceBuffers_[sourceIndex].segments.push_back(PixelStreamSegments());
 }
 
 void PixelStreamBuffer::removeSource(const size_t sourceIndex)
@@ -67,7 +106,9 @@ void PixelStreamBuffer::insertSegment(const dc::PixelStreamSegment& segment, con
 {
     assert(sourceBuffers_.count(sourceIndex));
 
-    sourceBuffers_[sourceIndex].segments.back().push_back(segment);
+    SourceBuffer& buffer = sourceBuffers_[sourceIndex];
+    buffer.segments.back().push_back(segment);
+    buffer.bufferSize += segment.imageData.size();
 }
 
 void PixelStreamBuffer::finishFrameForSource(const size_t sourceIndex)
@@ -75,20 +116,20 @@ void PixelStreamBuffer::finishFrameForSource(const size_t sourceIndex)
     assert(sourceBuffers_.count(sourceIndex));
 
     sourceBuffers_[sourceIndex].frameIndex++;
-    sourceBuffers_[sourceIndex].segments.push(PixelStreamSegments());
+    sourceBuffers_[sourceIndex].segments.push_back(PixelStreamSegments());
+
+    if (stragglerPolicy_ == STRAGGLER_DROP_FRAME)
+        dropOldestFrames();
 }
 
 bool PixelStreamBuffer::hasFrameComplete() const
 {
     assert(!sourceBuffers_.empty());
 
-    // Check if all sources for Stream have reached the same index
-    for(SourceBufferMap::const_iterator it = sourceBuffers_.begin(); it != sourceBuffers_.end(); it++)
-    {
-        if (it->second.frameIndex <= lastFrameComplete_)
-            return false;
-    }
-    return true;
+    if (isFrameCompleteForAllSources())
+        return true;
+
+    return stragglerPolicy_ == STRAGGLER_PARTIAL_FRAME && isOverLimits();
 }
 
 bool PixelStreamBuffer::isFirstFrame() const
@@ -98,14 +139,47 @@ bool PixelStreamBuffer::isFirstFrame() const
 
 PixelStreamSegments PixelStreamBuffer::getFrame()
 {
+    const bool partialFrame = !isFrameCompleteForAllSources();
+    size_t skippedFrames = 0;
+
     PixelStreamSegments frame;
     for(SourceBufferMap::iterator it = sourceBuffers_.begin(); it != sourceBuffers_.end(); it++)
     {
         SourceBuffer& buffer = it->second;
-        frame.insert(frame.end(), buffer.segments.front().begin(), buffer.segments.front().end());
-        buffer.segments.pop();
+
+        if (buffer.frameIndex > lastFrameComplete_)
+        {
+            // When the frame is partial, the late sources have already held
+            // back the others for too long: only keep the most recent frame.
+            size_t skipped = 0;
+            while (partialFrame && buffer.frameIndex - lastFrameComplete_ > 1)
+            {
+                buffer.bufferSize -= computeDataSize(buffer.segments.front());
+                buffer.segments.pop_front();
+                buffer.frameIndex--;
+                ++skipped;
+            }
+            skippedFrames = std::max(skippedFrames, skipped);
+
+            buffer.lastFrame = buffer.segments.front();
+            buffer.bufferSize -= computeDataSize(buffer.lastFrame);
+            buffer.segments.pop_front();
+        }
+        else
+        {
+            // Late source: reuse its previous segments and skip the frame it missed
+            buffer.frameIndex = lastFrameComplete_ + 1;
+        }
+        frame.insert(frame.end(), buffer.lastFrame.begin(), buffer.lastFrame.end());
     }
     ++lastFrameComplete_;
+
+    if (partialFrame)
+        ++statistics_.partialFrames;
+    else
+        ++statistics_.completeFrames;
+    statistics_.droppedFrames += skippedFrames;
+
     return frame;
 }
 
@@ -113,12 +187,19 @@ QSize PixelStreamBuffer::getFrameSize() const
 {
     QSize size(0,0);
 
+    const bool partialFrame = !isFrameCompleteForAllSources() && hasFrameComplete();
+
     for(SourceBufferMap::const_iterator it = sourceBuffers_.begin(); it != sourceBuffers_.end(); it++)
     {
         const SourceBuffer& buffer = it->second;
-        if (!buffer.segments.empty())
+
+        // Late sources contribute their previous segments to a partial frame
+        const bool isLate = partialFrame && buffer.frameIndex <= lastFrameComplete_;
+        if (isLate || !buffer.segments.empty())
         {
-            const PixelStreamSegments& segments = buffer.segments.front();
+            // The sources ahead contribute their most recent frame to a partial frame, see getFrame()
+            const size_t frameOffset = partialFrame && !isLate ? buffer.frameIndex - lastFrameComplete_ - 1 : 0;
+            const PixelStreamSegments& segments = isLate ? buffer.lastFrame : buffer.segments[frameOffset];
 
             for(size_t i=0; i<segments.size(); i++)
             {
@@ -146,4 +227,51 @@ QSize PixelStreamBuffer::computeFrameDimensions(const PixelStreamSegments &segme
     return size;
 }
 
+bool PixelStreamBuffer::isFrameCompleteForAllSources() const
+{
+    // Check if all sources for Stream have reached the same index
+    for(SourceBufferMap::const_iterator it = sourceBuffers_.begin(); it != sourceBuffers_.end(); it++)
+    {
+        if (it->second.frameIndex <= lastFrameComplete_)
+            return false;
+    }
+    return true;
+}
+
+bool PixelStreamBuffer::isOverLimits() const
+{
+    bool hasBufferedFrame = false;
+    size_t bufferSize = 0;
+
+    for(SourceBufferMap::const_iterator it = sourceBuffers_.begin(); it != sourceBuffers_.end(); it++)
+    {
+        const FrameIndex bufferedFrames = it->second.frameIndex - lastFrameComplete_;
+
+        if (maxFrameLag_ > 0 && bufferedFrames > maxFrameLag_)
+            return true;
+
+        hasBufferedFrame = hasBufferedFrame || bufferedFrames > 0;
+        bufferSize += it->second.bufferSize;
+    }
+
+    // Only complete frames can be delivered or dropped
+    return hasBufferedFrame && maxBufferSize_ > 0 && bufferSize > maxBufferSize_;
+}
 
+void PixelStreamBuffer::dropOldestFrames()
+{
+    while (!isFrameCompleteForAllSources() && isOverLimits())
+    {
+        for(SourceBufferMap::iterator it = sourceBuffers_.begin(); it != sourceBuffers_.end(); it++)
+        {
+            SourceBuffer& buffer = it->second;
+            if (buffer.frameIndex > lastFrameComplete_)
+            {
+                buffer.bufferSize -= computeDataSize(buffer.segments.front());
+                buffer.segments.pop_front();
+                buffer.frameIndex--;
+            }
+        }
+        ++statistics_.droppedFrames;
+    }
+}
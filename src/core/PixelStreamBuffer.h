@@ -41,11 +41,12 @@
 #define PIXELSTREAMBUFFER_H
 
 #include "PixelStreamSegment.h"
+#include "PixelStreamPolicies.h"
 
 #include <QSize>
 
 #include <vector>
-#include <queue>
+#include <deque>
 #include <map>
 
 using dc::PixelStreamSegment;
@@ -55,18 +56,41 @@ typedef unsigned int FrameIndex;
 
 typedef std::vector<PixelStreamSegment> PixelStreamSegments;
 
+/**
+ * Counters for the frames handled by a PixelStreamBuffer.
+ */
+struct PixelStreamBufferStatistics
+{
+    PixelStreamBufferStatistics() : completeFrames(0), partialFrames(0), droppedFrames(0) {}
+
+    /** Frames for which all the sources contributed */
+    size_t completeFrames;
+
+    /** Frames completed with the previous segments of late sources */
+    size_t partialFrames;
+
+    /** Frames discarded to keep the buffer within its limits */
+    size_t droppedFrames;
+};
+
 /**
  * Buffer for a single source of segements.
  */
 struct SourceBuffer
 {
-    SourceBuffer() : frameIndex(0) {}
+    SourceBuffer() : frameIndex(0), bufferSize(0) {}
 
     /** The current index of the frame for this source */
     FrameIndex frameIndex;
 
     /** The collection of segments */
-    std::queue<PixelStreamSegments> segments;
+    std::deque<PixelStreamSegments> segments;
+
+    /** The segments of the last frame delivered for this source */
+    PixelStreamSegments lastFrame;
+
+    /** The amount of image data currently buffered, in bytes */
+    size_t bufferSize;
 };
 
 typedef std::map<size_t, SourceBuffer> SourceBufferMap;
@@ -79,9 +103,30 @@ typedef std::map<size_t, SourceBuffer> SourceBufferMap;
 class PixelStreamBuffer
 {
 public:
-    /** Construct a Buffer */
+    /** Construct a Buffer, without limits until setLimits() is called */
     PixelStreamBuffer();
 
+    /**
+     * Set the limits of the buffer.
+     * @param maxFrameLag Maximum number of complete frames buffered for a source
+     *        while waiting for the other sources. 0 means unlimited.
+     * @param maxBufferSize Maximum amount of image data buffered for all
+     *        sources, in bytes. 0 means unlimited.
+     */
+    void setLimits(const unsigned int maxFrameLag, const size_t maxBufferSize);
+
+    /**
+     * Set the policy to apply when a late source makes the buffer exceed its limits.
+     * @param policy The policy, STRAGGLER_PARTIAL_FRAME by default.
+     */
+    void setStragglerPolicy(const StragglerPolicy policy);
+
+    /** Get the frame counters for this buffer */
+    const PixelStreamBufferStatistics& getStatistics() const;
+
+    /** Get the amount of image data currently buffered, in bytes */
+    size_t getBufferSize() const;
+
     /**
      * Add a source of segments.
      * @param sourceIndex Unique source identifier
@@ -110,7 +155,12 @@ public:
      */
     void finishFrameForSource(const size_t sourceIndex);
 
-    /** Does the Buffer have a complete frame (from all sources) */
+    /**
+     * Does the Buffer have a complete frame.
+     *
+     * A frame is complete when all sources have finished it, or when the
+     * buffer limits are exceeded and the policy is STRAGGLER_PARTIAL_FRAME.
+     */
     bool hasFrameComplete() const;
 
     /** Is this the first frame */
@@ -121,6 +171,8 @@ public:
 
     /**
      * Get the finished frame.
+     *
+     * Late sources contribute the segments of their last delivered frame.
      * @return A collection of segments that form a frame
      */
     PixelStreamSegments getFrame();
@@ -135,6 +187,15 @@ public:
 private:
     FrameIndex lastFrameComplete_;
     SourceBufferMap sourceBuffers_;
+
+    unsigned int maxFrameLag_;
+    size_t maxBufferSize_;
+    StragglerPolicy stragglerPolicy_;
+    PixelStreamBufferStatistics statistics_;
+
+    bool isFrameCompleteForAllSources() const;
+    bool isOverLimits() const;
+    void dropOldestFrames();
 };
 
 #endif // PIXELSTREAMBUFFER_H
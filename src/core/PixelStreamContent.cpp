@@ -65,3 +65,8 @@ void PixelStreamContent::renderFactoryObject(float tX, float tY, float tW, float
 {
     g_mainWindow->getGLWindow()->getPixelStreamFactory().getObject(getURI())->render(tX, tY, tW, tH);
 }
+
+void PixelStreamContent::renderFactoryObjectOverlays()
+{
+    g_mainWindow->getGLWindow()->getPixelStreamFactory().getObject(getURI())->renderOverlays();
+}
@@ -64,6 +64,7 @@ class PixelStreamContent : public Content
         }
 
         void renderFactoryObject(float tX, float tY, float tW, float tH);
+        void renderFactoryObjectOverlays();
 };
 
 #endif
@@ -0,0 +1,274 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "PixelStreamDecoderPool.h"
+
+#include "PixelStreamSegment.h"
+#include "ImageJpegDecompressor.h"
+#include "log.h"
+
+#include <QThread>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+class PixelStreamDecoderPool::Worker : public QThread
+{
+public:
+    Worker(PixelStreamDecoderPool& pool, const size_t index)
+        : pool_(pool)
+        , index_(index)
+    {
+        start();
+    }
+
+protected:
+    void run()
+    {
+        pool_.runWorker(index_, decompressor_);
+    }
+
+private:
+    PixelStreamDecoderPool& pool_;
+    const size_t index_;
+
+    // each thread decodes with its own handle
+    ImageJpegDecompressor decompressor_;
+};
+
+namespace
+{
+/**
+ * Count the cores the process may run on. The render processes are bound to the cores
+ * of a NUMA node by the launcher, and the threads of the pool inherit this binding.
+ */
+unsigned int getAvailableCoreCount()
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+    if(sched_getaffinity(0, sizeof(cpus), &cpus) == 0 && CPU_COUNT(&cpus) > 0)
+        return CPU_COUNT(&cpus);
+#endif
+    return std::max(QThread::idealThreadCount(), 1);
+}
+
+void decodeSegment(ImageJpegDecompressor& decompressor, PixelStreamSegment* segment, unsigned char* buffer)
+{
+    if ( buffer )
+    {
+        if ( decompressor.decompress(segment->imageData, buffer, segment->parameters.width, segment->parameters.height) )
+        {
+            segment->imageData.clear();
+            segment->parameters.compressed = false;
+        }
+        return;
+    }
+
+    QByteArray decodedData = decompressor.decompress(segment->imageData);
+
+    if ( !decodedData.isEmpty() )
+    {
+        segment->imageData = decodedData;
+        segment->parameters.compressed = false;
+    }
+}
+}
+
+PixelStreamDecoderPool::PixelStreamDecoderPool(const unsigned int threadCount)
+    : nextQueue_(0)
+    , stopping_(false)
+{
+    const size_t count = threadCount > 0 ? threadCount : getAvailableCoreCount();
+
+    // the queues must exist before the threads look into them
+    queues_.resize(count);
+
+    for(size_t i=0; i<count; i++)
+        workers_.push_back(WorkerPtr(new Worker(*this, i)));
+}
+
+PixelStreamDecoderPool::~PixelStreamDecoderPool()
+{
+    {
+        QMutexLocker locker(&mutex_);
+        stopping_ = true;
+        jobQueued_.wakeAll();
+    }
+
+    for(size_t i=0; i<workers_.size(); i++)
+        workers_[i]->wait();
+}
+
+PixelStreamDecoderPool& PixelStreamDecoderPool::getDefaultPool()
+{
+    static PixelStreamDecoderPool pool;
+    return pool;
+}
+
+size_t PixelStreamDecoderPool::getThreadCount() const
+{
+    return workers_.size();
+}
+
+void PixelStreamDecoderPool::decode(const PixelStreamSegmentDecoder* decoder, PixelStreamSegment& segment,
+                                    unsigned char* buffer)
+{
+    QMutexLocker locker(&mutex_);
+
+    DecodeJob& job = jobs_[decoder];
+
+    if(job.queued)
+        put_flog(LOG_DEBUG, "A newer segment replaces the one waiting to be decoded");
+
+    job.segment = &segment;
+    job.buffer = buffer;
+
+    // the job is queued again by its thread once the current segment is decoded
+    if(job.queued || job.running)
+    {
+        job.queued = true;
+        return;
+    }
+
+    job.queued = true;
+    queueJob(decoder, nextQueue_);
+    nextQueue_ = (nextQueue_ + 1) % queues_.size();
+}
+
+bool PixelStreamDecoderPool::isDecoding(const PixelStreamSegmentDecoder* decoder) const
+{
+    QMutexLocker locker(&mutex_);
+
+    return jobs_.find(decoder) != jobs_.end();
+}
+
+void PixelStreamDecoderPool::cancel(const PixelStreamSegmentDecoder* decoder)
+{
+    QMutexLocker locker(&mutex_);
+
+    for(size_t i=0; i<queues_.size(); i++)
+        queues_[i].erase(std::remove(queues_[i].begin(), queues_[i].end(), decoder), queues_[i].end());
+
+    std::map<const PixelStreamSegmentDecoder*, DecodeJob>::iterator it = jobs_.find(decoder);
+    if(it == jobs_.end())
+        return;
+
+    it->second.queued = false;
+
+    // the thread removes the job once its segment is decoded
+    while(it->second.running)
+    {
+        jobFinished_.wait(&mutex_);
+
+        it = jobs_.find(decoder);
+        if(it == jobs_.end())
+            return;
+    }
+
+    jobs_.erase(it);
+}
+
+void PixelStreamDecoderPool::runWorker(const size_t index, ImageJpegDecompressor& decompressor)
+{
+    QMutexLocker locker(&mutex_);
+
+    while(true)
+    {
+        const PixelStreamSegmentDecoder* decoder = 0;
+        while(!stopping_ && !(decoder = takeJob(index)))
+            jobQueued_.wait(&mutex_);
+
+        if(stopping_)
+            break;
+
+        DecodeJob& job = jobs_[decoder];
+        PixelStreamSegment* segment = job.segment;
+        unsigned char* buffer = job.buffer;
+        job.queued = false;
+        job.running = true;
+
+        locker.unlock();
+        decodeSegment(decompressor, segment, buffer);
+        locker.relock();
+
+        // the job is only removed by this thread or by cancel(), which waits for it
+        DecodeJob& finishedJob = jobs_[decoder];
+        finishedJob.running = false;
+
+        // decode the segment which arrived in the meantime, unless another thread steals it
+        if(finishedJob.queued)
+            queueJob(decoder, index);
+        else
+            jobs_.erase(decoder);
+
+        jobFinished_.wakeAll();
+    }
+}
+
+void PixelStreamDecoderPool::queueJob(const PixelStreamSegmentDecoder* decoder, const size_t index)
+{
+    queues_[index].push_back(decoder);
+    jobQueued_.wakeOne();
+}
+
+const PixelStreamSegmentDecoder* PixelStreamDecoderPool::takeJob(const size_t index)
+{
+    // oldest job of the own queue first
+    if(!queues_[index].empty())
+    {
+        const PixelStreamSegmentDecoder* decoder = queues_[index].front();
+        queues_[index].pop_front();
+        return decoder;
+    }
+
+    // otherwise steal the newest job of another thread, which it would process last
+    for(size_t i=1; i<queues_.size(); i++)
+    {
+        JobQueue& queue = queues_[(index + i) % queues_.size()];
+        if(!queue.empty())
+        {
+            const PixelStreamSegmentDecoder* decoder = queue.back();
+            queue.pop_back();
+            return decoder;
+        }
+    }
+
+    return 0;
+}
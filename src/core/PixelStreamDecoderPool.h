@@ -0,0 +1,128 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef PIXELSTREAMDECODERPOOL_H
+#define PIXELSTREAMDECODERPOOL_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <boost/shared_ptr.hpp>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace dc
+{
+struct PixelStreamSegment;
+}
+using dc::PixelStreamSegment;
+
+class PixelStreamSegmentDecoder;
+class ImageJpegDecompressor;
+
+/**
+ * A pool of threads dedicated to decoding the segments of the pixel streams.
+ *
+ * Each thread has its own queue of segments and its own decompressor. Idle threads steal the
+ * segments queued to the other ones. A decoder has at most one segment queued: a newer segment
+ * replaces the queued one, so that only the latest frame of a stream is decoded.
+ */
+class PixelStreamDecoderPool
+{
+public:
+    /**
+     * Construct and start the threads of a pool.
+     * @param threadCount The number of threads, 0 for one per core available to the process
+     */
+    PixelStreamDecoderPool(const unsigned int threadCount = 0);
+
+    /** Stop the threads, the queued segments are not decoded. */
+    ~PixelStreamDecoderPool();
+
+    /** Get the pool used by default by the decoders of the process. */
+    static PixelStreamDecoderPool& getDefaultPool();
+
+    /** Get the number of threads of the pool. */
+    size_t getThreadCount() const;
+
+    /**
+     * Queue the decoding of a segment, replacing the one queued for the same decoder.
+     * @see PixelStreamSegmentDecoder::startDecoding()
+     */
+    void decode(const PixelStreamSegmentDecoder* decoder, PixelStreamSegment& segment,
+                unsigned char* buffer);
+
+    /** Check if a segment of the decoder is queued or being decoded. */
+    bool isDecoding(const PixelStreamSegmentDecoder* decoder) const;
+
+    /** Remove the segment queued for the decoder and wait until the one being decoded is done. */
+    void cancel(const PixelStreamSegmentDecoder* decoder);
+
+private:
+    class Worker;
+    typedef boost::shared_ptr<Worker> WorkerPtr;
+
+    struct DecodeJob
+    {
+        PixelStreamSegment* segment;
+        unsigned char* buffer;
+        bool queued;
+        bool running;
+
+        DecodeJob() : segment(0), buffer(0), queued(false), running(false) {}
+    };
+
+    typedef std::deque<const PixelStreamSegmentDecoder*> JobQueue;
+
+    std::vector<WorkerPtr> workers_;
+
+    // All the queues and jobs are protected by the same mutex, a frame only has a few jobs per thread
+    mutable QMutex mutex_;
+    QWaitCondition jobQueued_;
+    QWaitCondition jobFinished_;
+    std::vector<JobQueue> queues_;
+    std::map<const PixelStreamSegmentDecoder*, DecodeJob> jobs_;
+    size_t nextQueue_;
+    bool stopping_;
+
+    void runWorker(const size_t index, ImageJpegDecompressor& decompressor);
+    void queueJob(const PixelStreamSegmentDecoder* decoder, const size_t index);
+    const PixelStreamSegmentDecoder* takeJob(const size_t index);
+};
+
+#endif // PIXELSTREAMDECODERPOOL_H
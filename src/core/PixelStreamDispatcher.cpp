@@ -39,26 +39,37 @@
 
 #include "PixelStreamDispatcher.h"
 #include "DisplayGroupManager.h"
+#include "ContentWindowManager.h"
+#include "configuration/MasterConfiguration.h"
 #include "globals.h"
+#include "log.h"
 
 #include "MessageHeader.h"
-#include <boost/serialization/vector.hpp>
-#include <mpi.h>
+#include "MPIChannel.h"
 
-#define DISPATCH_FREQUENCY 100
+// Interval for checking if the wall is ready while frames are waiting
+#define WALL_READY_POLL_INTERVAL_MS 1
+
+// Dispatch anyway if the wall did not notify its readiness in time (e.g. the stream window was closed)
+#define WALL_READY_TIMEOUT_MS 100
 
 #define STREAM_WINDOW_DEFAULT_SIZE 100
 
 PixelStreamDispatcher::PixelStreamDispatcher()
+    : transcoder_(static_cast<MasterConfiguration*>(g_configuration)->getPixelStreamTranscodingQuality())
+    , scheduler_(static_cast<MasterConfiguration*>(g_configuration)->getPixelStreamDispatchBudget())
+    , wallReady_(true)
+    , dispatchPending_(false)
+    , sentFrameCount_(0)
 {
-#ifdef USE_TIMER
-    connect(&sendTimer_, SIGNAL(timeout()), this, SLOT(dispatchFrames()));
-    sendTimer_.start(1000/DISPATCH_FREQUENCY);
-#else
     lastFrameSent_ = boost::posix_time::microsec_clock::universal_time();
     // Not using a queued connection here causes the rendering to lag behind and the main UI to freeze..
     connect(this, SIGNAL(dispatchFramesSignal()), this, SLOT(dispatchFrames()), Qt::QueuedConnection);
-#endif
+
+    wallReadyTimer_.setInterval(WALL_READY_POLL_INTERVAL_MS);
+    connect(&wallReadyTimer_, SIGNAL(timeout()), this, SLOT(dispatchFramesIfWallReady()));
+
+    connect(&transcodingWatcher_, SIGNAL(finished()), this, SLOT(finishTranscoding()));
 
     // Connect with the DisplayGroupManager
     connect(this, SIGNAL(openPixelStream(QString, int, int)), g_displayGroupManager.get(), SLOT(openPixelStream(QString, int, int)));
@@ -66,118 +77,334 @@ PixelStreamDispatcher::PixelStreamDispatcher()
     connect(g_displayGroupManager.get(), SIGNAL(pixelStreamViewClosed(QString)), this, SLOT(deleteStream(QString)));
 }
 
-void PixelStreamDispatcher::addSource(const QString uri, const size_t sourceIndex)
+PixelStreamDispatcher::~PixelStreamDispatcher()
+{
+    // The segments being transcoded belong to this object
+    transcodingWatcher_.waitForFinished();
+}
+
+TranscodingPolicy PixelStreamDispatcher::getTranscodingPolicy(const PixelStreamId streamId) const
+{
+    const MasterConfiguration* configuration = static_cast<MasterConfiguration*>(g_configuration);
+    return transcodingPolicies_.value(streamId, configuration->getPixelStreamTranscodingPolicy());
+}
+
+void PixelStreamDispatcher::addSource(const PixelStreamId streamId, const size_t sourceIndex)
 {
-    streamBuffers_[uri].addSource(sourceIndex);
+    if (!streamBuffers_.contains(streamId))
+    {
+        const MasterConfiguration* configuration = static_cast<MasterConfiguration*>(g_configuration);
+
+        PixelStreamBuffer& buffer = streamBuffers_[streamId];
+        buffer.setLimits(configuration->getPixelStreamMaxFrameLag(), configuration->getPixelStreamMaxBufferSize());
+        buffer.setStragglerPolicy(configuration->getPixelStreamStragglerPolicy());
+
+        sendPixelStreamOpen(streamId);
+    }
+
+    streamBuffers_[streamId].addSource(sourceIndex);
 }
 
-void PixelStreamDispatcher::removeSource(const QString uri, const size_t sourceIndex)
+void PixelStreamDispatcher::removeSource(const PixelStreamId streamId, const size_t sourceIndex)
 {
-    if(!streamBuffers_.count(uri))
+    StreamBuffers::iterator it = streamBuffers_.find(streamId);
+    if (it == streamBuffers_.end())
         return;
 
-    streamBuffers_[uri].removeSource(sourceIndex);
+    it->removeSource(sourceIndex);
 
-    if (streamBuffers_[uri].getSourceCount() == 0)
+    if (it->getSourceCount() == 0)
     {
-        deleteStream(uri);
+        deleteStream(streamId);
     }
 }
 
-void PixelStreamDispatcher::processSegment(const QString uri, const size_t sourceIndex, dc::PixelStreamSegment segment)
+void PixelStreamDispatcher::processSegment(const PixelStreamId streamId, const size_t sourceIndex, dc::PixelStreamSegment segment)
 {
-    if (streamBuffers_.count(uri))
-        streamBuffers_[uri].insertSegment(segment, sourceIndex);
+    StreamBuffers::iterator it = streamBuffers_.find(streamId);
+    if (it != streamBuffers_.end())
+        it->insertSegment(segment, sourceIndex);
 }
 
-void PixelStreamDispatcher::processFrameFinished(const QString uri, const size_t sourceIndex)
+void PixelStreamDispatcher::processFrameFinished(const PixelStreamId streamId, const size_t sourceIndex)
 {
-    if (!streamBuffers_.count(uri))
+    StreamBuffers::iterator it = streamBuffers_.find(streamId);
+    if (it == streamBuffers_.end())
         return;
 
-    streamBuffers_[uri].finishFrameForSource(sourceIndex);
+    PixelStreamBuffer& buffer = *it;
+    buffer.finishFrameForSource(sourceIndex);
 
     // When the first frame is complete, notify that the stream is now open
-    if (streamBuffers_[uri].isFirstFrame() && streamBuffers_[uri].hasFrameComplete())
+    if (buffer.isFirstFrame() && buffer.hasFrameComplete())
     {
-        QSize size = streamBuffers_[uri].getFrameSize();
-        emit openPixelStream(uri, size.width(), size.height());
+        QSize size = buffer.getFrameSize();
+        emit openPixelStream(g_pixelStreamRegistry.getUri(streamId), size.width(), size.height());
     }
 
-#ifdef USE_TIMER
-#else
-    const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
-    if ((now - lastFrameSent_).total_milliseconds() > 1000/DISPATCH_FREQUENCY)
+    if (buffer.hasFrameComplete())
     {
-        lastFrameSent_ = now;
-        //dispatchFrames(); // See comment above about direct Signal connection..
-        emit dispatchFramesSignal();
+        dispatchFramesIfWallReady();
     }
-#endif
 }
 
 void PixelStreamDispatcher::deleteStream(const QString uri)
 {
-    if (streamBuffers_.count(uri))
+    deleteStream(g_pixelStreamRegistry.getId(uri));
+}
+
+void PixelStreamDispatcher::deleteStream(const PixelStreamId streamId)
+{
+    StreamBuffers::iterator it = streamBuffers_.find(streamId);
+    if (it == streamBuffers_.end())
+        return;
+
+    const QString uri = g_pixelStreamRegistry.getUri(streamId);
+
+    const PixelStreamBufferStatistics& statistics = it->getStatistics();
+    put_flog(LOG_INFO, "stream %s: %u complete frames, %u partial frames, %u dropped frames",
+             uri.toLocal8Bit().constData(), (unsigned int)statistics.completeFrames,
+             (unsigned int)statistics.partialFrames, (unsigned int)statistics.droppedFrames);
+
+    streamBuffers_.erase(it);
+    pendingFrames_.remove(streamId);
+    transcodingPolicies_.remove(streamId);
+
+    sendPixelStreamClose(streamId);
+    g_pixelStreamRegistry.unregisterStream(streamId);
+
+    emit deletePixelStream(uri);
+}
+
+void PixelStreamDispatcher::setTranscodingPolicy(const QString uri, const TranscodingPolicy policy)
+{
+    // Only the streams which are open have an identifier, and their policy is released when they close
+    const PixelStreamId streamId = g_pixelStreamRegistry.getId(uri);
+    if (streamId == INVALID_PIXELSTREAM_ID)
     {
-        streamBuffers_.erase(uri);
-        emit deletePixelStream(uri);
+        put_flog(LOG_WARN, "unknown stream %s, transcoding policy ignored", uri.toLocal8Bit().constData());
+        return;
+    }
+
+    transcodingPolicies_[streamId] = policy;
+}
+
+void PixelStreamDispatcher::dispatchFramesIfWallReady()
+{
+    // The next frames are dispatched once the transcoded ones have been sent
+    if (!scheduledFrames_.empty())
+        return;
+
+    if (!wallReady_)
+    {
+        const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+        wallReady_ = g_displayGroupManager->receivePixelStreamsReady(sentFrameCount_) ||
+                     (now - lastFrameSent_).total_milliseconds() > WALL_READY_TIMEOUT_MS;
+    }
+
+    if (!wallReady_)
+    {
+        if (!wallReadyTimer_.isActive())
+            wallReadyTimer_.start();
+        return;
+    }
+
+    wallReadyTimer_.stop();
+
+    if (!dispatchPending_)
+    {
+        dispatchPending_ = true;
+        //dispatchFrames(); // See comment above about direct Signal connection..
+        emit dispatchFramesSignal();
     }
 }
 
 void PixelStreamDispatcher::dispatchFrames()
 {
+    dispatchPending_ = false;
+
+    if (!scheduledFrames_.empty())
+        return;
+
+    // Only dispatch the last frame of each stream
     for (StreamBuffers::iterator it = streamBuffers_.begin(); it != streamBuffers_.end(); ++it)
     {
-        // Only dispatch the last frame
-        PixelStreamSegments segments;
-        while (it->second.hasFrameComplete())
+        while (it->hasFrameComplete())
         {
-            segments = it->second.getFrame();
+            pendingFrames_[it.key()] = it->getFrame();
         }
-        if (!segments.empty())
-        {
-            QSize size = it->second.computeFrameDimensions(segments);
-            g_displayGroupManager->adjustPixelStreamContentDimensions(it->first, size.width(), size.height(), false);
+    }
 
-            sendPixelStreamSegments(segments, it->first);
-        }
+    std::map<PixelStreamId, size_t> costs;
+    for (PendingFrames::const_iterator it = pendingFrames_.begin(); it != pendingFrames_.end(); ++it)
+    {
+        costs[it.key()] = PixelStreamTranscoder::getImageDataSize(it.value());
+    }
+
+    recordSentFrames();
+    updateRouterScreens();
+
+    // The most visible streams go first, the others may have to wait for the next dispatch
+    scheduler_.updatePriorities(g_displayGroupManager->getContentWindowManagers());
+    const std::set<PixelStreamId> scheduledStreams = scheduler_.schedule(costs);
+
+    for (std::set<PixelStreamId>::const_iterator it = scheduledStreams.begin(); it != scheduledStreams.end(); ++it)
+    {
+        const PixelStreamId streamId = *it;
+        PixelStreamSegments& segments = pendingFrames_[streamId];
+
+        QSize size = streamBuffers_[streamId].computeFrameDimensions(segments);
+        g_displayGroupManager->adjustPixelStreamContentDimensions(g_pixelStreamRegistry.getUri(streamId),
+                                                                  size.width(), size.height(), false);
+
+        ScheduledFrame frame;
+        frame.streamId = streamId;
+        frame.segments = segments;
+        frame.rawSize = costs[streamId];
+        frame.transcode = transcoder_.isTranscodingNeeded(getTranscodingPolicy(streamId));
+        scheduledFrames_.push_back(frame);
+
+        if (frame.transcode)
+            transcodingSegments_.insert(transcodingSegments_.end(), segments.begin(), segments.end());
+
+        pendingFrames_.remove(streamId);
     }
+
+    // Wait for the wall to consume these frames before sending new ones
+    if (!scheduledStreams.empty())
+        wallReady_ = false;
+
+    // The JPEG encoding must not block the event loop, the frames are sent when it has finished
+    if (!transcodingSegments_.empty())
+    {
+        transcodingWatcher_.setFuture(transcoder_.startTranscoding(transcodingSegments_));
+        return;
+    }
+
+    sendScheduledFrames();
 }
 
-void PixelStreamDispatcher::sendPixelStreamSegments(const std::vector<PixelStreamSegment> & segments, const QString& uri)
+void PixelStreamDispatcher::finishTranscoding()
 {
-    assert(!segments.empty() && "sendPixelStreamSegments() received an empty vector");
+    // Put the transcoded segments back into their frames
+    PixelStreamSegments::const_iterator transcoded = transcodingSegments_.begin();
+    for (std::vector<ScheduledFrame>::iterator it = scheduledFrames_.begin(); it != scheduledFrames_.end(); ++it)
+    {
+        if (!it->transcode)
+            continue;
 
-    // serialize the vector
-    std::ostringstream oss(std::ostringstream::binary);
+        for (PixelStreamSegments::iterator segment = it->segments.begin(); segment != it->segments.end(); ++segment)
+            *segment = *transcoded++;
+    }
+    transcodingSegments_.clear();
 
-    // brace this so destructor is called on archive before we use the stream
+    sendScheduledFrames();
+}
+
+void PixelStreamDispatcher::sendScheduledFrames()
+{
+    for (std::vector<ScheduledFrame>::const_iterator it = scheduledFrames_.begin(); it != scheduledFrames_.end(); ++it)
     {
-        boost::archive::binary_oarchive oa(oss);
-        oa << segments;
+        // The stream may have been deleted while its frame was being transcoded
+        if (streamBuffers_.contains(it->streamId))
+            sendPixelStreamSegments(it->segments, it->streamId, it->rawSize);
     }
 
-    // serialized data to string
-    std::string serializedString = oss.str();
-    int size = serializedString.size();
+    if (!scheduledFrames_.empty())
+        lastFrameSent_ = boost::posix_time::microsec_clock::universal_time();
+    scheduledFrames_.clear();
 
-    // send the header and the message
-    MessageHeader mh;
-    mh.size = size;
-    mh.type = MESSAGE_TYPE_PIXELSTREAM;
+    // The streams which did not fit in the budget are sent as soon as the wall is ready again
+    if (!pendingFrames_.empty())
+    {
+        dispatchFramesIfWallReady();
+    }
+}
 
-    // add the truncated URI to the header
-    strncpy(mh.uri, uri.toLocal8Bit().constData(), MESSAGE_HEADER_URI_LENGTH-1);
+void PixelStreamDispatcher::sendPixelStreamOpen(const PixelStreamId streamId)
+{
+    // the uri is only sent once, the frames then refer to the stream by its id
+    g_mpiChannel->broadcast(MESSAGE_TYPE_PIXELSTREAM_OPEN, (const char *)&streamId, sizeof(PixelStreamId),
+                            g_pixelStreamRegistry.getUri(streamId).toStdString());
+}
 
-    // the header is sent via a send, so that we can probe it on the render processes
-    for(int i=1; i<g_mpiSize; i++)
+void PixelStreamDispatcher::sendPixelStreamClose(const PixelStreamId streamId)
+{
+    // the Wall processes forget the id after the frames which were sent before
+    g_mpiChannel->broadcast(MESSAGE_TYPE_PIXELSTREAM_CLOSE, (const char *)&streamId, sizeof(PixelStreamId));
+}
+
+void PixelStreamDispatcher::recordSentFrames()
+{
+    // the frames are sent in the background, their timing is known once they have left
+    const MPISentMessages sentMessages = g_mpiChannel->takeSentMessages();
+
+    for(MPISentMessages::const_iterator it = sentMessages.begin(); it != sentMessages.end(); ++it)
     {
-        MPI_Send((void *)&mh, sizeof(MessageHeader), MPI_BYTE, i, 0, MPI_COMM_WORLD);
+        std::map<unsigned int, size_t>::iterator rawSize = sentRawSizes_.find(it->sequence);
+        if(rawSize == sentRawSizes_.end())
+            continue;
+
+        transcoder_.recordBroadcast(rawSize->second, it->size, it->duration);
+        sentRawSizes_.erase(rawSize);
     }
+}
+
+void PixelStreamDispatcher::updateRouterScreens()
+{
+    // the screen areas change when the mullion compensation is toggled
+    const MasterConfiguration* configuration = static_cast<MasterConfiguration*>(g_configuration);
 
-    // broadcast the message
-    MPI_Bcast((void *)serializedString.data(), size, MPI_BYTE, 0, MPI_COMM_WORLD);
+    for(int processIndex=1; processIndex<=configuration->getWallProcessCount(); ++processIndex)
+    {
+        const std::vector<QPoint>& screenIndices = configuration->getGlobalScreenIndices(processIndex);
+
+        ScreenRects screens;
+        for(std::vector<QPoint>::const_iterator it = screenIndices.begin(); it != screenIndices.end(); ++it)
+            screens.push_back(configuration->getNormalizedScreenRect(*it));
+
+        router_.setProcessScreens(processIndex, screens);
+    }
 }
 
+void PixelStreamDispatcher::sendPixelStreamSegments(const std::vector<PixelStreamSegment> & segments, const PixelStreamId streamId, const size_t rawSize)
+{
+    assert(!segments.empty() && "sendPixelStreamSegments() received an empty vector");
+
+    ContentWindowManagerPtr contentWindow = g_displayGroupManager->getContentWindowManager(g_pixelStreamRegistry.getUri(streamId),
+                                                                                           CONTENT_TYPE_PIXEL_STREAM);
 
+    // ranks which render the same segments share the same message, written in a reused buffer
+    std::map<SegmentSelection, WireBufferPtr> messages;
+    std::vector<WireBufferPtr> payloads;
+    size_t sentSize = 0;
+
+    for(int i=1; i<g_mpiSize; i++)
+    {
+        // without a window the visible segments are unknown, so send all of them
+        SegmentSelection selection(segments.size(), true);
+        if(contentWindow)
+            selection = router_.selectSegments(segments, contentWindow->getCoordinates(), i);
+
+        WireBufferPtr& message = messages[selection];
+        if(!message)
+        {
+            message = sendBuffers_.getBuffer(0);
+            writePixelStreamFrame(*message, streamId, PixelStreamRouter::filterSegments(segments, selection));
+        }
+
+        // all ranks receive a message, even without any segment data, to keep their frames in sync
+        payloads.push_back(message);
+        sentSize += message->size();
+    }
+
+    if(payloads.empty())
+        return;
+
+    const unsigned int sequence = g_mpiChannel->scatter(MESSAGE_TYPE_PIXELSTREAM, payloads);
+    ++sentFrameCount_;
+
+    // the raw size is scaled by the share of the frame actually sent, to estimate the available bandwidth
+    const size_t frameSize = PixelStreamTranscoder::getImageDataSize(segments);
+    sentRawSizes_[sequence] = frameSize > 0 ? (size_t)((double)rawSize * sentSize / frameSize) : 0;
+}
@@ -42,21 +42,37 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QFutureWatcher>
 #include <map>
+#include <vector>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "PixelStreamSegment.h"
 #include "PixelStreamBuffer.h"
+#include "PixelStreamTranscoder.h"
+#include "PixelStreamScheduler.h"
+#include "PixelStreamRegistry.h"
+#include "PixelStreamRouter.h"
+#include "WireFormat.h"
 
-//#define USE_TIMER
+#include <QHash>
 
 using dc::PixelStreamSegment;
 
-typedef std::map<QString, PixelStreamBuffer> StreamBuffers;
+typedef QHash<PixelStreamId, PixelStreamBuffer> StreamBuffers;
+typedef QHash<PixelStreamId, PixelStreamSegments> PendingFrames;
 
 /**
  * Gather PixelStream Segments from multiple sources and dispatch them to Wall processes through MPI
+ *
+ * Each Wall process only receives the image data of the segments which it renders.
+ * Frames are dispatched as soon as the Wall processes notify that they have consumed the previous ones,
+ * so that frames are neither sent faster than the Wall can display them nor kept waiting.
+ * Raw frames can be compressed before being sent, according to the TranscodingPolicy of each stream.
+ * The compression runs in the background, and the frames are sent once it has finished.
+ * When the streams exceed the dispatch budget, the most visible ones are sent first and the others
+ * are sent at a lower frame rate.
  */
 class PixelStreamDispatcher : public QObject
 {
@@ -66,46 +82,66 @@ public:
     /** Construct a dispatcher */
     PixelStreamDispatcher();
 
+    /** Wait for the frames being transcoded */
+    ~PixelStreamDispatcher();
+
+    /**
+     * Get the transcoding policy of a stream
+     *
+     * @param streamId Identifier for the Stream
+     * @return The policy set for this stream, or the configured one if none was set
+     */
+    TranscodingPolicy getTranscodingPolicy(const PixelStreamId streamId) const;
+
 public slots:
     /**
      * Add a source of Segments for a Stream
      *
-     * @param uri Identifier for the Stream
+     * @param streamId Identifier for the Stream, registered in g_pixelStreamRegistry
      * @param sourceIndex Identifier for the source in this stream
      */
-    void addSource(const QString uri, const size_t sourceIndex);
+    void addSource(const PixelStreamId streamId, const size_t sourceIndex);
 
     /**
-     * Add a source of Segments for a Stream
+     * Remove a source of Segments for a Stream
      *
-     * @param uri Identifier for the Stream
+     * @param streamId Identifier for the Stream
      * @param sourceIndex Identifier for the source in this stream
      */
-    void removeSource(const QString uri, const size_t sourceIndex);
+    void removeSource(const PixelStreamId streamId, const size_t sourceIndex);
 
     /**
      * Process a new Segement
      *
-     * @param uri Identifier for the Stream
+     * @param streamId Identifier for the Stream
      * @param sourceIndex Identifier for the source in this stream
      */
-    void processSegment(const QString uri, const size_t sourceIndex, PixelStreamSegment segment);
+    void processSegment(const PixelStreamId streamId, const size_t sourceIndex, PixelStreamSegment segment);
 
     /**
      * The given source has finished sending segments for the current frame
      *
-     * @param uri Identifier for the Stream
+     * @param streamId Identifier for the Stream
      * @param sourceIndex Identifier for the source in this stream
      */
-    void processFrameFinished(const QString uri, const size_t sourceIndex);
+    void processFrameFinished(const PixelStreamId streamId, const size_t sourceIndex);
 
     /**
      * Delete an entire stream
      *
-     * @param uri Identifier for the Stream
+     * @param uri Uri of the Stream
      */
     void deleteStream(const QString uri);
 
+    /**
+     * Set the transcoding policy of a stream
+     *
+     * @param uri Uri of the Stream, which must be open; the policy is ignored otherwise
+     * @param policy The policy for compressing the raw frames of this stream
+     * @see TranscodingCommandHandler
+     */
+    void setTranscodingPolicy(const QString uri, const TranscodingPolicy policy);
+
 signals:
     /**
      * Notify that a PixelStream has been opened
@@ -123,25 +159,65 @@ signals:
      */
     void deletePixelStream(QString uri);
 
-#ifndef USE_TIMER
     /** @internal */
     void dispatchFramesSignal();
-#endif
 
 private slots:
     void dispatchFrames();
+    void dispatchFramesIfWallReady();
+    void finishTranscoding();
 
 private:
-    // The buffers for each URI
+    // The buffers for each stream
     StreamBuffers streamBuffers_;
 
-    void sendPixelStreamSegments(const std::vector<PixelStreamSegment> &segments, const QString& uri);
+    // The transcoding policy for each stream
+    QHash<PixelStreamId, TranscodingPolicy> transcodingPolicies_;
+    PixelStreamTranscoder transcoder_;
+
+    // A scheduled frame, sent once it has been transcoded if needed
+    struct ScheduledFrame
+    {
+        PixelStreamId streamId;
+        PixelStreamSegments segments;
+        size_t rawSize;
+        bool transcode;
+    };
+
+    // The last complete frame of each stream, waiting to be scheduled
+    PendingFrames pendingFrames_;
+    // The frames scheduled by the last dispatch
+    std::vector<ScheduledFrame> scheduledFrames_;
+    // The segments of the scheduled frames being transcoded, in the order of the frames
+    PixelStreamSegments transcodingSegments_;
+    QFutureWatcher<void> transcodingWatcher_;
+    PixelStreamScheduler scheduler_;
+    PixelStreamRouter router_;
+
+    // The messages of the frames being sent, reused once they have left
+    WireBufferPool sendBuffers_;
+    // The raw size of the frames being sent, by message sequence number
+    std::map<unsigned int, size_t> sentRawSizes_;
+
+    // The Wall can accept new frames
+    bool wallReady_;
+    // A dispatch has been scheduled but not yet processed
+    bool dispatchPending_;
+    // Poll the Wall readiness while frames are waiting
+    QTimer wallReadyTimer_;
 
-#ifdef USE_TIMER
-    QTimer sendTimer_;
-#else
     boost::posix_time::ptime lastFrameSent_;
-#endif
+    // The number of frames sent, which the Wall reports once it has consumed them
+    unsigned int sentFrameCount_;
+
+    void deleteStream(const PixelStreamId streamId);
+
+    void sendPixelStreamOpen(const PixelStreamId streamId);
+    void sendPixelStreamClose(const PixelStreamId streamId);
+    void updateRouterScreens();
+    void recordSentFrames();
+    void sendScheduledFrames();
+    void sendPixelStreamSegments(const std::vector<PixelStreamSegment> &segments, const PixelStreamId streamId, const size_t rawSize);
 };
 
 #endif // PIXELSTREAMDISPATCHER_H
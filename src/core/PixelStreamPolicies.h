@@ -0,0 +1,71 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef PIXELSTREAMPOLICIES_H
+#define PIXELSTREAMPOLICIES_H
+
+#include <QString>
+
+/**
+ * What to do when the buffer limits are exceeded because a source is late.
+ */
+enum StragglerPolicy
+{
+    /** Complete the frame using the last segments received from the late sources */
+    STRAGGLER_PARTIAL_FRAME,
+    /** Drop the oldest buffered frames of the sources which are ahead */
+    STRAGGLER_DROP_FRAME
+};
+
+/** Transcoding policy for the raw segments of a stream */
+enum TranscodingPolicy
+{
+    TRANSCODING_AUTO,   /**< Compress only when the interconnect is saturated */
+    TRANSCODING_ON,     /**< Always compress */
+    TRANSCODING_OFF     /**< Never compress */
+};
+
+/**
+ * Get the TranscodingPolicy from its string representation: "auto", "on" or "off".
+ * @param policyString The string to parse
+ * @param policy Set to the parsed policy, left unchanged if the string is invalid
+ * @return true if the string is a valid policy, false otherwise
+ */
+bool parseTranscodingPolicy(const QString& policyString, TranscodingPolicy& policy);
+
+#endif // PIXELSTREAMPOLICIES_H
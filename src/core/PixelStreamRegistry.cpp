@@ -0,0 +1,98 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "PixelStreamRegistry.h"
+
+PixelStreamRegistry::PixelStreamRegistry()
+    : lastId_(INVALID_PIXELSTREAM_ID)
+{
+}
+
+PixelStreamId PixelStreamRegistry::registerStream(const QString& uri)
+{
+    QMutexLocker locker(&mutex_);
+
+    QHash<QString, PixelStreamId>::const_iterator it = ids_.find(uri);
+    if (it != ids_.end())
+        return it.value();
+
+    const PixelStreamId id = ++lastId_;
+    ids_[uri] = id;
+    uris_[id] = uri;
+
+    return id;
+}
+
+void PixelStreamRegistry::registerStream(const QString& uri, const PixelStreamId id)
+{
+    QMutexLocker locker(&mutex_);
+
+    if (ids_.contains(uri))
+        uris_.remove(ids_[uri]);
+    if (uris_.contains(id))
+        ids_.remove(uris_[id]);
+
+    ids_[uri] = id;
+    uris_[id] = uri;
+}
+
+void PixelStreamRegistry::unregisterStream(const PixelStreamId id)
+{
+    QMutexLocker locker(&mutex_);
+
+    QHash<PixelStreamId, QString>::iterator it = uris_.find(id);
+    if (it == uris_.end())
+        return;
+
+    ids_.remove(it.value());
+    uris_.erase(it);
+}
+
+PixelStreamId PixelStreamRegistry::getId(const QString& uri) const
+{
+    QMutexLocker locker(&mutex_);
+
+    return ids_.value(uri, INVALID_PIXELSTREAM_ID);
+}
+
+QString PixelStreamRegistry::getUri(const PixelStreamId id) const
+{
+    QMutexLocker locker(&mutex_);
+
+    return uris_.value(id);
+}
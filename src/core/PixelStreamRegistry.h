@@ -0,0 +1,99 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef PIXELSTREAMREGISTRY_H
+#define PIXELSTREAMREGISTRY_H
+
+#include <stdint.h>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+/** Compact identifier for a PixelStream, used instead of its uri in the frame processing. */
+typedef uint32_t PixelStreamId;
+
+#define INVALID_PIXELSTREAM_ID 0
+
+/**
+ * Map PixelStream uris to compact numeric identifiers.
+ *
+ * The master process assigns a new identifier when a stream is opened and forwards it to the
+ * Wall processes, which register the same mapping. Identifiers are never reused, so that late
+ * messages for a closed stream can not be mistaken for a newer stream with the same uri.
+ * All methods are thread-safe.
+ */
+class PixelStreamRegistry
+{
+public:
+    /** Construct an empty registry */
+    PixelStreamRegistry();
+
+    /**
+     * Get the identifier of a stream, assigning a new one if the uri is not registered yet.
+     * @param uri The uri of the stream
+     * @return The identifier of the stream
+     */
+    PixelStreamId registerStream(const QString& uri);
+
+    /**
+     * Register a stream with an identifier assigned by another process.
+     * A previous identifier for the same uri is replaced.
+     * @param uri The uri of the stream
+     * @param id The identifier of the stream
+     */
+    void registerStream(const QString& uri, const PixelStreamId id);
+
+    /** Forget a stream. */
+    void unregisterStream(const PixelStreamId id);
+
+    /** Get the identifier of a stream, or INVALID_PIXELSTREAM_ID if it is not registered. */
+    PixelStreamId getId(const QString& uri) const;
+
+    /** Get the uri of a stream, or an empty string if it is not registered. */
+    QString getUri(const PixelStreamId id) const;
+
+private:
+    mutable QMutex mutex_;
+
+    QHash<QString, PixelStreamId> ids_;
+    QHash<PixelStreamId, QString> uris_;
+
+    PixelStreamId lastId_;
+};
+
+#endif // PIXELSTREAMREGISTRY_H
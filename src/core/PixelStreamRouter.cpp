@@ -0,0 +1,126 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "PixelStreamRouter.h"
+
+#include <algorithm>
+#include <cassert>
+
+PixelStreamRouter::PixelStreamRouter(const double halo)
+    : halo_(halo)
+{
+}
+
+void PixelStreamRouter::setProcessScreens(const int processIndex, const ScreenRects& screens)
+{
+    assert(processIndex > 0 && "PixelStreamRouter::setProcessScreens is only valid for processes of rank > 0");
+
+    if ((int)processesScreens_.size() < processIndex)
+        processesScreens_.resize(processIndex);
+
+    processesScreens_[processIndex-1] = screens;
+}
+
+int PixelStreamRouter::getProcessCount() const
+{
+    return processesScreens_.size();
+}
+
+SegmentSelection PixelStreamRouter::selectSegments(const PixelStreamSegments& segments, const QRectF& window,
+                                                   const int processIndex) const
+{
+    SegmentSelection selection(segments.size(), false);
+
+    if (processIndex < 1 || processIndex > (int)processesScreens_.size())
+        return selection;
+
+    const ScreenRects& screens = processesScreens_[processIndex-1];
+
+    // dimensions of the entire frame
+    unsigned int width = 0;
+    unsigned int height = 0;
+    for (PixelStreamSegments::const_iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+        width = std::max(width, it->parameters.x + it->parameters.width);
+        height = std::max(height, it->parameters.y + it->parameters.height);
+    }
+
+    if (width == 0 || height == 0)
+        return selection;
+
+    const double haloX = halo_ * window.width();
+    const double haloY = halo_ * window.height();
+
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        const dc::PixelStreamSegmentParameters& params = segments[i].parameters;
+
+        // coordinates of segment in global tiled display space, including the halo
+        const QRectF segmentRect(window.x() + (double)params.x / (double)width * window.width() - haloX,
+                                 window.y() + (double)params.y / (double)height * window.height() - haloY,
+                                 (double)params.width / (double)width * window.width() + 2.0 * haloX,
+                                 (double)params.height / (double)height * window.height() + 2.0 * haloY);
+
+        for (ScreenRects::const_iterator screen = screens.begin(); screen != screens.end(); ++screen)
+        {
+            if (screen->intersects(segmentRect))
+            {
+                selection[i] = true;
+                break;
+            }
+        }
+    }
+
+    return selection;
+}
+
+PixelStreamSegments PixelStreamRouter::filterSegments(const PixelStreamSegments& segments,
+                                                      const SegmentSelection& selection)
+{
+    assert(segments.size() == selection.size());
+
+    PixelStreamSegments filteredSegments(segments);
+
+    for (size_t i = 0; i < filteredSegments.size(); ++i)
+    {
+        if (!selection[i])
+            filteredSegments[i].imageData.clear();
+    }
+
+    return filteredSegments;
+}
@@ -0,0 +1,106 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef PIXELSTREAMROUTER_H
+#define PIXELSTREAMROUTER_H
+
+#include "PixelStreamSegment.h"
+
+#include <QRectF>
+#include <vector>
+
+using dc::PixelStreamSegment;
+
+typedef std::vector<PixelStreamSegment> PixelStreamSegments;
+typedef std::vector<QRectF> ScreenRects;
+typedef std::vector<bool> SegmentSelection;
+
+// Default margin around the screens of a process, as a fraction of the window size
+#define PIXELSTREAMROUTER_DEFAULT_HALO 0.1
+
+/**
+ * Select the PixelStream segments which each Wall process needs to render.
+ *
+ * A segment is routed to a process if its area on the wall, enlarged by a halo margin, intersects
+ * one of the screens of that process. The halo lets a process render the segments of a window which
+ * has moved slightly since the frame was dispatched, until the next frame arrives.
+ */
+class PixelStreamRouter
+{
+public:
+    /**
+     * Construct a router
+     * @param halo The margin around each segment, as a fraction of the window size
+     */
+    PixelStreamRouter(const double halo = PIXELSTREAMROUTER_DEFAULT_HALO);
+
+    /**
+     * Set the screens of a process.
+     * @param processIndex MPI index in the range [1;n] of the process
+     * @param screens The area of each screen in normalized wall coordinates
+     */
+    void setProcessScreens(const int processIndex, const ScreenRects& screens);
+
+    /** Get the number of processes which have screens. */
+    int getProcessCount() const;
+
+    /**
+     * Select the segments which a process needs to render.
+     * @param segments The segments of a frame
+     * @param window The coordinates of the window showing the stream, in normalized wall coordinates
+     * @param processIndex MPI index in the range [1;n] of the process
+     * @return For each segment, true if the process needs it
+     */
+    SegmentSelection selectSegments(const PixelStreamSegments& segments, const QRectF& window,
+                                    const int processIndex) const;
+
+    /**
+     * Get a copy of a frame with the image data of the unselected segments removed.
+     *
+     * The parameters of all the segments are kept, so that the frame dimensions are preserved.
+     */
+    static PixelStreamSegments filterSegments(const PixelStreamSegments& segments,
+                                              const SegmentSelection& selection);
+
+private:
+    double halo_;
+
+    std::vector<ScreenRects> processesScreens_;
+};
+
+#endif // PIXELSTREAMROUTER_H
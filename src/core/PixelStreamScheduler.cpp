@@ -0,0 +1,173 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "PixelStreamScheduler.h"
+
+#include "ContentWindowManager.h"
+#include "Content.h"
+#include "globals.h"
+
+#include <algorithm>
+#include <vector>
+
+// Priority of streams without visible area, so that they still get updated from time to time
+#define MIN_PRIORITY 0.01f
+
+#define IN_FRONT_PRIORITY_FACTOR 2.f
+#define SELECTED_PRIORITY_FACTOR 4.f
+
+namespace
+{
+
+float getArea(const QRectF& rect)
+{
+    return rect.isValid() ? rect.width() * rect.height() : 0.f;
+}
+
+typedef std::pair<float, PixelStreamId> PriorityEntry;
+
+bool hasHigherPriority(const PriorityEntry& a, const PriorityEntry& b)
+{
+    // Compare the ids for equal priorities to keep a deterministic order
+    if (a.first != b.first)
+        return a.first > b.first;
+    return a.second < b.second;
+}
+
+}
+
+PixelStreamScheduler::PixelStreamScheduler(const size_t budget)
+    : budget_(budget)
+{
+}
+
+void PixelStreamScheduler::setBudget(const size_t budget)
+{
+    budget_ = budget;
+}
+
+void PixelStreamScheduler::updatePriorities(const ContentWindowManagerPtrs& contentWindows)
+{
+    priorities_.clear();
+
+    const QRectF wall(0.0, 0.0, 1.0, 1.0);
+
+    // The last window is rendered on top of the others
+    for(size_t i = 0; i < contentWindows.size(); ++i)
+    {
+        ContentPtr content = contentWindows[i]->getContent();
+        if(content->getType() != CONTENT_TYPE_PIXEL_STREAM)
+            continue;
+
+        const PixelStreamId streamId = g_pixelStreamRegistry.getId(content->getURI());
+        if(streamId == INVALID_PIXELSTREAM_ID)
+            continue;
+
+        const QRectF window = contentWindows[i]->getCoordinates().intersected(wall);
+
+        // Approximate the visible area, overlaps between occluding windows are subtracted twice
+        float visibleArea = getArea(window);
+        for(size_t j = i+1; j < contentWindows.size(); ++j)
+            visibleArea -= getArea(window.intersected(contentWindows[j]->getCoordinates()));
+
+        const bool inFront = (i == contentWindows.size()-1);
+        const float priority = computePriority(std::max(visibleArea, 0.f), inFront,
+                                               contentWindows[i]->selected());
+
+        if(!priorities_.count(streamId) || priorities_[streamId] < priority)
+            priorities_[streamId] = priority;
+    }
+}
+
+void PixelStreamScheduler::setPriority(const PixelStreamId streamId, const float priority)
+{
+    priorities_[streamId] = priority;
+}
+
+float PixelStreamScheduler::getPriority(const PixelStreamId streamId) const
+{
+    std::map<PixelStreamId, float>::const_iterator it = priorities_.find(streamId);
+    return it != priorities_.end() ? it->second : MIN_PRIORITY;
+}
+
+std::set<PixelStreamId> PixelStreamScheduler::schedule(const std::map<PixelStreamId, size_t>& costs)
+{
+    std::set<PixelStreamId> selected;
+
+    // Forget the streams which are no longer waiting
+    std::map<PixelStreamId, unsigned int> skippedFrames;
+
+    std::vector<PriorityEntry> queue;
+    for(std::map<PixelStreamId, size_t>::const_iterator it = costs.begin(); it != costs.end(); ++it)
+    {
+        const unsigned int skipped = skippedFrames_.count(it->first) ? skippedFrames_[it->first] : 0;
+        skippedFrames[it->first] = skipped;
+        queue.push_back(PriorityEntry(getPriority(it->first) * (1 + skipped), it->first));
+    }
+    std::sort(queue.begin(), queue.end(), hasHigherPriority);
+
+    size_t totalCost = 0;
+    for(std::vector<PriorityEntry>::const_iterator it = queue.begin(); it != queue.end(); ++it)
+    {
+        const size_t cost = costs.find(it->second)->second;
+
+        if(budget_ == 0 || selected.empty() || totalCost + cost <= budget_)
+        {
+            selected.insert(it->second);
+            totalCost += cost;
+            skippedFrames[it->second] = 0;
+        }
+        else
+        {
+            ++skippedFrames[it->second];
+        }
+    }
+
+    skippedFrames_.swap(skippedFrames);
+    return selected;
+}
+
+float PixelStreamScheduler::computePriority(const float visibleArea, const bool inFront, const bool selected)
+{
+    float priority = std::max(visibleArea, MIN_PRIORITY);
+    if(inFront)
+        priority *= IN_FRONT_PRIORITY_FACTOR;
+    if(selected)
+        priority *= SELECTED_PRIORITY_FACTOR;
+    return priority;
+}
@@ -0,0 +1,110 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef PIXELSTREAMSCHEDULER_H
+#define PIXELSTREAMSCHEDULER_H
+
+#include "types.h"
+#include "PixelStreamRegistry.h"
+
+#include <map>
+#include <set>
+
+/**
+ * Select which PixelStreams get a new frame when they compete for a limited budget.
+ *
+ * Streams are prioritized according to the visible area of their window on the wall, whether
+ * their window is in front and whether the user is interacting with it. The streams with the
+ * highest priority are updated first until the budget for the frame is exhausted; the others wait,
+ * with a priority increasing for each frame they have skipped so that none of them starves.
+ *
+ * The decisions only depend on the display group and on the schedule() calls, so all the Wall
+ * processes take the same decisions as long as they share the same state.
+ */
+class PixelStreamScheduler
+{
+public:
+    /**
+     * Construct a scheduler
+     * @param budget The maximum cost of the streams updated in one frame, 0 for unlimited
+     */
+    PixelStreamScheduler(const size_t budget = 0);
+
+    /** Set the maximum cost of the streams updated in one frame, 0 for unlimited. */
+    void setBudget(const size_t budget);
+
+    /** Compute the priority of the streams from the windows of the display group. */
+    void updatePriorities(const ContentWindowManagerPtrs& contentWindows);
+
+    /**
+     * Set the priority of a stream.
+     * @param streamId Identifier for the Stream
+     * @param priority Positive value, higher values are updated first
+     */
+    void setPriority(const PixelStreamId streamId, const float priority);
+
+    /** Get the priority of a stream, or the minimum priority if it has no window. */
+    float getPriority(const PixelStreamId streamId) const;
+
+    /**
+     * Select the streams to update in the current frame.
+     *
+     * The stream with the highest priority is always selected, even if its cost exceeds the budget.
+     * @param costs The cost of each stream which has a new frame (bytes, pixels...)
+     * @return The identifiers of the streams to update
+     */
+    std::set<PixelStreamId> schedule(const std::map<PixelStreamId, size_t>& costs);
+
+    /**
+     * Compute the priority of a stream.
+     * @param visibleArea The fraction of the wall covered by the window and not occluded [0;1]
+     * @param inFront Is the window the top-most one
+     * @param selected Is the user interacting with the window
+     */
+    static float computePriority(const float visibleArea, const bool inFront, const bool selected);
+
+private:
+    size_t budget_;
+
+    std::map<PixelStreamId, float> priorities_;
+
+    // Number of consecutive frames each stream has been waiting for an update
+    std::map<PixelStreamId, unsigned int> skippedFrames_;
+};
+
+#endif // PIXELSTREAMSCHEDULER_H
@@ -39,46 +39,24 @@
 
 #include "PixelStreamSegmentDecoder.h"
 
-#include "PixelStreamSegment.h"
-#include "ImageJpegDecompressor.h"
-#include "log.h"
+#include "PixelStreamDecoderPool.h"
 
-#include <QtConcurrentRun>
-
-PixelStreamSegmentDecoder::PixelStreamSegmentDecoder()
-    : decompressor_(new ImageJpegDecompressor())
+PixelStreamSegmentDecoder::PixelStreamSegmentDecoder(PixelStreamDecoderPool* pool)
+    : pool_(pool ? *pool : PixelStreamDecoderPool::getDefaultPool())
 {
 }
 
 PixelStreamSegmentDecoder::~PixelStreamSegmentDecoder()
 {
-    delete decompressor_;
-}
-
-void decodeSegment(ImageJpegDecompressor* decompressor, PixelStreamSegment* segment)
-{
-    QByteArray decodedData = decompressor->decompress(segment->imageData);
-
-    if ( !decodedData.isEmpty() )
-    {
-        segment->imageData = decodedData;
-        segment->parameters.compressed = false;
-    }
+    pool_.cancel(this);
 }
 
-void PixelStreamSegmentDecoder::startDecoding(dc::PixelStreamSegment& segment)
+void PixelStreamSegmentDecoder::startDecoding(dc::PixelStreamSegment& segment, unsigned char* buffer)
 {
-    // drop frames if we're currently processing
-    if(isRunning())
-    {
-        put_flog(LOG_WARN, "Decoding in process, Frame dropped. See if we need to change this...");
-        return;
-    }
-
-    decodingFuture_ = QtConcurrent::run(decodeSegment, decompressor_, &segment);
+    pool_.decode(this, segment, buffer);
 }
 
 bool PixelStreamSegmentDecoder::isRunning() const
 {
-    return decodingFuture_.isRunning();
+    return pool_.isDecoding(this);
 }
@@ -40,15 +40,13 @@
 #ifndef PIXELSTREAMSEGMENTDECODER_H
 #define PIXELSTREAMSEGMENTDECODER_H
 
-#include <QFuture>
-
 namespace dc
 {
 struct PixelStreamSegment;
 }
 using dc::PixelStreamSegment;
 
-class ImageJpegDecompressor;
+class PixelStreamDecoderPool;
 
 /**
  * Decode a PixelStreamSegment image data asynchronously.
@@ -56,31 +54,34 @@ class ImageJpegDecompressor;
 class PixelStreamSegmentDecoder
 {
 public:
-    /** Construct a Decoder */
-    PixelStreamSegmentDecoder();
+    /**
+     * Construct a Decoder
+     * @param pool The threads which decode the segments, the default pool of the process if 0
+     */
+    PixelStreamSegmentDecoder(PixelStreamDecoderPool* pool = 0);
 
-    /** Destruct a Decoder */
+    /** Destruct a Decoder, waiting until the segment being decoded is done */
     ~PixelStreamSegmentDecoder();
 
     /**
      * Start decoding a segment.
      *
-     * This function will silently ignore the request if a decoding is already in progress.
+     * If a segment is already being decoded, the new one is decoded next. It replaces any other
+     * segment waiting to be decoded, which then remains compressed.
      * @param segment The segement to decode. The segment is NOT copied internally and is modified by this
      * function. It must remain valid and should not be accessed until the decoding procedure has completed.
+     * @param buffer Optional memory of width * height * 4 bytes to decode the image to. Its image data is
+     * then cleared from the segment instead of being replaced by the decoded image.
      * @see isRunning()
      */
-    void startDecoding(PixelStreamSegment& segment);
+    void startDecoding(PixelStreamSegment& segment, unsigned char* buffer = 0);
 
-    /** Check if the decoding thread is running. */
+    /** Check if a segment is being decoded or waiting to be decoded. */
     bool isRunning() const;
 
 private:
-    /** The decompressor instance */
-    ImageJpegDecompressor* decompressor_;
-
-    /** Async image decoding future */
-    QFuture<void> decodingFuture_;
+    /** The threads decoding the segments */
+    PixelStreamDecoderPool& pool_;
 };
 
 #endif // PIXELSTREAMSEGMENTDECODER_H
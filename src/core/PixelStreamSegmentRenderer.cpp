@@ -40,6 +40,7 @@
 
 #include "log.h"
 #include "FpsCounter.h"
+#include "PixelBufferPool.h"
 
 #include "globals.h"
 #include "MainWindow.h"
@@ -80,33 +81,57 @@ void PixelStreamSegmentRenderer::updateTexture(const QImage& image)
 {
     segmentStatistics->tick();
 
+    if(!allocateTexture(image.width(), image.height(), image.bits()))
+    {
+        glBindTexture(GL_TEXTURE_2D, textureId_);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width(), image.height(), GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
+    }
+
+    textureNeedsUpdate_ = false;
+}
+
+void PixelStreamSegmentRenderer::updateTexture(PixelBufferPool& buffers, const int width, const int height)
+{
+    segmentStatistics->tick();
+
+    allocateTexture(width, height, 0);
+    buffers.upload(textureId_, width, height);
+
+    textureNeedsUpdate_ = false;
+}
+
+bool PixelStreamSegmentRenderer::allocateTexture(const int width, const int height, const void* pixels)
+{
     // if the size has changed, create a new texture
-    if(textureId_ && (image.width() != textureWidth_ || image.height() != textureHeight_))
+    if(textureId_ && (width != textureWidth_ || height != textureHeight_))
     {
         // delete bound texture
         glDeleteTextures(1, &textureId_);
         textureId_ = 0;
     }
 
+    if(textureId_)
+        return false;
+
+    glGenTextures(1, &textureId_);
+    glBindTexture(GL_TEXTURE_2D, textureId_);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    textureWidth_ = width;
+    textureHeight_ = height;
+
+    return true;
+}
+
+size_t PixelStreamSegmentRenderer::getTextureMemoryUsage() const
+{
     if(!textureId_)
-    {
-        glGenTextures(1, &textureId_);
-        glBindTexture(GL_TEXTURE_2D, textureId_);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width(), image.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
-        textureWidth_ = image.width();
-        textureHeight_ = image.height();
-    }
-    else
-    {
-        glBindTexture(GL_TEXTURE_2D, textureId_);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width(), image.height(), GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
-    }
+        return 0;
 
-    textureNeedsUpdate_ = false;
+    return (size_t)textureWidth_ * textureHeight_ * 4;
 }
 
 bool PixelStreamSegmentRenderer::textureNeedsUpdate() const
@@ -128,77 +153,52 @@ void PixelStreamSegmentRenderer::setParameters(const unsigned int x, const unsig
     height_ = height;
 }
 
-bool PixelStreamSegmentRenderer::render(bool showSegmentBorders, bool showSegmentStatistics)
+bool PixelStreamSegmentRenderer::render()
 {
     if(!textureId_)
     {
         return false;
     }
 
-    // OpenGL transformation
-    glPushMatrix();
-    glTranslatef(x_, y_, 0.);
-
-    // The following draw calls assume normalized coordinates, so we must pre-multiply by this segment's dimensions
-    glScalef(width_, height_, 0.);
-
     // todo: compute actual texture bounds to render considering zoom, pan
-    drawUnitTexturedQuad(0, 0, 1.f, 1.f);
-
-    if(showSegmentBorders || showSegmentStatistics)
-    {
-        glPushAttrib(GL_CURRENT_BIT | GL_LINE_BIT | GL_DEPTH_BUFFER_BIT);
-        glLineWidth(2);
-
-        glPushMatrix();
-        glTranslatef(0.,0.,0.05);
-
-        // render segment borders
-        if(showSegmentBorders)
-        {
-            drawSegmentBorders();
-        }
-
-        // render segment statistics
-        if(showSegmentStatistics)
-        {
-            drawSegmentStatistics();
-        }
-
-        glPopMatrix();
-        glPopAttrib();
-    }
-
-    glPopMatrix();
+    g_mainWindow->getActiveGLWindow()->getQuadBatch().addQuad(textureId_, getRect(), QRectF(0., 0., 1., 1.));
 
     return true;
 }
 
-void PixelStreamSegmentRenderer::drawUnitTexturedQuad(float tX, float tY, float tW, float tH)
+void PixelStreamSegmentRenderer::renderOverlay(bool showSegmentBorders, bool showSegmentStatistics)
 {
-    // draw the texture
-    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
-
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, textureId_);
+    if(!textureId_)
+    {
+        return;
+    }
 
-    glBegin(GL_QUADS);
+    // OpenGL transformation
+    glPushMatrix();
+    glTranslatef(x_, y_, 0.);
 
-    glTexCoord2f(tX,tY);
-    glVertex2f(0.,0.);
+    // The following draw calls assume normalized coordinates, so we must pre-multiply by this segment's dimensions
+    glScalef(width_, height_, 0.);
 
-    glTexCoord2f(tX+tW,tY);
-    glVertex2f(1.,0.);
+    glPushAttrib(GL_CURRENT_BIT | GL_LINE_BIT | GL_DEPTH_BUFFER_BIT);
+    glLineWidth(2);
 
-    glTexCoord2f(tX+tW,tY+tH);
-    glVertex2f(1.,1.);
+    glTranslatef(0.,0.,0.05);
 
-    glTexCoord2f(tX,tY+tH);
-    glVertex2f(0.,1.);
+    // render segment borders
+    if(showSegmentBorders)
+    {
+        drawSegmentBorders();
+    }
 
-    glEnd();
+    // render segment statistics
+    if(showSegmentStatistics)
+    {
+        drawSegmentStatistics();
+    }
 
     glPopAttrib();
+    glPopMatrix();
 }
 
 void PixelStreamSegmentRenderer::drawSegmentBorders()
@@ -42,6 +42,7 @@
 #include <QGLWidget>
 
 class FpsCounter;
+class PixelBufferPool;
 
 /**
  * Render a single PixelStream Segment
@@ -70,6 +71,19 @@ public:
      */
     void updateTexture(const QImage &image);
 
+    /**
+     * Update the texture from the mapped buffer of a pixel buffer pool.
+     *
+     * This call is asynchronous, the GL transfers the pixels while rendering continues.
+     * @param buffers The pool which holds the new texture, in (GL_)RGBA format.
+     * @param width The width of the new texture.
+     * @param height The height of the new texture.
+     */
+    void updateTexture(PixelBufferPool& buffers, const int width, const int height);
+
+    /** Get the size of the texture in bytes. */
+    size_t getTextureMemoryUsage() const;
+
     /** Has the texture been marked as oudated with setTextureOutdated() */
     bool textureNeedsUpdate() const;
 
@@ -89,12 +103,21 @@ public:
     /**
      * Render the current texture.
      *
+     * The texture is added to the QuadBatch of the active GLWindow, which draws it on its next flush.
+     * Assume that the GL matrices have been set to the normalized dimensions of the stream.
+     * @return true on successful render; false if no texture available.
+     */
+    bool render();
+
+    /**
+     * Render the borders and statistics of this segment, over its flushed texture.
+     * Nothing is drawn if no texture is available.
+     *
      * Assume that the GL matrices have been set to the normalized dimensions of the stream.
      * @param showSegmentBorders Show the segment boders
      * @param showStatistics Show the statistics for this segment
-     * @return true on successful render; false if no texture available.
      */
-    bool render(bool showSegmentBorders, bool showSegmentStatistics);
+    void renderOverlay(bool showSegmentBorders, bool showSegmentStatistics);
 
 private:
     // pixel stream identifier
@@ -116,8 +139,10 @@ private:
     // Status
     bool textureNeedsUpdate_;
 
+    // Create the texture if needed, return false if it already existed with these dimensions
+    bool allocateTexture(const int width, const int height, const void* pixels);
+
     // Rendering
-    void drawUnitTexturedQuad(float tX, float tY, float tW, float tH);
     void drawSegmentBorders();
     void drawSegmentStatistics();
 };
@@ -0,0 +1,171 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "PixelStreamTranscoder.h"
+
+#include "dcstream/ImageWrapper.h"
+#include "dcstream/ImageJpegCompressor.h"
+#include "log.h"
+
+#include <QtConcurrentMap>
+#include <QThreadStorage>
+
+// Period over which the bandwidth and data rate are estimated
+#define MEASUREMENT_WINDOW_MS 1000
+
+// Minimum amount of data broadcast in a window for a meaningful bandwidth measurement
+#define MIN_BANDWIDTH_SAMPLE_SIZE (1024*1024)
+
+// Compress when the raw data rate exceeds this fraction of the interconnect bandwidth
+#define MAX_BANDWIDTH_USAGE 0.5
+
+// One compressor per worker thread, turbojpeg handles are not thread-safe
+static QThreadStorage<dc::ImageJpegCompressor*> compressors;
+
+struct CompressSegment
+{
+    typedef void result_type;
+
+    CompressSegment(const unsigned int quality) : quality_(quality) {}
+
+    void operator()(PixelStreamSegment& segment) const
+    {
+        if (segment.parameters.compressed)
+            return;
+
+        const unsigned int width = segment.parameters.width;
+        const unsigned int height = segment.parameters.height;
+
+        if ((size_t)segment.imageData.size() != (size_t)width * height * 4)
+        {
+            put_flog(LOG_WARN, "raw segment has unexpected size, sent uncompressed");
+            return;
+        }
+
+        if (!compressors.hasLocalData())
+            compressors.setLocalData(new dc::ImageJpegCompressor());
+
+        // Raw segments are RGBA, which is also the format produced by the Wall decoders
+        dc::ImageWrapper image(segment.imageData.constData(), width, height, dc::RGBA);
+        image.compressionQuality = quality_;
+
+        QByteArray jpegData = compressors.localData()->computeJpeg(image, QRect(0, 0, width, height));
+
+        if (!jpegData.isEmpty())
+        {
+            segment.imageData = jpegData;
+            segment.parameters.compressed = true;
+        }
+    }
+
+    unsigned int quality_;
+};
+
+PixelStreamTranscoder::PixelStreamTranscoder(const unsigned int quality)
+    : quality_(quality)
+    , bandwidth_(0.0)
+    , rawDataRate_(0.0)
+    , windowStart_(boost::posix_time::microsec_clock::universal_time())
+    , windowRawSize_(0)
+    , windowSentSize_(0)
+{
+}
+
+bool PixelStreamTranscoder::isTranscodingNeeded(const TranscodingPolicy policy) const
+{
+    switch(policy)
+    {
+    case TRANSCODING_ON:
+        return true;
+    case TRANSCODING_OFF:
+        return false;
+    case TRANSCODING_AUTO:
+    default:
+        return isInterconnectSaturated();
+    }
+}
+
+QFuture<void> PixelStreamTranscoder::startTranscoding(PixelStreamSegments& segments) const
+{
+    return QtConcurrent::map(segments, CompressSegment(quality_));
+}
+
+void PixelStreamTranscoder::recordBroadcast(const size_t rawSize, const size_t sentSize,
+                                            const boost::posix_time::time_duration& duration)
+{
+    windowRawSize_ += rawSize;
+    windowSentSize_ += sentSize;
+    windowBroadcastTime_ += duration;
+
+    const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    const boost::posix_time::time_duration elapsed = now - windowStart_;
+
+    if (elapsed.total_milliseconds() < MEASUREMENT_WINDOW_MS)
+        return;
+
+    const bool wasSaturated = isInterconnectSaturated();
+
+    rawDataRate_ = (double)windowRawSize_ * 1000000.0 / (double)elapsed.total_microseconds();
+
+    // Small messages are dominated by latency and would underestimate the bandwidth
+    if (windowSentSize_ >= MIN_BANDWIDTH_SAMPLE_SIZE && windowBroadcastTime_.total_microseconds() > 0)
+        bandwidth_ = (double)windowSentSize_ * 1000000.0 / (double)windowBroadcastTime_.total_microseconds();
+
+    if (wasSaturated != isInterconnectSaturated())
+        put_flog(LOG_INFO, "interconnect %s: raw data rate %.1f MB/s, bandwidth %.1f MB/s",
+                 isInterconnectSaturated() ? "saturated, transcoding raw streams" : "has headroom",
+                 rawDataRate_ / (1024*1024), bandwidth_ / (1024*1024));
+
+    windowStart_ = now;
+    windowRawSize_ = 0;
+    windowSentSize_ = 0;
+    windowBroadcastTime_ = boost::posix_time::time_duration();
+}
+
+bool PixelStreamTranscoder::isInterconnectSaturated() const
+{
+    return bandwidth_ > 0.0 && rawDataRate_ > MAX_BANDWIDTH_USAGE * bandwidth_;
+}
+
+size_t PixelStreamTranscoder::getImageDataSize(const PixelStreamSegments& segments)
+{
+    size_t size = 0;
+    for (PixelStreamSegments::const_iterator it = segments.begin(); it != segments.end(); ++it)
+        size += it->imageData.size();
+    return size;
+}
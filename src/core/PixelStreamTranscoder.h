@@ -0,0 +1,114 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef PIXELSTREAMTRANSCODER_H
+#define PIXELSTREAMTRANSCODER_H
+
+#include "PixelStreamSegment.h"
+#include "PixelStreamPolicies.h"
+
+#include <vector>
+#include <QFuture>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using dc::PixelStreamSegment;
+
+typedef std::vector<PixelStreamSegment> PixelStreamSegments;
+
+/**
+ * Compress the raw segments of PixelStreams before they are broadcast to the Wall processes.
+ *
+ * Segments are JPEG-encoded in parallel on the global thread pool. The transcoder also
+ * monitors the broadcast throughput, so that in automatic mode raw frames are only compressed
+ * when their data rate would use a large share of the measured interconnect bandwidth.
+ */
+class PixelStreamTranscoder
+{
+public:
+    /**
+     * Construct a transcoder
+     * @param quality The JPEG compression quality (0 worst, 100 best)
+     */
+    PixelStreamTranscoder(const unsigned int quality);
+
+    /**
+     * Check if the raw segments of a stream should be compressed.
+     * @param policy The transcoding policy of the stream
+     */
+    bool isTranscodingNeeded(const TranscodingPolicy policy) const;
+
+    /**
+     * Start compressing the raw segments in-place on the global thread pool, without waiting.
+     * Segments which are already compressed are left untouched.
+     * @param segments The segments to compress. They must remain valid and should not be accessed
+     *        until the returned future has finished.
+     * @return The future of the compression
+     */
+    QFuture<void> startTranscoding(PixelStreamSegments& segments) const;
+
+    /**
+     * Update the bandwidth and data rate estimates after a broadcast.
+     * @param rawSize The size of the frame image data before transcoding
+     * @param sentSize The size of the message which was actually broadcast
+     * @param duration The time spent broadcasting the message
+     */
+    void recordBroadcast(const size_t rawSize, const size_t sentSize,
+                         const boost::posix_time::time_duration& duration);
+
+    /** Check if sending raw frames would saturate the interconnect. */
+    bool isInterconnectSaturated() const;
+
+    /** Get the size of the image data of a frame in bytes. */
+    static size_t getImageDataSize(const PixelStreamSegments& segments);
+
+private:
+    unsigned int quality_;
+
+    // Estimated interconnect bandwidth, in bytes/s (0 until measured)
+    double bandwidth_;
+    // Raw data rate of the streams, in bytes/s
+    double rawDataRate_;
+
+    // Accumulated values for the current measurement window
+    boost::posix_time::ptime windowStart_;
+    size_t windowRawSize_;
+    size_t windowSentSize_;
+    boost::posix_time::time_duration windowBroadcastTime_;
+};
+
+#endif // PIXELSTREAMTRANSCODER_H
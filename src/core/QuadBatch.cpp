@@ -0,0 +1,173 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "QuadBatch.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <cstddef>
+
+QuadBatch::QuadBatch()
+    : vertexBuffer_(QGLBuffer::VertexBuffer)
+    , vertexBufferSupported_(true)
+    , drawCallCount_(0)
+{
+    vertexBuffer_.setUsagePattern(QGLBuffer::StreamDraw);
+}
+
+void QuadBatch::addQuad(const GLuint textureId, const QRectF& rect, const QRectF& textureRect)
+{
+    // the modelview matrix is affine, the w coordinate is not needed
+    GLfloat m[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, m);
+
+    const GLfloat corners[4][4] =
+    {
+        { (GLfloat)rect.left(),  (GLfloat)rect.top(),    (GLfloat)textureRect.left(),  (GLfloat)textureRect.top() },
+        { (GLfloat)rect.right(), (GLfloat)rect.top(),    (GLfloat)textureRect.right(), (GLfloat)textureRect.top() },
+        { (GLfloat)rect.right(), (GLfloat)rect.bottom(), (GLfloat)textureRect.right(), (GLfloat)textureRect.bottom() },
+        { (GLfloat)rect.left(),  (GLfloat)rect.bottom(), (GLfloat)textureRect.left(),  (GLfloat)textureRect.bottom() }
+    };
+
+    Quad quad;
+    quad.textureId = textureId;
+
+    for(unsigned int i=0; i<4; i++)
+    {
+        const GLfloat x = corners[i][0];
+        const GLfloat y = corners[i][1];
+
+        quad.vertices[i].x = m[0] * x + m[4] * y + m[12];
+        quad.vertices[i].y = m[1] * x + m[5] * y + m[13];
+        quad.vertices[i].z = m[2] * x + m[6] * y + m[14];
+        quad.vertices[i].s = corners[i][2];
+        quad.vertices[i].t = corners[i][3];
+    }
+
+    quads_.push_back(quad);
+}
+
+void QuadBatch::flush()
+{
+    drawCallCount_ = 0;
+
+    if(quads_.empty())
+        return;
+
+    std::sort(quads_.begin(), quads_.end(), isDrawnBefore);
+
+    vertices_.clear();
+    for(size_t i=0; i<quads_.size(); i++)
+    {
+        vertices_.insert(vertices_.end(), quads_[i].vertices, quads_[i].vertices + 4);
+    }
+
+    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+    // the vertices are already transformed
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glEnable(GL_TEXTURE_2D);
+
+    // fall back to client memory if vertex buffers are not supported
+    const char* base = (const char*)&vertices_[0];
+
+    if(vertexBufferSupported_ && !vertexBuffer_.isCreated())
+    {
+        vertexBufferSupported_ = vertexBuffer_.create();
+
+        if(!vertexBufferSupported_)
+            put_flog(LOG_WARN, "vertex buffers not supported, drawing quads from client memory");
+    }
+
+    if(vertexBufferSupported_)
+    {
+        vertexBuffer_.bind();
+        // reallocating lets the GL keep drawing from the previous storage
+        vertexBuffer_.allocate(&vertices_[0], vertices_.size() * sizeof(Vertex));
+        base = 0;
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, x));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, s));
+
+    // one draw call for each run of quads with the same texture
+    size_t first = 0;
+    while(first < quads_.size())
+    {
+        size_t last = first + 1;
+        while(last < quads_.size() && quads_[last].textureId == quads_[first].textureId)
+            ++last;
+
+        glBindTexture(GL_TEXTURE_2D, quads_[first].textureId);
+        glDrawArrays(GL_QUADS, first * 4, (last - first) * 4);
+        ++drawCallCount_;
+
+        first = last;
+    }
+
+    if(vertexBufferSupported_)
+        vertexBuffer_.release();
+
+    glPopMatrix();
+    glPopClientAttrib();
+    glPopAttrib();
+
+    quads_.clear();
+}
+
+unsigned int QuadBatch::getDrawCallCount() const
+{
+    return drawCallCount_;
+}
+
+bool QuadBatch::isDrawnBefore(const Quad& a, const Quad& b)
+{
+    if(a.textureId != b.textureId)
+        return a.textureId < b.textureId;
+
+    // front to back, so that the hidden fragments are rejected early by the depth test.
+    // the orthographic projection maps larger eye space z closer to the viewer.
+    return a.vertices[0].z > b.vertices[0].z;
+}
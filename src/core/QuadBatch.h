@@ -0,0 +1,109 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef QUADBATCH_H
+#define QUADBATCH_H
+
+#include <QGLWidget>
+#include <QGLBuffer>
+#include <QRectF>
+
+#include <vector>
+
+/**
+ * Collect textured quads and draw them together from a vertex buffer.
+ *
+ * The contents add their quads instead of drawing them in immediate mode. Each quad is transformed
+ * by the modelview matrix current when it is added, so the contents can keep positioning themselves
+ * with glTranslate / glScale. On flush() the quads are sorted by texture and front to back, uploaded
+ * in a single vertex buffer and drawn with one draw call per texture.
+ *
+ * The GLWindow flushes once per frame, after all the windows of the screen have added their quads.
+ * The segments of a pixel stream keep their own textures, so a stream still takes one draw call per
+ * visible segment.
+ *
+ * The quads are opaque and rely on the depth test, so anything which must be drawn over them
+ * (blended overlays, text) should only be drawn after a flush().
+ */
+class QuadBatch
+{
+public:
+    /** Construct an empty batch, the vertex buffer is created on the first flush(). */
+    QuadBatch();
+
+    /**
+     * Add a textured quad.
+     *
+     * @param textureId The texture of the quad
+     * @param rect The position and dimensions of the quad in the current modelview coordinates
+     * @param textureRect The texture coordinates mapped to the corners of rect, the width and
+     *        height may be negative to flip the texture
+     */
+    void addQuad(const GLuint textureId, const QRectF& rect, const QRectF& textureRect);
+
+    /** Draw all the quads added since the last flush. Must be called with the GL context current. */
+    void flush();
+
+    /** Get the number of draw calls issued by the last flush, for statistics. */
+    unsigned int getDrawCallCount() const;
+
+private:
+    struct Vertex
+    {
+        GLfloat x, y, z;
+        GLfloat s, t;
+    };
+
+    struct Quad
+    {
+        GLuint textureId;
+        Vertex vertices[4];
+    };
+
+    std::vector<Quad> quads_;
+    std::vector<Vertex> vertices_;
+
+    QGLBuffer vertexBuffer_;
+    bool vertexBufferSupported_;
+
+    unsigned int drawCallCount_;
+
+    static bool isDrawnBefore(const Quad& a, const Quad& b);
+};
+
+#endif // QUADBATCH_H
@@ -0,0 +1,115 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "RenderThread.h"
+
+#include "GLWindow.h"
+
+#include <cassert>
+
+RenderThread::RenderThread(GLWindowPtr glWindow)
+    : glWindow_(glWindow)
+    , task_(TASK_NONE)
+{
+    start();
+}
+
+RenderThread::~RenderThread()
+{
+    waitForTask();
+    startTask(TASK_STOP);
+    wait();
+}
+
+void RenderThread::startRendering()
+{
+    startTask(TASK_RENDER);
+}
+
+void RenderThread::startSwapping()
+{
+    startTask(TASK_SWAP);
+}
+
+void RenderThread::waitForTask()
+{
+    QMutexLocker locker(&mutex_);
+
+    while(task_ != TASK_NONE)
+        taskFinished_.wait(&mutex_);
+}
+
+void RenderThread::startTask(const Task task)
+{
+    QMutexLocker locker(&mutex_);
+
+    assert(task_ == TASK_NONE);
+    task_ = task;
+    taskStarted_.wakeOne();
+}
+
+void RenderThread::run()
+{
+    QMutexLocker locker(&mutex_);
+
+    while(true)
+    {
+        while(task_ == TASK_NONE)
+            taskStarted_.wait(&mutex_);
+
+        if(task_ == TASK_STOP)
+            break;
+
+        const Task task = task_;
+        locker.unlock();
+
+        glWindow_->makeCurrent();
+
+        if(task == TASK_RENDER)
+            glWindow_->updateGL();
+        else
+            glWindow_->swapBuffers();
+
+        // releasing the context also flushes it, so the other windows see the objects it created
+        glWindow_->doneCurrent();
+
+        locker.relock();
+        task_ = TASK_NONE;
+        taskFinished_.wakeAll();
+    }
+}
@@ -0,0 +1,99 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+
+#include "types.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <boost/shared_ptr.hpp>
+
+/**
+ * Render and swap the frames of one GLWindow in a dedicated thread.
+ *
+ * The GLWindows of a process share their OpenGL objects, so their screens can be rendered in
+ * parallel once the frame has been prepared by the main thread. The main thread starts a task on
+ * all the threads, then waits for all of them to complete it. The context of the window is only
+ * current in the thread while it executes a task, so that the main thread can use it in between.
+ */
+class RenderThread : public QThread
+{
+public:
+    /** Construct and start a thread for the given window. */
+    RenderThread(GLWindowPtr glWindow);
+
+    /** Stop the thread. */
+    ~RenderThread();
+
+    /** Start rendering a frame of the window, without swapping its buffers. */
+    void startRendering();
+
+    /** Start swapping the buffers of the window. */
+    void startSwapping();
+
+    /** Wait until the started task is complete. */
+    void waitForTask();
+
+protected:
+    void run();
+
+private:
+    enum Task
+    {
+        TASK_NONE,
+        TASK_RENDER,
+        TASK_SWAP,
+        TASK_STOP
+    };
+
+    GLWindowPtr glWindow_;
+
+    QMutex mutex_;
+    QWaitCondition taskStarted_;
+    QWaitCondition taskFinished_;
+    Task task_;
+
+    void startTask(const Task task);
+};
+
+typedef boost::shared_ptr<RenderThread> RenderThreadPtr;
+
+#endif // RENDERTHREAD_H
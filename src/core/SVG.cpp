@@ -102,8 +102,23 @@ bool SVG::setImageData(QByteArray imageData)
     return true;
 }
 
+size_t SVG::getGPUMemoryUsage() const
+{
+    size_t bytes = 0;
+
+    for(std::map<int, SVGTextureData>::const_iterator it = textureData_.begin(); it != textureData_.end(); ++it)
+    {
+        if(it->second.fbo)
+            bytes += (size_t)it->second.fbo->size().width() * it->second.fbo->size().height() * 4;
+    }
+    return bytes;
+}
+
 void SVG::render(float tX, float tY, float tW, float tH)
 {
+    // the GLWindows may be rendered in parallel, they share the renderer and the texture map
+    QMutexLocker locker(&renderMutex_);
+
     updateRenderedFrameIndex();
 
     // get on-screen and full rectangle corresponding to the window in pixel units
@@ -219,33 +234,6 @@ void SVG::restoreGLState()
 void SVG::drawTexturedQuad(const float posX, const float posY,
                            const float width, const float height, const GLuint textureID)
 {
-    // Texture coordinates
-    const float tX = 0.f;
-    const float tY = 0.f;
-    const float tW = 1.f;
-    const float tH = 1.f;
-
-    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
-
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    glBegin(GL_QUADS);
-
     // note we need to flip the y coordinate since the textures are loaded upside down
-    glTexCoord2f(tX, 1.-tY);
-    glVertex2f(posX, posY);
-
-    glTexCoord2f(tX+tW, 1.-tY);
-    glVertex2f(posX+width, posY);
-
-    glTexCoord2f(tX+tW, 1.-(tY+tH));
-    glVertex2f(posX+width, posY+height);
-
-    glTexCoord2f(tX, 1.-(tY+tH));
-    glVertex2f(posX, posY+height);
-
-    glEnd();
-
-    glPopAttrib();
+    g_mainWindow->getActiveGLWindow()->getQuadBatch().addQuad(textureID, QRectF(posX, posY, width, height), QRectF(0., 1., 1., -1.));
 }
@@ -74,6 +74,9 @@ public:
     bool setImageData(QByteArray imageData);
     void render(float tX, float tY, float tW, float tH);
 
+    /** @copydoc FactoryObject::getGPUMemoryUsage */
+    size_t getGPUMemoryUsage() const;
+
 private:
     // image location
     QString uri_;
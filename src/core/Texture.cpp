@@ -78,6 +78,15 @@ void Texture::getDimensions(int &width, int &height)
     height = imageHeight_;
 }
 
+size_t Texture::getGPUMemoryUsage() const
+{
+    if(!textureId_)
+        return 0;
+
+    // RGBA texels plus a third for the mipmaps
+    return (size_t)imageWidth_ * imageHeight_ * 4 * 4 / 3;
+}
+
 void Texture::render(float tX, float tY, float tW, float tH)
 {
     updateRenderedFrameIndex();
@@ -86,26 +95,5 @@ void Texture::render(float tX, float tY, float tW, float tH)
         return;
 
     // draw the texture
-    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT);
-
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, textureId_);
-
-    glBegin(GL_QUADS);
-
-    glTexCoord2f(tX,tY);
-    glVertex2f(0.,0.);
-
-    glTexCoord2f(tX+tW,tY);
-    glVertex2f(1.,0.);
-
-    glTexCoord2f(tX+tW,tY+tH);
-    glVertex2f(1.,1.);
-
-    glTexCoord2f(tX,tY+tH);
-    glVertex2f(0.,1.);
-
-    glEnd();
-
-    glPopAttrib();
+    g_mainWindow->getActiveGLWindow()->getQuadBatch().addQuad(textureId_, QRectF(0., 0., 1., 1.), QRectF(tX, tY, tW, tH));
 }
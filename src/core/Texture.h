@@ -52,6 +52,9 @@ class Texture : public FactoryObject {
         void getDimensions(int &width, int &height);
         void render(float tX, float tY, float tW, float tH);
 
+        /** @copydoc FactoryObject::getGPUMemoryUsage */
+        size_t getGPUMemoryUsage() const;
+
     private:
 
         // image location
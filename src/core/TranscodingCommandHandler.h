@@ -0,0 +1,72 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef TRANSCODINGCOMMANDHANDLER_H
+#define TRANSCODINGCOMMANDHANDLER_H
+
+#include "AbstractCommandHandler.h"
+
+class PixelStreamDispatcher;
+
+/**
+ * Handle transcoding Commands, which set the TranscodingPolicy of the stream sending them.
+ */
+class TranscodingCommandHandler : public AbstractCommandHandler
+{
+public:
+    /**
+     * Constructor
+     * @param pixelStreamDispatcher The dispatcher of the streams.
+     */
+    TranscodingCommandHandler(PixelStreamDispatcher& pixelStreamDispatcher);
+
+    /** Get the type of commands handled by the implementation. */
+    virtual CommandType getType() const;
+
+    /**
+     * Handle a transcoding Command.
+     * @param command The Command to handle, whose arguments are "auto", "on" or "off".
+     * @param senderUri The identifier of the stream to which the policy applies.
+     */
+    virtual void handle(const Command& command, const QString& senderUri = QString());
+
+private:
+    PixelStreamDispatcher& pixelStreamDispatcher_;
+};
+
+#endif // TRANSCODINGCOMMANDHANDLER_H
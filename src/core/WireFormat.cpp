@@ -0,0 +1,201 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#include "WireFormat.h"
+
+#include <cstring>
+
+#define HEADER_SIZE (3 * sizeof(uint32_t))
+
+// Smallest possible segment: position, dimensions, compression flag and data size
+#define MIN_SEGMENT_SIZE (5 * sizeof(uint32_t) + sizeof(uint8_t))
+
+WireWriter::WireWriter(WireBuffer& buffer, const WireMessageType type)
+    : buffer_(buffer)
+{
+    buffer_.clear();
+
+    writeUInt32(WIREFORMAT_MAGIC);
+    writeUInt32(WIREFORMAT_VERSION);
+    writeUInt32(type);
+}
+
+void WireWriter::writeUInt8(const uint8_t value)
+{
+    buffer_.push_back((char)value);
+}
+
+void WireWriter::writeUInt32(const uint32_t value)
+{
+    for (size_t i = 0; i < sizeof(uint32_t); ++i)
+        buffer_.push_back((char)((value >> (8 * i)) & 0xff));
+}
+
+void WireWriter::writeBytes(const char* data, const size_t size)
+{
+    buffer_.insert(buffer_.end(), data, data + size);
+}
+
+WireReader::WireReader(const char* data, const size_t size, const WireMessageType type)
+    : data_(data)
+    , size_(size)
+    , position_(0)
+    , valid_(true)
+{
+    valid_ = readUInt32() == WIREFORMAT_MAGIC &&
+             readUInt32() == WIREFORMAT_VERSION &&
+             readUInt32() == (uint32_t)type;
+}
+
+bool WireReader::isValid() const
+{
+    return valid_;
+}
+
+const char* WireReader::read(const size_t size)
+{
+    if (!valid_ || size > size_ - position_)
+    {
+        valid_ = false;
+        return 0;
+    }
+
+    const char* data = data_ + position_;
+    position_ += size;
+    return data;
+}
+
+uint8_t WireReader::readUInt8()
+{
+    const char* data = read(sizeof(uint8_t));
+    return data ? (uint8_t)*data : 0;
+}
+
+uint32_t WireReader::readUInt32()
+{
+    const unsigned char* data = (const unsigned char*)read(sizeof(uint32_t));
+    if (!data)
+        return 0;
+
+    uint32_t value = 0;
+    for (size_t i = 0; i < sizeof(uint32_t); ++i)
+        value |= (uint32_t)data[i] << (8 * i);
+    return value;
+}
+
+QByteArray WireReader::readBytesView(const size_t size)
+{
+    const char* data = read(size);
+    if (!data || size == 0)
+        return QByteArray();
+
+    return QByteArray::fromRawData(data, size);
+}
+
+WireBufferPool::WireBufferPool(const size_t maxBufferCount)
+    : maxBufferCount_(maxBufferCount)
+{
+}
+
+WireBufferPtr WireBufferPool::getBuffer(const size_t size)
+{
+    // a buffer only referenced by the pool is not used anymore
+    for (std::vector<WireBufferPtr>::iterator it = buffers_.begin(); it != buffers_.end(); ++it)
+    {
+        if (it->unique())
+        {
+            (*it)->resize(size);
+            return *it;
+        }
+    }
+
+    WireBufferPtr buffer(new WireBuffer(size));
+    if (buffers_.size() < maxBufferCount_)
+        buffers_.push_back(buffer);
+    return buffer;
+}
+
+void writePixelStreamFrame(WireBuffer& buffer, const PixelStreamId streamId, const PixelStreamSegments& segments)
+{
+    size_t size = HEADER_SIZE + 2 * sizeof(uint32_t);
+    for (PixelStreamSegments::const_iterator it = segments.begin(); it != segments.end(); ++it)
+        size += MIN_SEGMENT_SIZE + it->imageData.size();
+    buffer.reserve(size);
+
+    WireWriter writer(buffer, WIRE_MESSAGE_PIXELSTREAM_FRAME);
+
+    writer.writeUInt32(streamId);
+    writer.writeUInt32(segments.size());
+
+    for (PixelStreamSegments::const_iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+        writer.writeUInt32(it->parameters.x);
+        writer.writeUInt32(it->parameters.y);
+        writer.writeUInt32(it->parameters.width);
+        writer.writeUInt32(it->parameters.height);
+        writer.writeUInt8(it->parameters.compressed ? 1 : 0);
+        writer.writeUInt32(it->imageData.size());
+        writer.writeBytes(it->imageData.constData(), it->imageData.size());
+    }
+}
+
+bool readPixelStreamFrame(const char* data, const size_t size, PixelStreamId& streamId, PixelStreamSegments& segments)
+{
+    WireReader reader(data, size, WIRE_MESSAGE_PIXELSTREAM_FRAME);
+
+    streamId = reader.readUInt32();
+    const uint32_t segmentCount = reader.readUInt32();
+
+    // do not trust the count of a corrupted message to allocate memory
+    if (!reader.isValid() || segmentCount > size / MIN_SEGMENT_SIZE)
+        return false;
+
+    segments.resize(segmentCount);
+
+    for (PixelStreamSegments::iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+        it->parameters.x = reader.readUInt32();
+        it->parameters.y = reader.readUInt32();
+        it->parameters.width = reader.readUInt32();
+        it->parameters.height = reader.readUInt32();
+        it->parameters.compressed = reader.readUInt8() != 0;
+        it->imageData = reader.readBytesView(reader.readUInt32());
+    }
+
+    return reader.isValid();
+}
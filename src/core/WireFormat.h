@@ -0,0 +1,158 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#ifndef WIREFORMAT_H
+#define WIREFORMAT_H
+
+#include "PixelStreamSegment.h"
+#include "PixelStreamRegistry.h"
+
+#include <stdint.h>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+using dc::PixelStreamSegment;
+
+typedef std::vector<PixelStreamSegment> PixelStreamSegments;
+
+typedef std::vector<char> WireBuffer;
+typedef boost::shared_ptr<WireBuffer> WireBufferPtr;
+
+// Identifies the flat messages, followed by the version of their layout
+#define WIREFORMAT_MAGIC 0x46574344 // "DCWF"
+#define WIREFORMAT_VERSION 1
+
+/** The messages using the flat layout */
+enum WireMessageType
+{
+    WIRE_MESSAGE_PIXELSTREAM_FRAME = 1
+};
+
+/**
+ * Write a message in the flat wire format.
+ *
+ * All values are stored in little-endian order after a header made of the magic number, the layout
+ * version and the message type. The buffer is cleared but keeps its capacity, so that it can be
+ * reused for the next message without new allocations.
+ */
+class WireWriter
+{
+public:
+    /**
+     * Start a new message
+     * @param buffer The destination buffer, cleared by the constructor
+     * @param type The type of the message
+     */
+    WireWriter(WireBuffer& buffer, const WireMessageType type);
+
+    void writeUInt8(const uint8_t value);
+    void writeUInt32(const uint32_t value);
+
+    /** Append raw bytes to the message. */
+    void writeBytes(const char* data, const size_t size);
+
+private:
+    WireBuffer& buffer_;
+};
+
+/**
+ * Read a message in the flat wire format, in place.
+ *
+ * Reading past the end of the message or a wrong header makes the reader invalid, after which all
+ * values read are 0.
+ */
+class WireReader
+{
+public:
+    /**
+     * Start reading a message
+     * @param data The message, which must outlive the reader and the views it returns
+     * @param size The size of the message
+     * @param type The expected type of the message
+     */
+    WireReader(const char* data, const size_t size, const WireMessageType type);
+
+    /** Has the message been read successfully so far. */
+    bool isValid() const;
+
+    uint8_t readUInt8();
+    uint32_t readUInt32();
+
+    /** Get a view on the next bytes of the message, without copying them. */
+    QByteArray readBytesView(const size_t size);
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_;
+    bool valid_;
+
+    const char* read(const size_t size);
+};
+
+/**
+ * Provide buffers for receiving messages, reusing the ones which are not referenced anymore.
+ */
+class WireBufferPool
+{
+public:
+    /**
+     * Construct a pool
+     * @param maxBufferCount The maximum number of buffers kept for reuse
+     */
+    WireBufferPool(const size_t maxBufferCount = 8);
+
+    /** Get a buffer of the given size which is not used elsewhere. */
+    WireBufferPtr getBuffer(const size_t size);
+
+private:
+    size_t maxBufferCount_;
+    std::vector<WireBufferPtr> buffers_;
+};
+
+/** Write the segments of a frame. */
+void writePixelStreamFrame(WireBuffer& buffer, const PixelStreamId streamId, const PixelStreamSegments& segments);
+
+/**
+ * Read the segments of a frame.
+ * The image data of the segments are views on the message, which must outlive them.
+ * @return false if the message is invalid
+ */
+bool readPixelStreamFrame(const char* data, const size_t size, PixelStreamId& streamId, PixelStreamSegments& segments);
+
+#endif // WIREFORMAT_H
@@ -123,7 +123,31 @@ void Configuration::load()
     }
 }
 
+bool Configuration::readUnsignedAttribute(QXmlQuery& query, const QString& attribute, unsigned int& value)
+{
+    QString queryResult;
+
+    query.setQuery(QString("string(%1)").arg(attribute));
+    if(!query.evaluateTo(&queryResult))
+        return false;
+
+    bool ok = false;
+    const unsigned int result = queryResult.remove(QRegExp("[\\n\\t\\r]")).toUInt(&ok);
+    if(ok)
+        value = result;
 
+    return ok;
+}
+
+bool Configuration::readMegaAttribute(QXmlQuery& query, const QString& attribute, size_t& value)
+{
+    unsigned int megaValue = 0;
+    if(!readUnsignedAttribute(query, attribute, megaValue))
+        return false;
+
+    value = (size_t)megaValue * 1024 * 1024;
+    return true;
+}
 
 int Configuration::getTotalScreenCountX() const
 {
@@ -179,6 +203,18 @@ int Configuration::getTotalHeight() const
     return totalScreenCountY_ * screenHeight_ + (totalScreenCountY_ - 1) * getMullionHeight();
 }
 
+QRectF Configuration::getNormalizedScreenRect(const QPoint& globalScreenIndex) const
+{
+    const double left = globalScreenIndex.x() * (screenWidth_ + getMullionWidth());
+    const double top = globalScreenIndex.y() * (screenHeight_ + getMullionHeight());
+
+    const double totalWidth = (double)getTotalWidth();
+    const double totalHeight = (double)getTotalHeight();
+
+    return QRectF(left / totalWidth, top / totalHeight,
+                  (double)screenWidth_ / totalWidth, (double)screenHeight_ / totalHeight);
+}
+
 bool Configuration::getFullscreen() const
 {
     return fullscreen_;
@@ -41,9 +41,13 @@
 
 #include <QString>
 #include <QColor>
+#include <QRectF>
+#include <QPoint>
 
 #include "types.h"
 
+class QXmlQuery;
+
 /**
  * @brief The Configuration class manages all the settings needed by a
  * DisplayCluster application.
@@ -122,6 +126,13 @@ public:
      */
     int getTotalHeight() const;
 
+    /**
+     * @brief getNormalizedScreenRect Get the area of the DisplayWall covered by a screen.
+     * @param globalScreenIndex index of the screen starting at {0,0} from the top-left
+     * @return rectangle in normalized wall coordinates, including the Mullion padding
+     */
+    QRectF getNormalizedScreenRect(const QPoint& globalScreenIndex) const;
+
     /**
      * @brief getFullscreen Display the windows in fullscreen mode
      * @return the fullscreen status
@@ -172,6 +183,23 @@ protected:
      */
     QString filename_;
 
+    /**
+     * @brief Read an optional unsigned attribute.
+     * @param query query focused on the xml configuration file
+     * @param attribute XPath of the attribute, e.g. "/configuration/memory/@hostBudgetMB"
+     * @param value set to the attribute value, left unchanged if it is missing or invalid
+     * @return true if the attribute was read
+     */
+    static bool readUnsignedAttribute(QXmlQuery& query, const QString& attribute, unsigned int& value);
+
+    /**
+     * @brief Read an optional unsigned attribute given in mega units (MB, megapixels).
+     * @param value set to the attribute value times 1024*1024, left unchanged if it is missing or invalid
+     * @return true if the attribute was read
+     * @see readUnsignedAttribute
+     */
+    static bool readMegaAttribute(QXmlQuery& query, const QString& attribute, size_t& value);
+
 private:
     OptionsPtr options_;
 
@@ -49,6 +49,12 @@
 
 MasterConfiguration::MasterConfiguration(const QString &filename, OptionsPtr options)
     : Configuration(filename, options)
+    , pixelStreamMaxFrameLag_(MASTERCONFIGURATION_DEFAULT_MAX_FRAME_LAG)
+    , pixelStreamMaxBufferSize_((size_t)MASTERCONFIGURATION_DEFAULT_MAX_BUFFER_SIZE_MB * 1024 * 1024)
+    , pixelStreamStragglerPolicy_(STRAGGLER_PARTIAL_FRAME)
+    , pixelStreamTranscodingPolicy_(TRANSCODING_AUTO)
+    , pixelStreamTranscodingQuality_(MASTERCONFIGURATION_DEFAULT_TRANSCODING_QUALITY)
+    , pixelStreamDispatchBudget_((size_t)MASTERCONFIGURATION_DEFAULT_DISPATCH_BUDGET_MB * 1024 * 1024)
 {
     loadMasterSettings();
 }
@@ -64,7 +70,8 @@ void MasterConfiguration::loadMasterSettings()
 
     loadDockStartDirectory(query);
     loadWebBrowserStartURL(query);
-
+    loadPixelStreamSettings(query);
+    loadWallProcessesScreens(query);
 }
 
 void MasterConfiguration::loadDockStartDirectory(QXmlQuery& query)
@@ -99,6 +106,74 @@ void MasterConfiguration::loadWebBrowserStartURL(QXmlQuery& query)
         webBrowserDefaultURL_ = DEFAULT_URL;
 }
 
+void MasterConfiguration::loadPixelStreamSettings(QXmlQuery& query)
+{
+    QString queryResult;
+
+    readUnsignedAttribute(query, "/configuration/pixelstream/@maxFrameLag", pixelStreamMaxFrameLag_);
+    readMegaAttribute(query, "/configuration/pixelstream/@maxBufferSizeMB", pixelStreamMaxBufferSize_);
+
+    query.setQuery("string(/configuration/pixelstream/@stragglerPolicy)");
+    if (query.evaluateTo(&queryResult))
+    {
+        queryResult.remove(QRegExp(TRIM_REGEX));
+        if (queryResult == "drop")
+            pixelStreamStragglerPolicy_ = STRAGGLER_DROP_FRAME;
+        else if (queryResult == "partial")
+            pixelStreamStragglerPolicy_ = STRAGGLER_PARTIAL_FRAME;
+    }
+
+    query.setQuery("string(/configuration/pixelstream/@transcoding)");
+    if (query.evaluateTo(&queryResult))
+    {
+        parseTranscodingPolicy(queryResult.remove(QRegExp(TRIM_REGEX)), pixelStreamTranscodingPolicy_);
+    }
+
+    unsigned int quality = 0;
+    if (readUnsignedAttribute(query, "/configuration/pixelstream/@transcodingQuality", quality) &&
+        quality > 0 && quality <= 100)
+    {
+        pixelStreamTranscodingQuality_ = quality;
+    }
+
+    readMegaAttribute(query, "/configuration/pixelstream/@dispatchBudgetMB", pixelStreamDispatchBudget_);
+}
+
+void MasterConfiguration::loadWallProcessesScreens(QXmlQuery& query)
+{
+    QString queryResult;
+
+    int processCount = 0;
+    query.setQuery("string(count(//process))");
+    if (query.evaluateTo(&queryResult))
+        processCount = queryResult.toInt();
+
+    processesGlobalScreenIndices_.resize(processCount);
+
+    for (int processIndex = 1; processIndex <= processCount; ++processIndex)
+    {
+        int screenCount = 0;
+        query.setQuery(QString("string(count(//process[%1]/screen))").arg(processIndex));
+        if (query.evaluateTo(&queryResult))
+            screenCount = queryResult.toInt();
+
+        for (int i = 1; i <= screenCount; ++i)
+        {
+            QPoint screenIndex;
+
+            query.setQuery(QString("string(//process[%1]/screen[%2]/@i)").arg(processIndex).arg(i));
+            if (query.evaluateTo(&queryResult))
+                screenIndex.setX(queryResult.toInt());
+
+            query.setQuery(QString("string(//process[%1]/screen[%2]/@j)").arg(processIndex).arg(i));
+            if (query.evaluateTo(&queryResult))
+                screenIndex.setY(queryResult.toInt());
+
+            processesGlobalScreenIndices_[processIndex-1].push_back(screenIndex);
+        }
+    }
+}
+
 const QString& MasterConfiguration::getDockStartDir() const
 {
     return dockStartDir_;
@@ -113,3 +188,43 @@ const QString& MasterConfiguration::getWebBrowserDefaultURL() const
 {
     return webBrowserDefaultURL_;
 }
+
+unsigned int MasterConfiguration::getPixelStreamMaxFrameLag() const
+{
+    return pixelStreamMaxFrameLag_;
+}
+
+size_t MasterConfiguration::getPixelStreamMaxBufferSize() const
+{
+    return pixelStreamMaxBufferSize_;
+}
+
+StragglerPolicy MasterConfiguration::getPixelStreamStragglerPolicy() const
+{
+    return pixelStreamStragglerPolicy_;
+}
+
+TranscodingPolicy MasterConfiguration::getPixelStreamTranscodingPolicy() const
+{
+    return pixelStreamTranscodingPolicy_;
+}
+
+unsigned int MasterConfiguration::getPixelStreamTranscodingQuality() const
+{
+    return pixelStreamTranscodingQuality_;
+}
+
+size_t MasterConfiguration::getPixelStreamDispatchBudget() const
+{
+    return pixelStreamDispatchBudget_;
+}
+
+int MasterConfiguration::getWallProcessCount() const
+{
+    return processesGlobalScreenIndices_.size();
+}
+
+const std::vector<QPoint>& MasterConfiguration::getGlobalScreenIndices(int processIndex) const
+{
+    return processesGlobalScreenIndices_.at(processIndex-1);
+}
@@ -41,8 +41,21 @@
 #define MASTERCONFIGURATION_H
 
 #include "Configuration.h"
+#include "PixelStreamPolicies.h"
 
-class QXmlQuery;
+#include <vector>
+
+// Default maximum number of frames a stream source can be ahead of the slowest source
+#define MASTERCONFIGURATION_DEFAULT_MAX_FRAME_LAG 10
+
+// Default maximum amount of image data buffered for a stream
+#define MASTERCONFIGURATION_DEFAULT_MAX_BUFFER_SIZE_MB 256
+
+// Default JPEG quality used for compressing raw streams
+#define MASTERCONFIGURATION_DEFAULT_TRANSCODING_QUALITY 75
+
+// Default amount of stream data dispatched to the Wall processes per frame
+#define MASTERCONFIGURATION_DEFAULT_DISPATCH_BUDGET_MB 64
 
 /**
  * @brief The MasterConfiguration class manages all the parameters needed
@@ -78,14 +91,79 @@ public:
      */
     const QString& getWebBrowserDefaultURL() const;
 
+    /**
+     * @brief Get the maximum number of frames a stream source can be ahead
+     * of the slowest source of the same stream.
+     * @return number of frames, 0 for unlimited
+     */
+    unsigned int getPixelStreamMaxFrameLag() const;
+
+    /**
+     * @brief Get the maximum amount of image data buffered for a stream.
+     * @return size in bytes, 0 for unlimited
+     */
+    size_t getPixelStreamMaxBufferSize() const;
+
+    /**
+     * @brief Get the policy applied to a stream when a late source exceeds
+     * the buffer limits.
+     * @return the policy, STRAGGLER_PARTIAL_FRAME if unspecified
+     */
+    StragglerPolicy getPixelStreamStragglerPolicy() const;
+
+    /**
+     * @brief Get the default policy for compressing raw streams before
+     * sending them to the Wall processes.
+     * @return the policy, TRANSCODING_AUTO if unspecified
+     */
+    TranscodingPolicy getPixelStreamTranscodingPolicy() const;
+
+    /**
+     * @brief Get the JPEG quality used for compressing raw streams.
+     * @return quality between 1 and 100
+     */
+    unsigned int getPixelStreamTranscodingQuality() const;
+
+    /**
+     * @brief Get the amount of stream data which can be sent to the Wall
+     * processes per frame before the less visible streams are sent at a
+     * lower frame rate.
+     * @return size in bytes, 0 for unlimited
+     */
+    size_t getPixelStreamDispatchBudget() const;
+
+    /**
+     * @brief Get the number of Wall processes described in the configuration.
+     * @return number of processes
+     */
+    int getWallProcessCount() const;
+
+    /**
+     * @brief Get the global indices of the screens managed by a Wall process.
+     * @param processIndex MPI index in the range [1;getWallProcessCount()] of the process
+     * @return indices starting at {0,0} from the top-left
+     */
+    const std::vector<QPoint>& getGlobalScreenIndices(int processIndex) const;
+
 private:
     void loadMasterSettings();
     void loadDockStartDirectory(QXmlQuery& query);
     void loadWebBrowserStartURL(QXmlQuery& query);
+    void loadPixelStreamSettings(QXmlQuery& query);
+    void loadWallProcessesScreens(QXmlQuery& query);
 
     QString dockStartDir_;
     int dcWebServicePort_;
     QString webBrowserDefaultURL_;
+
+    unsigned int pixelStreamMaxFrameLag_;
+    size_t pixelStreamMaxBufferSize_;
+    StragglerPolicy pixelStreamStragglerPolicy_;
+    TranscodingPolicy pixelStreamTranscodingPolicy_;
+    unsigned int pixelStreamTranscodingQuality_;
+    size_t pixelStreamDispatchBudget_;
+
+    std::vector< std::vector<QPoint> > processesGlobalScreenIndices_;
 };
 
 #endif // MASTERCONFIGURATION_H
@@ -46,6 +46,15 @@
 WallConfiguration::WallConfiguration(const QString &filename, OptionsPtr options, int processIndex)
     : Configuration(filename, options)
     , screenCountForCurrentProcess_(0)
+    , pixelStreamDecodeBudget_((size_t)WALLCONFIGURATION_DEFAULT_DECODE_BUDGET_MP * 1024 * 1024)
+    , contentCacheHostMemory_((size_t)WALLCONFIGURATION_DEFAULT_CACHE_HOST_MEMORY_MB * 1024 * 1024)
+    , contentCacheGPUMemory_((size_t)WALLCONFIGURATION_DEFAULT_CACHE_GPU_MEMORY_MB * 1024 * 1024)
+    , hostMemoryBudget_(0)
+    , gpuMemoryBudget_(0)
+    , renderThreads_(true)
+    , movieDecodeAhead_(WALLCONFIGURATION_DEFAULT_MOVIE_DECODE_AHEAD)
+    , headless_(false)
+    , frameDumpInterval_(0)
 {
     loadWallSettings(processIndex);
 }
@@ -115,6 +124,39 @@ void WallConfiguration::loadWallSettings(int processIndex)
 
         put_flog(LOG_INFO, "  screen parameters: posX = %i, posY = %i, indexX = %i, indexY = %i", screenPosition.x(), screenPosition.y(), screenIndex.x(), screenIndex.y());
     }
+
+    // get the pixel stream decoding budget (optional attribute, in megapixels)
+    readMegaAttribute(query, "/configuration/pixelstream/@decodeBudgetMP", pixelStreamDecodeBudget_);
+
+    // get the content cache budgets (optional attributes, in megabytes per content type)
+    readMegaAttribute(query, "/configuration/contentcache/@hostMemoryMB", contentCacheHostMemory_);
+    readMegaAttribute(query, "/configuration/contentcache/@gpuMemoryMB", contentCacheGPUMemory_);
+
+    // get the memory budgets of all the contents (optional attributes, in megabytes)
+    readMegaAttribute(query, "/configuration/memory/@hostBudgetMB", hostMemoryBudget_);
+    readMegaAttribute(query, "/configuration/memory/@gpuBudgetMB", gpuMemoryBudget_);
+
+    // render the screens of the process in parallel threads (optional attribute, enabled by default)
+    unsigned int threads = 1;
+    readUnsignedAttribute(query, "/configuration/rendering/@threads", threads);
+    renderThreads_ = threads != 0;
+
+    // number of movie frames decoded ahead of the displayed one (optional attribute)
+    readUnsignedAttribute(query, "/configuration/movie/@decodeAhead", movieDecodeAhead_);
+
+    // headless mode (optional element)
+    query.setQuery("string(/configuration/headless/@enabled)");
+    if(query.evaluateTo(&queryResult))
+        headless_ = queryResult.toInt() != 0;
+
+    query.setQuery("string(/configuration/headless/@frameDumpDirectory)");
+    if(query.evaluateTo(&queryResult))
+        frameDumpDirectory_ = queryResult.remove(QRegExp("[\\n\\t\\r]"));
+
+    readUnsignedAttribute(query, "/configuration/headless/@frameDumpInterval", frameDumpInterval_);
+
+    if(headless_)
+        put_flog(LOG_INFO, "headless mode, frame dump interval = %u", frameDumpInterval_);
 }
 
 const QString &WallConfiguration::getHost() const
@@ -141,3 +183,53 @@ const QPoint &WallConfiguration::getGlobalScreenIndex(int screenIndex) const
 {
     return screenGlobalIndex_.at(screenIndex);
 }
+
+size_t WallConfiguration::getPixelStreamDecodeBudget() const
+{
+    return pixelStreamDecodeBudget_;
+}
+
+size_t WallConfiguration::getContentCacheHostMemory() const
+{
+    return contentCacheHostMemory_;
+}
+
+size_t WallConfiguration::getContentCacheGPUMemory() const
+{
+    return contentCacheGPUMemory_;
+}
+
+size_t WallConfiguration::getHostMemoryBudget() const
+{
+    return hostMemoryBudget_;
+}
+
+size_t WallConfiguration::getGPUMemoryBudget() const
+{
+    return gpuMemoryBudget_;
+}
+
+bool WallConfiguration::getRenderThreads() const
+{
+    return renderThreads_;
+}
+
+unsigned int WallConfiguration::getMovieDecodeAhead() const
+{
+    return movieDecodeAhead_;
+}
+
+bool WallConfiguration::getHeadless() const
+{
+    return headless_;
+}
+
+const QString &WallConfiguration::getFrameDumpDirectory() const
+{
+    return frameDumpDirectory_;
+}
+
+unsigned int WallConfiguration::getFrameDumpInterval() const
+{
+    return frameDumpInterval_;
+}
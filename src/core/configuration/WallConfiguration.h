@@ -43,6 +43,16 @@
 #include "Configuration.h"
 #include <QPoint>
 
+// Default number of stream megapixels decoded per frame
+#define WALLCONFIGURATION_DEFAULT_DECODE_BUDGET_MP 16
+
+// Default memory which the contents of each type may use before the ones without a window are evicted
+#define WALLCONFIGURATION_DEFAULT_CACHE_HOST_MEMORY_MB 512
+#define WALLCONFIGURATION_DEFAULT_CACHE_GPU_MEMORY_MB 256
+
+// Default number of movie frames decoded ahead of the displayed one
+#define WALLCONFIGURATION_DEFAULT_MOVIE_DECODE_AHEAD 2
+
 /**
  * @brief The WallConfiguration class manages all the parameters needed
  * to setup a Wall process.
@@ -91,6 +101,72 @@ public:
      */
     const QPoint& getGlobalScreenIndex(int screenIndex) const;
 
+    /**
+     * @brief Get the number of stream pixels which can be decoded per frame
+     * before the less visible streams are updated at a lower frame rate.
+     * @return number of pixels, 0 for unlimited
+     */
+    size_t getPixelStreamDecodeBudget() const;
+
+    /**
+     * @brief Get the host memory which the contents of each type may use
+     * before the ones without a window are evicted from the cache.
+     * @return number of bytes
+     */
+    size_t getContentCacheHostMemory() const;
+
+    /**
+     * @brief Get the GPU memory which the contents of each type may use
+     * before the ones without a window are evicted from the cache.
+     * @return number of bytes
+     */
+    size_t getContentCacheGPUMemory() const;
+
+    /**
+     * @brief Get the host memory which all the contents may use
+     * before the least important ones are evicted.
+     * @return number of bytes, 0 for unlimited
+     */
+    size_t getHostMemoryBudget() const;
+
+    /**
+     * @brief Get the GPU memory which all the contents may use
+     * before the least important ones are evicted.
+     * @return number of bytes, 0 for a fraction of the memory reported by the driver
+     */
+    size_t getGPUMemoryBudget() const;
+
+    /**
+     * @brief Render each screen of the process in its own thread.
+     * @return true unless disabled, only used if the process has several screens
+     */
+    bool getRenderThreads() const;
+
+    /**
+     * @brief Get the number of movie frames which are decoded ahead of the displayed one.
+     * @return number of frames, 0 to decode synchronously when the frame is displayed
+     */
+    unsigned int getMovieDecodeAhead() const;
+
+    /**
+     * @brief Render offscreen, without showing any window.
+     * The windows still need an X display, which can be shared by all the processes (e.g. Xvfb).
+     * @return true if the headless mode is enabled
+     */
+    bool getHeadless() const;
+
+    /**
+     * @brief Get the directory where the headless frames are saved.
+     * @return empty string if unspecified
+     */
+    const QString& getFrameDumpDirectory() const;
+
+    /**
+     * @brief Get the number of frames between two saved headless frames.
+     * @return 0 if the frames are not saved
+     */
+    unsigned int getFrameDumpInterval() const;
+
 private:
 
     QString host_;
@@ -100,6 +176,21 @@ private:
     std::vector<QPoint> screenPosition_;
     std::vector<QPoint> screenGlobalIndex_;
 
+    size_t pixelStreamDecodeBudget_;
+
+    size_t contentCacheHostMemory_;
+    size_t contentCacheGPUMemory_;
+
+    size_t hostMemoryBudget_;
+    size_t gpuMemoryBudget_;
+
+    bool renderThreads_;
+    unsigned int movieDecodeAhead_;
+
+    bool headless_;
+    QString frameDumpDirectory_;
+    unsigned int frameDumpInterval_;
+
     void loadWallSettings(int processIndex);
 };
 
@@ -37,12 +37,15 @@
 /*********************************************************************/
 
 #include "globals.h"
+#include "PixelStreamRegistry.h"
 
 int g_mpiRank = -1;
 int g_mpiSize = -1;
 MPI_Comm g_mpiRenderComm;
+MPIChannel* g_mpiChannel = NULL; // Messages from rank 0 to the wall processes
 
 Configuration * g_configuration = NULL;
 DisplayGroupManagerPtr g_displayGroupManager;
 MainWindow * g_mainWindow = NULL;
-uint64_t g_frameCount = 0; // Used to garbage collect FactoryObjects which are no longer being rendered
+uint64_t g_frameCount = 0; // Used to find the FactoryObjects which were rendered least recently
+PixelStreamRegistry g_pixelStreamRegistry; // Identifiers of the PixelStreams, assigned by rank 0
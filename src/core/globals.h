@@ -45,14 +45,18 @@
 
 class Configuration;
 class MainWindow;
+class MPIChannel;
+class PixelStreamRegistry;
 
 extern int g_mpiRank;
 extern int g_mpiSize;
 extern MPI_Comm g_mpiRenderComm;
+extern MPIChannel* g_mpiChannel;
 
 extern Configuration* g_configuration;
 extern DisplayGroupManagerPtr g_displayGroupManager;
 extern MainWindow * g_mainWindow;
 extern uint64_t g_frameCount;
+extern PixelStreamRegistry g_pixelStreamRegistry;
 
 #endif
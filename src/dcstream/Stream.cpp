@@ -97,6 +97,33 @@ bool Stream::finishFrame()
     return impl_->dcSocket_.send(mh, QByteArray());
 }
 
+bool Stream::setTranscodingPolicy(const CompressionPolicy policy)
+{
+    if(!isConnected())
+    {
+        put_flog(LOG_WARN, "dcSocket is NULL or not connected");
+        return false;
+    }
+
+    // Formatted as a transcoding Command, handled by the TranscodingCommandHandler
+    QString command("transcoding::");
+    switch(policy)
+    {
+    case COMPRESSION_ON:
+        command.append("on");
+        break;
+    case COMPRESSION_OFF:
+        command.append("off");
+        break;
+    case COMPRESSION_AUTO:
+    default:
+        command.append("auto");
+        break;
+    }
+
+    return impl_->sendCommand(command);
+}
+
 bool Stream::registerForEvents(const bool exclusive)
 {
     if(!isConnected())
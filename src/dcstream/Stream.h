@@ -113,6 +113,22 @@ public:
      */
     bool finishFrame();
 
+    /**
+     * Set how the DisplayCluster application compresses the uncompressed images of this Stream.
+     *
+     * The images sent with COMPRESSION_OFF can be compressed by the DisplayCluster master process
+     * before being forwarded to the display wall. COMPRESSION_ON always compresses them,
+     * COMPRESSION_OFF never does and COMPRESSION_AUTO only does when the wall interconnect is
+     * saturated. Streams which do not set a policy use the one of the DisplayCluster configuration.
+     *
+     * The policy applies to all the Streams which use the same name.
+     *
+     * @param policy The compression policy for the uncompressed images
+     * @return true if the request could be sent, false otherwise
+     * @version 1.0
+     */
+    bool setTranscodingPolicy(const CompressionPolicy policy);
+
     /**
      * Register to receive Events.
      *
@@ -48,6 +48,11 @@ namespace ut = boost::unit_test;
 #include "dcstream/ImageSegmenter.h"
 #include "PixelStreamSegment.h"
 #include "PixelStreamSegmentDecoder.h"
+#include "PixelStreamDecoderPool.h"
+
+#include <boost/shared_ptr.hpp>
+
+typedef boost::shared_ptr<PixelStreamSegmentDecoder> PixelStreamSegmentDecoderPtr;
 
 void fillTestImage(std::vector<char>& data)
 {
@@ -131,3 +136,120 @@ BOOST_AUTO_TEST_CASE( testImageSegmentationWithCompressionAndDecompression )
     BOOST_CHECK_EQUAL_COLLECTIONS( data.data(), data.data()+segment.imageData.size(),
                                    dataOut, dataOut+segment.imageData.size() );
 }
+
+BOOST_AUTO_TEST_CASE( testImageDecompressionToBuffer )
+{
+    std::vector<char> data;
+    fillTestImage(data);
+    dc::ImageWrapper imageWrapper(data.data(), 8, 8, dc::RGBA);
+
+    dc::ImageJpegCompressor compressor;
+    QByteArray jpegData = compressor.computeJpeg(imageWrapper, QRect(0,0,8,8));
+
+    ImageJpegDecompressor decompressor;
+    std::vector<char> buffer(data.size(), 0);
+    BOOST_REQUIRE( decompressor.decompress(jpegData, (unsigned char*)buffer.data(), 8, 8) );
+    BOOST_CHECK_EQUAL_COLLECTIONS( data.begin(), data.end(), buffer.begin(), buffer.end() );
+
+    // The dimensions must match the size of the buffer
+    BOOST_CHECK( !decompressor.decompress(jpegData, (unsigned char*)buffer.data(), 4, 8) );
+}
+
+dc::PixelStreamSegment createCompressedSegment(const std::vector<char>& data)
+{
+    dc::ImageWrapper imageWrapper(data.data(), 8, 8, dc::RGBA);
+
+    dc::ImageJpegCompressor compressor;
+
+    dc::PixelStreamSegment segment;
+    segment.parameters.width = 8;
+    segment.parameters.height = 8;
+    segment.parameters.compressed = true;
+    segment.imageData = compressor.computeJpeg(imageWrapper, QRect(0,0,8,8));
+    return segment;
+}
+
+bool waitForDecoders(const std::vector<PixelStreamSegmentDecoderPtr>& decoders)
+{
+    for(size_t timeout = 0; timeout < 1000; ++timeout)
+    {
+        bool running = false;
+        for(size_t i = 0; i < decoders.size(); ++i)
+            running = running || decoders[i]->isRunning();
+
+        if(!running)
+            return true;
+
+        usleep(1000);
+    }
+    return false;
+}
+
+BOOST_AUTO_TEST_CASE( testDecoderPoolDecodesAllSegments )
+{
+    std::vector<char> data;
+    fillTestImage(data);
+
+    PixelStreamDecoderPool pool(4);
+    BOOST_REQUIRE_EQUAL( pool.getThreadCount(), 4 );
+
+    // more segments than threads, so that the threads steal from each other
+    std::vector<dc::PixelStreamSegment> segments(32, createCompressedSegment(data));
+    std::vector<PixelStreamSegmentDecoderPtr> decoders;
+
+    for(size_t i = 0; i < segments.size(); ++i)
+    {
+        decoders.push_back(PixelStreamSegmentDecoderPtr(new PixelStreamSegmentDecoder(&pool)));
+        decoders.back()->startDecoding(segments[i]);
+    }
+
+    BOOST_REQUIRE( waitForDecoders(decoders) );
+
+    for(size_t i = 0; i < segments.size(); ++i)
+    {
+        BOOST_CHECK( !segments[i].parameters.compressed );
+        BOOST_CHECK_EQUAL( segments[i].imageData.size(), data.size() );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( testDecoderPoolDecodesLatestSegment )
+{
+    std::vector<char> data;
+    fillTestImage(data);
+
+    PixelStreamDecoderPool pool(1);
+
+    // the segment of the previous frame is either decoded or replaced, the latest one is never dropped
+    dc::PixelStreamSegment previousSegment = createCompressedSegment(data);
+    dc::PixelStreamSegment latestSegment = createCompressedSegment(data);
+
+    std::vector<PixelStreamSegmentDecoderPtr> decoders;
+    decoders.push_back(PixelStreamSegmentDecoderPtr(new PixelStreamSegmentDecoder(&pool)));
+    decoders.back()->startDecoding(previousSegment);
+    decoders.back()->startDecoding(latestSegment);
+
+    BOOST_REQUIRE( waitForDecoders(decoders) );
+
+    BOOST_CHECK( !latestSegment.parameters.compressed );
+    BOOST_CHECK_EQUAL( latestSegment.imageData.size(), data.size() );
+}
+
+BOOST_AUTO_TEST_CASE( testDecoderDestructionWaitsForDecoding )
+{
+    std::vector<char> data;
+    fillTestImage(data);
+
+    PixelStreamDecoderPool pool(2);
+    dc::PixelStreamSegment segment = createCompressedSegment(data);
+
+    {
+        PixelStreamSegmentDecoder decoder(&pool);
+        decoder.startDecoding(segment);
+    }
+
+    // the segment is either decoded or left untouched, but never being decoded
+    if(segment.parameters.compressed)
+        BOOST_CHECK( segment.imageData.size() != (int)data.size() );
+    else
+        BOOST_CHECK_EQUAL( segment.imageData.size(), data.size() );
+}
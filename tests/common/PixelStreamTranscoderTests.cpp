@@ -0,0 +1,135 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE PixelStreamTranscoderTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "PixelStreamSegment.h"
+#include "PixelStreamTranscoder.h"
+#include "ImageJpegDecompressor.h"
+
+#include <cstdlib>
+
+PixelStreamSegment createRawSegment(const unsigned int x)
+{
+    PixelStreamSegment segment;
+    segment.parameters.x = x;
+    segment.parameters.width = 8;
+    segment.parameters.height = 8;
+    segment.parameters.compressed = false;
+
+    for (size_t i = 0; i<8*8; ++i)
+    {
+        segment.imageData.append((char)192); // R
+        segment.imageData.append((char)128); // G
+        segment.imageData.append((char)64);  // B
+        segment.imageData.append((char)255); // A
+    }
+    return segment;
+}
+
+// JPEG encoders may round the colors differently, even at the best quality
+#define MAX_CHANNEL_DIFFERENCE 2
+
+bool isImageDataClose(const QByteArray& expected, const QByteArray& actual)
+{
+    if (expected.size() != actual.size())
+        return false;
+
+    for (int i = 0; i < expected.size(); ++i)
+    {
+        if (std::abs((int)(unsigned char)expected[i] - (int)(unsigned char)actual[i]) > MAX_CHANNEL_DIFFERENCE)
+            return false;
+    }
+    return true;
+}
+
+BOOST_AUTO_TEST_CASE( testTranscodingPolicy )
+{
+    PixelStreamTranscoder transcoder(75);
+
+    BOOST_CHECK( !transcoder.isInterconnectSaturated() );
+    BOOST_CHECK( transcoder.isTranscodingNeeded( TRANSCODING_ON ) );
+    BOOST_CHECK( !transcoder.isTranscodingNeeded( TRANSCODING_OFF ) );
+    BOOST_CHECK( !transcoder.isTranscodingNeeded( TRANSCODING_AUTO ) );
+}
+
+BOOST_AUTO_TEST_CASE( testTranscodingPolicyParsing )
+{
+    TranscodingPolicy policy = TRANSCODING_OFF;
+
+    BOOST_CHECK( parseTranscodingPolicy("auto", policy) );
+    BOOST_CHECK_EQUAL( policy, TRANSCODING_AUTO );
+    BOOST_CHECK( parseTranscodingPolicy("on", policy) );
+    BOOST_CHECK_EQUAL( policy, TRANSCODING_ON );
+    BOOST_CHECK( parseTranscodingPolicy("off", policy) );
+    BOOST_CHECK_EQUAL( policy, TRANSCODING_OFF );
+
+    BOOST_CHECK( !parseTranscodingPolicy("", policy) );
+    BOOST_CHECK( !parseTranscodingPolicy("zorglump", policy) );
+    BOOST_CHECK_EQUAL( policy, TRANSCODING_OFF );
+}
+
+BOOST_AUTO_TEST_CASE( testTranscodeRawSegments )
+{
+    PixelStreamSegments segments;
+    segments.push_back(createRawSegment(0));
+    segments.push_back(createRawSegment(8));
+
+    const QByteArray rawData = segments[0].imageData;
+    BOOST_REQUIRE_EQUAL( PixelStreamTranscoder::getImageDataSize(segments), 2*8*8*4 );
+
+    PixelStreamTranscoder transcoder(100);
+    QFuture<void> future = transcoder.startTranscoding(segments);
+    future.waitForFinished();
+
+    BOOST_REQUIRE_EQUAL( segments.size(), 2 );
+    BOOST_CHECK_EQUAL( segments[1].parameters.x, 8 );
+
+    ImageJpegDecompressor decompressor;
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        BOOST_REQUIRE( segments[i].parameters.compressed );
+        BOOST_REQUIRE( segments[i].imageData.size() < rawData.size() );
+
+        const QByteArray decodedData = decompressor.decompress(segments[i].imageData);
+        BOOST_REQUIRE_EQUAL( decodedData.size(), rawData.size() );
+        BOOST_CHECK( isImageDataClose(rawData, decodedData) );
+    }
+}
@@ -0,0 +1,91 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE ClockSynchronizerTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "ClockSynchronizer.h"
+
+// Rank 1 clock ahead of rank 0 clock (us)
+#define CLOCK_OFFSET 5000
+
+ClockSample createSample(const int64_t requestSent, const int64_t requestDelay,
+                         const int64_t processing, const int64_t replyDelay)
+{
+    ClockSample sample;
+    sample.requestSent = requestSent;
+    sample.requestReceived = requestSent + requestDelay + CLOCK_OFFSET;
+    sample.replySent = sample.requestReceived + processing;
+    sample.replyReceived = sample.replySent - CLOCK_OFFSET + replyDelay;
+    return sample;
+}
+
+BOOST_AUTO_TEST_CASE( TestSymmetricDelay )
+{
+    ClockSamples samples;
+    samples.push_back(createSample(1000, 40, 10, 40));
+
+    BOOST_CHECK_EQUAL( ClockSynchronizer::estimateOffset(samples).total_microseconds(), CLOCK_OFFSET );
+}
+
+BOOST_AUTO_TEST_CASE( TestShortestDelayIsSelected )
+{
+    ClockSamples samples;
+    // delayed request, the offset would be overestimated
+    samples.push_back(createSample(1000, 900, 10, 50));
+    samples.push_back(createSample(3000, 50, 10, 50));
+    // delayed reply, the offset would be underestimated
+    samples.push_back(createSample(5000, 50, 10, 700));
+
+    BOOST_CHECK_EQUAL( ClockSynchronizer::estimateOffset(samples).total_microseconds(), CLOCK_OFFSET );
+}
+
+BOOST_AUTO_TEST_CASE( TestNoSamples )
+{
+    BOOST_CHECK_EQUAL( ClockSynchronizer::estimateOffset(ClockSamples()).total_microseconds(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( TestTimestampConversion )
+{
+    const int64_t microseconds = ClockSynchronizer::getMicroseconds();
+    const boost::posix_time::ptime timestamp = ClockSynchronizer::toTimestamp(microseconds);
+
+    BOOST_CHECK_EQUAL( timestamp.time_of_day().total_microseconds() % 1000000, microseconds % 1000000 );
+    BOOST_CHECK( timestamp <= boost::posix_time::microsec_clock::universal_time() );
+}
@@ -51,6 +51,7 @@ BOOST_AUTO_TEST_CASE( testCommandTypeToStringConversion )
     BOOST_CHECK_EQUAL( getCommandTypeString(COMMAND_TYPE_FILE).toStdString(), "file" );
     BOOST_CHECK_EQUAL( getCommandTypeString(COMMAND_TYPE_SESSION).toStdString(), "session" );
     BOOST_CHECK_EQUAL( getCommandTypeString(COMMAND_TYPE_WEBBROWSER).toStdString(), "webbrowser" );
+    BOOST_CHECK_EQUAL( getCommandTypeString(COMMAND_TYPE_TRANSCODING).toStdString(), "transcoding" );
 
     BOOST_CHECK_EQUAL( getCommandType(""), COMMAND_TYPE_UNKNOWN );
     BOOST_CHECK_EQUAL( getCommandType("zorglump"), COMMAND_TYPE_UNKNOWN );
@@ -58,6 +59,7 @@ BOOST_AUTO_TEST_CASE( testCommandTypeToStringConversion )
     BOOST_CHECK_EQUAL( getCommandType("file"), COMMAND_TYPE_FILE );
     BOOST_CHECK_EQUAL( getCommandType("session"), COMMAND_TYPE_SESSION );
     BOOST_CHECK_EQUAL( getCommandType("webbrowser"), COMMAND_TYPE_WEBBROWSER );
+    BOOST_CHECK_EQUAL( getCommandType("transcoding"), COMMAND_TYPE_TRANSCODING );
 }
 
 BOOST_AUTO_TEST_CASE( testCommandConstruction )
@@ -62,6 +62,17 @@ namespace ut = boost::unit_test;
 #define CONFIG_EXPECTED_URL "http://bbp.epfl.ch"
 #define CONFIG_EXPECTED_DEFAULT_URL "http://www.google.com"
 
+#define CONFIG_EXPECTED_PIXELSTREAM_MAX_FRAME_LAG 4
+#define CONFIG_EXPECTED_PIXELSTREAM_MAX_BUFFER_SIZE (64 * 1024 * 1024)
+#define CONFIG_EXPECTED_PIXELSTREAM_TRANSCODING_QUALITY 90
+#define CONFIG_EXPECTED_PIXELSTREAM_DISPATCH_BUDGET (32 * 1024 * 1024)
+#define CONFIG_EXPECTED_PIXELSTREAM_DECODE_BUDGET (8 * 1024 * 1024)
+#define CONFIG_EXPECTED_CONTENTCACHE_HOST_MEMORY (1024 * 1024 * 1024)
+#define CONFIG_EXPECTED_CONTENTCACHE_GPU_MEMORY (128 * 1024 * 1024)
+#define CONFIG_EXPECTED_HOST_MEMORY_BUDGET ((size_t)4096 * 1024 * 1024)
+#define CONFIG_EXPECTED_GPU_MEMORY_BUDGET ((size_t)2048 * 1024 * 1024)
+#define CONFIG_EXPECTED_MOVIE_DECODE_AHEAD 4
+
 BOOST_GLOBAL_FIXTURE( MinimalGlobalQtApp );
 
 void testBaseParameters(const Configuration& config, OptionsPtr options)
@@ -90,6 +101,12 @@ void testBaseParameters(const Configuration& config, OptionsPtr options)
 
     BOOST_CHECK_EQUAL( config.getTotalScreenCountX(), 2 );
     BOOST_CHECK_EQUAL( config.getTotalScreenCountY(), 3 );
+
+    const QRectF screenRect = config.getNormalizedScreenRect(QPoint(1,2));
+    BOOST_CHECK_CLOSE( screenRect.x(), (3840.0 + 14.0) / 7694.0, 0.0001 );
+    BOOST_CHECK_CLOSE( screenRect.y(), 2.0 * (1080.0 + 12.0) / 3264.0, 0.0001 );
+    BOOST_CHECK_CLOSE( screenRect.right(), 1.0, 0.0001 );
+    BOOST_CHECK_CLOSE( screenRect.bottom(), 1.0, 0.0001 );
 }
 
 BOOST_AUTO_TEST_CASE( test_configuration )
@@ -112,6 +129,31 @@ BOOST_AUTO_TEST_CASE( test_wall_configuration )
     BOOST_CHECK_EQUAL( config.getHost().toStdString(), CONFIG_EXPECTED_HOST_NAME );
 
     BOOST_CHECK_EQUAL( config.getScreenCount(), 1 );
+    BOOST_CHECK_EQUAL( config.getPixelStreamDecodeBudget(), CONFIG_EXPECTED_PIXELSTREAM_DECODE_BUDGET );
+    BOOST_CHECK_EQUAL( config.getContentCacheHostMemory(), CONFIG_EXPECTED_CONTENTCACHE_HOST_MEMORY );
+    BOOST_CHECK_EQUAL( config.getContentCacheGPUMemory(), CONFIG_EXPECTED_CONTENTCACHE_GPU_MEMORY );
+    BOOST_CHECK_EQUAL( config.getHostMemoryBudget(), CONFIG_EXPECTED_HOST_MEMORY_BUDGET );
+    BOOST_CHECK_EQUAL( config.getGPUMemoryBudget(), CONFIG_EXPECTED_GPU_MEMORY_BUDGET );
+    BOOST_CHECK( !config.getRenderThreads() );
+    BOOST_CHECK_EQUAL( config.getMovieDecodeAhead(), CONFIG_EXPECTED_MOVIE_DECODE_AHEAD );
+
+    BOOST_CHECK( !config.getHeadless() );
+    BOOST_CHECK_EQUAL( config.getFrameDumpInterval(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_wall_configuration_default_values )
+{
+    OptionsPtr options(new Options());
+
+    WallConfiguration config(CONFIG_TEST_FILENAME_II, options, 1);
+
+    BOOST_CHECK_EQUAL( config.getPixelStreamDecodeBudget(), (size_t)WALLCONFIGURATION_DEFAULT_DECODE_BUDGET_MP * 1024 * 1024 );
+    BOOST_CHECK_EQUAL( config.getContentCacheHostMemory(), (size_t)WALLCONFIGURATION_DEFAULT_CACHE_HOST_MEMORY_MB * 1024 * 1024 );
+    BOOST_CHECK_EQUAL( config.getContentCacheGPUMemory(), (size_t)WALLCONFIGURATION_DEFAULT_CACHE_GPU_MEMORY_MB * 1024 * 1024 );
+    BOOST_CHECK_EQUAL( config.getHostMemoryBudget(), 0 );
+    BOOST_CHECK_EQUAL( config.getGPUMemoryBudget(), 0 );
+    BOOST_CHECK( config.getRenderThreads() );
+    BOOST_CHECK_EQUAL( config.getMovieDecodeAhead(), WALLCONFIGURATION_DEFAULT_MOVIE_DECODE_AHEAD );
 }
 
 BOOST_AUTO_TEST_CASE( test_master_configuration )
@@ -123,6 +165,17 @@ BOOST_AUTO_TEST_CASE( test_master_configuration )
     BOOST_CHECK_EQUAL( config.getDockStartDir().toStdString(), CONFIG_EXPECTED_DOCK_DIR );
     BOOST_CHECK_EQUAL( config.getWebServicePort(), CONFIG_EXPECTED_WEBSERVICE_PORT );
     BOOST_CHECK_EQUAL( config.getWebBrowserDefaultURL().toStdString(), CONFIG_EXPECTED_URL );
+
+    BOOST_CHECK_EQUAL( config.getPixelStreamMaxFrameLag(), CONFIG_EXPECTED_PIXELSTREAM_MAX_FRAME_LAG );
+    BOOST_CHECK_EQUAL( config.getPixelStreamMaxBufferSize(), CONFIG_EXPECTED_PIXELSTREAM_MAX_BUFFER_SIZE );
+    BOOST_CHECK_EQUAL( config.getPixelStreamStragglerPolicy(), STRAGGLER_DROP_FRAME );
+    BOOST_CHECK_EQUAL( config.getPixelStreamTranscodingPolicy(), TRANSCODING_ON );
+    BOOST_CHECK_EQUAL( config.getPixelStreamTranscodingQuality(), CONFIG_EXPECTED_PIXELSTREAM_TRANSCODING_QUALITY );
+    BOOST_CHECK_EQUAL( config.getPixelStreamDispatchBudget(), CONFIG_EXPECTED_PIXELSTREAM_DISPATCH_BUDGET );
+
+    BOOST_CHECK_EQUAL( config.getWallProcessCount(), 6 );
+    BOOST_REQUIRE_EQUAL( config.getGlobalScreenIndices(5).size(), 1 );
+    BOOST_CHECK( config.getGlobalScreenIndices(5)[0] == QPoint(1,1) );
 }
 
 BOOST_AUTO_TEST_CASE( test_master_configuration_default_values )
@@ -133,6 +186,13 @@ BOOST_AUTO_TEST_CASE( test_master_configuration_default_values )
 
     BOOST_CHECK_EQUAL( config.getDockStartDir().toStdString(), QDir::homePath().toStdString() );
     BOOST_CHECK_EQUAL( config.getWebBrowserDefaultURL().toStdString(), CONFIG_EXPECTED_DEFAULT_URL );
+
+    BOOST_CHECK_EQUAL( config.getPixelStreamMaxFrameLag(), MASTERCONFIGURATION_DEFAULT_MAX_FRAME_LAG );
+    BOOST_CHECK_EQUAL( config.getPixelStreamMaxBufferSize(), (size_t)MASTERCONFIGURATION_DEFAULT_MAX_BUFFER_SIZE_MB * 1024 * 1024 );
+    BOOST_CHECK_EQUAL( config.getPixelStreamStragglerPolicy(), STRAGGLER_PARTIAL_FRAME );
+    BOOST_CHECK_EQUAL( config.getPixelStreamTranscodingPolicy(), TRANSCODING_AUTO );
+    BOOST_CHECK_EQUAL( config.getPixelStreamTranscodingQuality(), MASTERCONFIGURATION_DEFAULT_TRANSCODING_QUALITY );
+    BOOST_CHECK_EQUAL( config.getPixelStreamDispatchBudget(), (size_t)MASTERCONFIGURATION_DEFAULT_DISPATCH_BUDGET_MB * 1024 * 1024 );
 }
 
 BOOST_AUTO_TEST_CASE( test_save_configuration )
@@ -0,0 +1,111 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE ContentDimensionsProberTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "ContentDimensionsProber.h"
+
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QTextStream>
+
+#define TEST_IMAGE_FILENAME "contentDimensionsProberTest.png"
+#define TEST_PYRAMID_FILENAME "contentDimensionsProberTest.pyr"
+
+QString writeImage(const int width, const int height)
+{
+    const QString filename = QDir::temp().filePath(TEST_IMAGE_FILENAME);
+
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(0);
+    BOOST_REQUIRE( image.save(filename, "PNG") );
+
+    return filename;
+}
+
+BOOST_AUTO_TEST_CASE( TestReadImageDimensions )
+{
+    const QString filename = writeImage(64, 32);
+
+    BOOST_CHECK_EQUAL( ContentDimensionsProber::readDimensions(filename).width(), 64 );
+    BOOST_CHECK_EQUAL( ContentDimensionsProber::readDimensions(filename).height(), 32 );
+
+    QFile::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE( TestReadPyramidDimensions )
+{
+    const QString filename = QDir::temp().filePath(TEST_PYRAMID_FILENAME);
+    {
+        QFile file(filename);
+        BOOST_REQUIRE( file.open(QIODevice::WriteOnly) );
+        QTextStream stream(&file);
+        stream << "\"/path/to/image.pyramid\" 20000 10000";
+    }
+
+    const QSize dimensions = ContentDimensionsProber::readDimensions(filename);
+    BOOST_CHECK_EQUAL( dimensions.width(), 20000 );
+    BOOST_CHECK_EQUAL( dimensions.height(), 10000 );
+
+    QFile::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE( TestMissingFileHasInvalidDimensions )
+{
+    ContentDimensionsProber prober;
+
+    BOOST_CHECK( !prober.getDimensions(QDir::temp().filePath("missing.png")).isValid() );
+}
+
+BOOST_AUTO_TEST_CASE( TestCacheIsInvalidatedWhenTheFileChanges )
+{
+    ContentDimensionsProber prober;
+
+    const QString filename = writeImage(64, 32);
+    BOOST_CHECK_EQUAL( prober.getDimensions(filename).width(), 64 );
+    BOOST_CHECK_EQUAL( prober.getDimensions(filename).width(), 64 );
+
+    // the file size changes even if the modification time does not
+    writeImage(128, 32);
+    BOOST_CHECK_EQUAL( prober.getDimensions(filename).width(), 128 );
+
+    QFile::remove(filename);
+}
@@ -0,0 +1,113 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE DisplayGroupManagerTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "DisplayGroupManager.h"
+#include "MPIChannel.h"
+#include "globals.h"
+#include "MinimalGlobalQtApp.h"
+
+BOOST_GLOBAL_FIXTURE( MinimalGlobalQtApp );
+
+namespace
+{
+MPIMessage makeFrameMessage()
+{
+    // an unstaged frame carries no segments for this rank, but is counted like the others
+    MPIMessage message;
+    message.header.type = MESSAGE_TYPE_PIXELSTREAM;
+    return message;
+}
+
+MPIMessage makeSnapshotMessage(DisplayGroupManagerPtr displayGroup)
+{
+    MPIMessage message;
+    message.header.type = MESSAGE_TYPE_CONTENTS;
+    message.displayGroup = displayGroup;
+    message.staged = true;
+    return message;
+}
+}
+
+BOOST_AUTO_TEST_CASE( TestPixelStreamFramesAreCounted )
+{
+    g_displayGroupManager.reset(new DisplayGroupManager);
+    const unsigned int initialCount = DisplayGroupManager::getReceivedPixelStreamFrameCount();
+
+    MPIMessages messages;
+    messages.push_back(makeFrameMessage());
+    messages.push_back(makeFrameMessage());
+
+    BOOST_CHECK( g_displayGroupManager->processMessages(messages) );
+    BOOST_CHECK_EQUAL( DisplayGroupManager::getReceivedPixelStreamFrameCount(), initialCount + 2 );
+
+    BOOST_CHECK( !g_displayGroupManager->processMessages(MPIMessages()) );
+    BOOST_CHECK_EQUAL( DisplayGroupManager::getReceivedPixelStreamFrameCount(), initialCount + 2 );
+
+    g_displayGroupManager.reset();
+}
+
+BOOST_AUTO_TEST_CASE( TestPixelStreamFrameCountSurvivesSnapshots )
+{
+    g_displayGroupManager.reset(new DisplayGroupManager);
+    const unsigned int initialCount = DisplayGroupManager::getReceivedPixelStreamFrameCount();
+
+    // a snapshot in the middle of a stream replaces the display group
+    DisplayGroupManagerPtr snapshot(new DisplayGroupManager);
+
+    MPIMessages messages;
+    messages.push_back(makeFrameMessage());
+    messages.push_back(makeSnapshotMessage(snapshot));
+    messages.push_back(makeFrameMessage());
+
+    BOOST_CHECK( g_displayGroupManager->processMessages(messages) );
+    BOOST_CHECK( g_displayGroupManager == snapshot );
+    BOOST_CHECK_EQUAL( DisplayGroupManager::getReceivedPixelStreamFrameCount(), initialCount + 2 );
+
+    // the following frames are counted by the new display group from where the previous one stopped
+    messages.clear();
+    messages.push_back(makeFrameMessage());
+
+    BOOST_CHECK( g_displayGroupManager->processMessages(messages) );
+    BOOST_CHECK_EQUAL( DisplayGroupManager::getReceivedPixelStreamFrameCount(), initialCount + 3 );
+
+    g_displayGroupManager.reset();
+}
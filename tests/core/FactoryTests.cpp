@@ -0,0 +1,179 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE FactoryTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "Factory.hpp"
+#include "FactoryObject.h"
+
+#define MB (1024 * 1024)
+
+class MockObject : public FactoryObject
+{
+public:
+    MockObject(const QString&)
+        : hostMemory(0)
+        , gpuMemory(0)
+    {}
+
+    size_t getHostMemoryUsage() const { return hostMemory; }
+    size_t getGPUMemoryUsage() const { return gpuMemory; }
+
+    void render(const uint64_t frame)
+    {
+        g_frameCount = frame;
+        updateRenderedFrameIndex();
+    }
+
+    size_t hostMemory;
+    size_t gpuMemory;
+};
+
+void createObject(Factory<MockObject>& factory, const QString& uri, const uint64_t frame,
+                  const size_t hostMemory, const size_t gpuMemory)
+{
+    boost::shared_ptr<MockObject> object = factory.getObject(uri);
+    object->hostMemory = hostMemory;
+    object->gpuMemory = gpuMemory;
+    object->render(frame);
+}
+
+BOOST_AUTO_TEST_CASE( TestReferencedObjectsAreNeverEvicted )
+{
+    Factory<MockObject> factory;
+    factory.acquireObject("a");
+    createObject(factory, "a", 1, 10 * MB, 10 * MB);
+
+    factory.evictUnreferencedObjects();
+
+    BOOST_CHECK( factory.contains("a") );
+}
+
+BOOST_AUTO_TEST_CASE( TestReleasedObjectsStayCachedWithinBudget )
+{
+    Factory<MockObject> factory;
+    factory.setCacheBudget(10 * MB, 10 * MB);
+
+    factory.acquireObject("a");
+    createObject(factory, "a", 1, 4 * MB, 4 * MB);
+    factory.releaseObject("a");
+
+    factory.evictUnreferencedObjects();
+
+    BOOST_CHECK( factory.contains("a") );
+}
+
+BOOST_AUTO_TEST_CASE( TestZeroBudgetEvictsAllUnreferencedObjects )
+{
+    Factory<MockObject> factory;
+
+    factory.acquireObject("a");
+    factory.acquireObject("b");
+    createObject(factory, "a", 1, 0, 0);
+    createObject(factory, "b", 1, 0, 0);
+    factory.releaseObject("a");
+
+    factory.evictUnreferencedObjects();
+
+    BOOST_CHECK( !factory.contains("a") );
+    BOOST_CHECK( factory.contains("b") );
+}
+
+BOOST_AUTO_TEST_CASE( TestEvictionFollowsLeastRecentlyRendered )
+{
+    Factory<MockObject> factory;
+    factory.setCacheBudget(10 * MB, 100 * MB);
+
+    createObject(factory, "old", 1, 4 * MB, 0);
+    createObject(factory, "recent", 3, 4 * MB, 0);
+    createObject(factory, "middle", 2, 4 * MB, 0);
+
+    factory.evictUnreferencedObjects();
+
+    BOOST_CHECK( !factory.contains("old") );
+    BOOST_CHECK( factory.contains("middle") );
+    BOOST_CHECK( factory.contains("recent") );
+}
+
+BOOST_AUTO_TEST_CASE( TestReferencedObjectsCountTowardsBudget )
+{
+    Factory<MockObject> factory;
+    factory.setCacheBudget(100 * MB, 9 * MB);
+
+    factory.acquireObject("visible");
+    createObject(factory, "visible", 5, 0, 8 * MB);
+    createObject(factory, "cachedOld", 1, 0, 1 * MB);
+    createObject(factory, "cachedRecent", 2, 0, 1 * MB);
+
+    factory.evictUnreferencedObjects();
+
+    BOOST_CHECK( factory.contains("visible") );
+    BOOST_CHECK( !factory.contains("cachedOld") );
+    BOOST_CHECK( factory.contains("cachedRecent") );
+}
+
+BOOST_AUTO_TEST_CASE( TestReacquiredObjectIsReused )
+{
+    Factory<MockObject> factory;
+    factory.setCacheBudget(10 * MB, 10 * MB);
+
+    factory.acquireObject("a");
+    createObject(factory, "a", 1, MB, MB);
+    boost::shared_ptr<MockObject> object = factory.getObject("a");
+    factory.releaseObject("a");
+    factory.evictUnreferencedObjects();
+
+    factory.acquireObject("a");
+    BOOST_CHECK_EQUAL( factory.getObject("a"), object );
+}
+
+BOOST_AUTO_TEST_CASE( TestClearRemovesObjectsAndReferences )
+{
+    Factory<MockObject> factory;
+    factory.acquireObject("a");
+    createObject(factory, "a", 1, 0, 0);
+
+    factory.clear();
+    BOOST_CHECK( !factory.contains("a") );
+
+    createObject(factory, "a", 1, 0, 0);
+    factory.evictUnreferencedObjects();
+    BOOST_CHECK( !factory.contains("a") );
+}
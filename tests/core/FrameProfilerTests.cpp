@@ -0,0 +1,126 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE FrameProfilerTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "FrameProfiler.h"
+
+FrameProfile createProfile(const unsigned int rankCount, const unsigned int frameCount)
+{
+    FrameProfile profile;
+    profile.rankCount = rankCount;
+    profile.frameCount = frameCount;
+    profile.durations.resize(rankCount * frameCount * FRAME_PHASE_COUNT, 0);
+    return profile;
+}
+
+void setDuration(FrameProfile& profile, const unsigned int rankIndex, const unsigned int frame,
+                 const FramePhase phase, const uint32_t duration)
+{
+    profile.durations[(rankIndex * profile.frameCount + frame) * FRAME_PHASE_COUNT + phase] = duration;
+}
+
+BOOST_AUTO_TEST_CASE( TestPercentiles )
+{
+    FrameProfile profile = createProfile(1, 100);
+    for(unsigned int frame=0; frame<100; frame++)
+        setDuration(profile, 0, frame, FRAME_PHASE_RENDER, 100 - frame);
+
+    BOOST_CHECK_EQUAL( profile.getPercentile(0, FRAME_PHASE_RENDER, 50), 50 );
+    BOOST_CHECK_EQUAL( profile.getPercentile(0, FRAME_PHASE_RENDER, 95), 95 );
+    BOOST_CHECK_EQUAL( profile.getPercentile(0, FRAME_PHASE_RENDER, 99), 99 );
+    BOOST_CHECK_EQUAL( profile.getPercentile(0, FRAME_PHASE_RENDER, 0), 1 );
+    BOOST_CHECK_EQUAL( profile.getPercentile(0, FRAME_PHASE_RENDER, 100), 100 );
+    BOOST_CHECK_EQUAL( profile.getPercentile(0, FRAME_PHASE_SWAP, 50), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( TestPercentilesOfOneOrAllRanks )
+{
+    FrameProfile profile = createProfile(2, 2);
+    setDuration(profile, 0, 0, FRAME_PHASE_DECODE, 10);
+    setDuration(profile, 0, 1, FRAME_PHASE_DECODE, 20);
+    setDuration(profile, 1, 0, FRAME_PHASE_DECODE, 30);
+    setDuration(profile, 1, 1, FRAME_PHASE_DECODE, 40);
+
+    BOOST_CHECK_EQUAL( profile.getPercentile(0, FRAME_PHASE_DECODE, 100), 20 );
+    BOOST_CHECK_EQUAL( profile.getPercentile(1, FRAME_PHASE_DECODE, 50), 30 );
+    BOOST_CHECK_EQUAL( profile.getPercentile(-1, FRAME_PHASE_DECODE, 50), 20 );
+    BOOST_CHECK_EQUAL( profile.getPercentile(-1, FRAME_PHASE_DECODE, 75), 30 );
+}
+
+BOOST_AUTO_TEST_CASE( TestEmptyProfile )
+{
+    FrameProfile profile;
+
+    BOOST_CHECK_EQUAL( profile.getPercentile(-1, FRAME_PHASE_RENDER, 50), 0 );
+    BOOST_CHECK( profile.getSlowestRanks().empty( ));
+}
+
+BOOST_AUTO_TEST_CASE( TestBarrierIsNotBusyTime )
+{
+    FrameProfile profile = createProfile(1, 1);
+    setDuration(profile, 0, 0, FRAME_PHASE_RENDER, 5000);
+    setDuration(profile, 0, 0, FRAME_PHASE_BARRIER, 8000);
+    setDuration(profile, 0, 0, FRAME_PHASE_SWAP, 300);
+
+    BOOST_CHECK_EQUAL( profile.getBusyDuration(0, 0), 5300 );
+}
+
+BOOST_AUTO_TEST_CASE( TestSlowestRankIsTheOneTheOthersWaitedFor )
+{
+    FrameProfile profile = createProfile(3, 2);
+
+    // frame 0: rank 2 renders the longest, the others wait for it at the barrier
+    setDuration(profile, 0, 0, FRAME_PHASE_RENDER, 1000);
+    setDuration(profile, 0, 0, FRAME_PHASE_BARRIER, 4000);
+    setDuration(profile, 1, 0, FRAME_PHASE_RENDER, 2000);
+    setDuration(profile, 1, 0, FRAME_PHASE_BARRIER, 3000);
+    setDuration(profile, 2, 0, FRAME_PHASE_RENDER, 5000);
+
+    // frame 1: rank 0 decodes the longest
+    setDuration(profile, 0, 1, FRAME_PHASE_DECODE, 3000);
+    setDuration(profile, 1, 1, FRAME_PHASE_DECODE, 500);
+    setDuration(profile, 2, 1, FRAME_PHASE_DECODE, 700);
+
+    const std::vector<unsigned int> slowestRanks = profile.getSlowestRanks();
+    BOOST_REQUIRE_EQUAL( slowestRanks.size(), 2 );
+    BOOST_CHECK_EQUAL( slowestRanks[0], 2 );
+    BOOST_CHECK_EQUAL( slowestRanks[1], 0 );
+}
@@ -0,0 +1,138 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE MemoryManagerTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "MemoryManager.h"
+
+#define MB (1024 * 1024)
+
+ContentMemoryUsage createUsage(const QString& uri, const size_t hostMemory, const size_t gpuMemory,
+                               const bool referenced, const float visibleArea, const uint64_t renderedFrameIndex = 0)
+{
+    ContentMemoryUsage usage;
+    usage.type = CONTENT_TYPE_TEXTURE;
+    usage.uri = uri;
+    usage.hostMemory = hostMemory;
+    usage.gpuMemory = gpuMemory;
+    usage.referenced = referenced;
+    usage.visibleArea = visibleArea;
+    usage.renderedFrameIndex = renderedFrameIndex;
+    return usage;
+}
+
+BOOST_AUTO_TEST_CASE( TestUnlimitedBudgetEvictsNothing )
+{
+    MemoryManager memoryManager;
+
+    ContentMemoryUsages usages;
+    usages.push_back(createUsage("a", 100 * MB, 100 * MB, false, 0.f));
+    usages.push_back(createUsage("b", 100 * MB, 100 * MB, true, 0.5f));
+
+    BOOST_CHECK( memoryManager.update(usages).empty() );
+    BOOST_CHECK_EQUAL( memoryManager.getUsages().size(), 2 );
+    BOOST_CHECK_EQUAL( memoryManager.getGPUMemoryUsage(), 200 * MB );
+}
+
+BOOST_AUTO_TEST_CASE( TestEvictionOrder )
+{
+    MemoryManager memoryManager(0, 10 * MB);
+
+    ContentMemoryUsages usages;
+    usages.push_back(createUsage("visibleLarge", 0, 4 * MB, true, 0.5f));
+    usages.push_back(createUsage("visibleSmall", 0, 4 * MB, true, 0.1f));
+    usages.push_back(createUsage("hidden", 0, 4 * MB, true, 0.f));
+    usages.push_back(createUsage("closed", 0, 4 * MB, false, 0.f));
+
+    // 16 MB must go down to 10 MB, then to 6 MB: remove the closed, then the hidden content
+    ContentMemoryUsages evictions = memoryManager.update(usages);
+    BOOST_REQUIRE_EQUAL( evictions.size(), 2 );
+    BOOST_CHECK_EQUAL( evictions[0].uri.toStdString(), "closed" );
+    BOOST_CHECK_EQUAL( evictions[1].uri.toStdString(), "hidden" );
+    BOOST_CHECK_EQUAL( memoryManager.getGPUMemoryUsage(), 8 * MB );
+
+    // visible contents are never evicted, they would be created again by the next frame
+    memoryManager.setBudget(0, 5 * MB);
+    evictions = memoryManager.update(memoryManager.getUsages());
+    BOOST_CHECK( evictions.empty() );
+    BOOST_CHECK_EQUAL( memoryManager.getGPUMemoryUsage(), 8 * MB );
+}
+
+BOOST_AUTO_TEST_CASE( TestLeastRecentlyRenderedFirstWithinGroup )
+{
+    MemoryManager memoryManager(0, 5 * MB);
+
+    ContentMemoryUsages usages;
+    usages.push_back(createUsage("recent", 0, 4 * MB, false, 0.f, 20));
+    usages.push_back(createUsage("old", 0, 4 * MB, false, 0.f, 10));
+
+    const ContentMemoryUsages evictions = memoryManager.update(usages);
+    BOOST_REQUIRE_EQUAL( evictions.size(), 1 );
+    BOOST_CHECK_EQUAL( evictions[0].uri.toStdString(), "old" );
+}
+
+BOOST_AUTO_TEST_CASE( TestNonEvictableContentsAreKept )
+{
+    MemoryManager memoryManager(0, 1 * MB);
+
+    ContentMemoryUsages usages;
+    usages.push_back(createUsage("movie", 0, 4 * MB, true, 0.f));
+    usages.back().evictable = false;
+    usages.push_back(createUsage("texture", 0, 4 * MB, true, 0.f));
+
+    const ContentMemoryUsages evictions = memoryManager.update(usages);
+    BOOST_REQUIRE_EQUAL( evictions.size(), 1 );
+    BOOST_CHECK_EQUAL( evictions[0].uri.toStdString(), "texture" );
+    BOOST_CHECK_EQUAL( memoryManager.getGPUMemoryUsage(), 4 * MB );
+}
+
+BOOST_AUTO_TEST_CASE( TestOnlyContentsFreeingTheExceededMemoryAreEvicted )
+{
+    MemoryManager memoryManager(100 * MB, 5 * MB);
+
+    ContentMemoryUsages usages;
+    usages.push_back(createUsage("hostOnly", 4 * MB, 0, false, 0.f, 1));
+    usages.push_back(createUsage("gpu", 0, 8 * MB, false, 0.f, 2));
+
+    const ContentMemoryUsages evictions = memoryManager.update(usages);
+    BOOST_REQUIRE_EQUAL( evictions.size(), 1 );
+    BOOST_CHECK_EQUAL( evictions[0].uri.toStdString(), "gpu" );
+    BOOST_CHECK_EQUAL( memoryManager.getHostMemoryUsage(), 4 * MB );
+}
@@ -261,3 +261,153 @@ BOOST_AUTO_TEST_CASE( TestRemoveSourceWhileStreaming )
     BOOST_CHECK( !buffer.isFirstFrame() );
 
 }
+
+BOOST_AUTO_TEST_CASE( TestPartialFrameWhenSourceExceedsMaxFrameLag )
+{
+    const size_t sourceIndex1 = 46;
+    const size_t sourceIndex2 = 819;
+
+    PixelStreamBuffer buffer;
+    buffer.setLimits(2, 0);
+    buffer.setStragglerPolicy(STRAGGLER_PARTIAL_FRAME);
+    buffer.addSource(sourceIndex1);
+    buffer.addSource(sourceIndex2);
+
+    PixelStreamSegments testSegments = generateTestSegments();
+
+    // First frame from both sources
+    buffer.insertSegment(testSegments[0], sourceIndex1);
+    buffer.insertSegment(testSegments[2], sourceIndex2);
+    buffer.finishFrameForSource(sourceIndex1);
+    buffer.finishFrameForSource(sourceIndex2);
+    BOOST_REQUIRE( buffer.hasFrameComplete() );
+    BOOST_CHECK_EQUAL( buffer.getFrame().size(), 2 );
+
+    // Source 2 stalls, source 1 keeps sending
+    for (size_t i = 0; i < 2; ++i)
+    {
+        buffer.insertSegment(testSegments[0], sourceIndex1);
+        buffer.insertSegment(testSegments[1], sourceIndex1);
+        buffer.finishFrameForSource(sourceIndex1);
+        BOOST_CHECK( !buffer.hasFrameComplete() );
+    }
+    buffer.insertSegment(testSegments[0], sourceIndex1);
+    buffer.insertSegment(testSegments[1], sourceIndex1);
+    buffer.finishFrameForSource(sourceIndex1);
+    BOOST_REQUIRE( buffer.hasFrameComplete() );
+
+    QSize frameSize = buffer.getFrameSize();
+    BOOST_CHECK_EQUAL( frameSize.width(), 192 );
+    BOOST_CHECK_EQUAL( frameSize.height(), 768 );
+
+    // Latest frame of source 1 + previous segment of source 2
+    PixelStreamSegments segments = buffer.getFrame();
+    BOOST_CHECK_EQUAL( segments.size(), 3 );
+    BOOST_CHECK( !buffer.hasFrameComplete() );
+    BOOST_CHECK_EQUAL( buffer.getStatistics().completeFrames, 1 );
+    BOOST_CHECK_EQUAL( buffer.getStatistics().partialFrames, 1 );
+    BOOST_CHECK_EQUAL( buffer.getStatistics().droppedFrames, 2 );
+
+    // Source 2 catches up, frames are complete again
+    buffer.insertSegment(testSegments[3], sourceIndex2);
+    buffer.finishFrameForSource(sourceIndex2);
+    BOOST_CHECK( !buffer.hasFrameComplete() );
+    buffer.insertSegment(testSegments[0], sourceIndex1);
+    buffer.finishFrameForSource(sourceIndex1);
+    BOOST_REQUIRE( buffer.hasFrameComplete() );
+    BOOST_CHECK_EQUAL( buffer.getFrame().size(), 2 );
+    BOOST_CHECK_EQUAL( buffer.getStatistics().completeFrames, 2 );
+    BOOST_CHECK_EQUAL( buffer.getBufferSize(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( TestPartialFrameSizeIsTheSizeOfTheDeliveredFrame )
+{
+    const size_t sourceIndex1 = 46;
+    const size_t sourceIndex2 = 819;
+
+    PixelStreamBuffer buffer;
+    buffer.setLimits(1, 0);
+    buffer.setStragglerPolicy(STRAGGLER_PARTIAL_FRAME);
+    buffer.addSource(sourceIndex1);
+    buffer.addSource(sourceIndex2);
+
+    PixelStreamSegments testSegments = generateTestSegments();
+
+    // First frame from both sources
+    buffer.insertSegment(testSegments[0], sourceIndex1);
+    buffer.insertSegment(testSegments[2], sourceIndex2);
+    buffer.finishFrameForSource(sourceIndex1);
+    buffer.finishFrameForSource(sourceIndex2);
+    BOOST_REQUIRE( buffer.hasFrameComplete() );
+    buffer.getFrame();
+
+    // Source 2 stalls, the frames of source 1 grow wider
+    buffer.insertSegment(testSegments[0], sourceIndex1);
+    buffer.finishFrameForSource(sourceIndex1);
+    BOOST_CHECK( !buffer.hasFrameComplete() );
+    buffer.insertSegment(testSegments[0], sourceIndex1);
+    buffer.insertSegment(testSegments[1], sourceIndex1);
+    buffer.finishFrameForSource(sourceIndex1);
+    BOOST_REQUIRE( buffer.hasFrameComplete() );
+
+    // The partial frame uses the most recent frame of source 1, not the oldest buffered one
+    const QSize frameSize = buffer.getFrameSize();
+    BOOST_CHECK_EQUAL( frameSize.width(), 192 );
+    BOOST_CHECK_EQUAL( frameSize.height(), 768 );
+    BOOST_CHECK( frameSize == PixelStreamBuffer::computeFrameDimensions(buffer.getFrame()) );
+}
+
+BOOST_AUTO_TEST_CASE( TestDropFramesWhenSourceExceedsMaxFrameLag )
+{
+    const size_t sourceIndex1 = 46;
+    const size_t sourceIndex2 = 819;
+
+    PixelStreamBuffer buffer;
+    buffer.setLimits(2, 0);
+    buffer.setStragglerPolicy(STRAGGLER_DROP_FRAME);
+    buffer.addSource(sourceIndex1);
+    buffer.addSource(sourceIndex2);
+
+    PixelStreamSegments testSegments = generateTestSegments();
+
+    // Source 2 stalls, source 1 keeps sending
+    for (size_t i = 0; i < 5; ++i)
+    {
+        buffer.insertSegment(testSegments[0], sourceIndex1);
+        buffer.finishFrameForSource(sourceIndex1);
+        BOOST_CHECK( !buffer.hasFrameComplete() );
+    }
+    BOOST_CHECK_EQUAL( buffer.getStatistics().droppedFrames, 3 );
+
+    buffer.insertSegment(testSegments[2], sourceIndex2);
+    buffer.finishFrameForSource(sourceIndex2);
+    BOOST_REQUIRE( buffer.hasFrameComplete() );
+    BOOST_CHECK_EQUAL( buffer.getFrame().size(), 2 );
+    BOOST_CHECK_EQUAL( buffer.getStatistics().completeFrames, 1 );
+    BOOST_CHECK_EQUAL( buffer.getStatistics().partialFrames, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( TestDropFramesWhenBufferExceedsMaxSize )
+{
+    const size_t sourceIndex1 = 46;
+    const size_t sourceIndex2 = 819;
+
+    PixelStreamBuffer buffer;
+    buffer.setLimits(0, 1000);
+    buffer.setStragglerPolicy(STRAGGLER_DROP_FRAME);
+    buffer.addSource(sourceIndex1);
+    buffer.addSource(sourceIndex2);
+
+    dc::PixelStreamSegment segment;
+    segment.imageData.resize(400);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        buffer.insertSegment(segment, sourceIndex1);
+        buffer.finishFrameForSource(sourceIndex1);
+        BOOST_CHECK( buffer.getBufferSize() <= 1000 );
+    }
+    BOOST_CHECK_EQUAL( buffer.getBufferSize(), 800 );
+    BOOST_CHECK_EQUAL( buffer.getStatistics().droppedFrames, 8 );
+    BOOST_CHECK( !buffer.hasFrameComplete() );
+}
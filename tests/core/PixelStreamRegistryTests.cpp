@@ -0,0 +1,89 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE PixelStreamRegistryTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "PixelStreamRegistry.h"
+
+BOOST_AUTO_TEST_CASE( TestRegisterStreams )
+{
+    PixelStreamRegistry registry;
+
+    const PixelStreamId id1 = registry.registerStream("stream1");
+    const PixelStreamId id2 = registry.registerStream("stream2");
+
+    BOOST_CHECK( id1 != INVALID_PIXELSTREAM_ID );
+    BOOST_CHECK( id2 != INVALID_PIXELSTREAM_ID );
+    BOOST_CHECK( id1 != id2 );
+
+    BOOST_CHECK_EQUAL( registry.registerStream("stream1"), id1 );
+    BOOST_CHECK_EQUAL( registry.getId("stream2"), id2 );
+    BOOST_CHECK_EQUAL( registry.getUri(id1).toStdString(), "stream1" );
+
+    BOOST_CHECK_EQUAL( registry.getId("unknown"), INVALID_PIXELSTREAM_ID );
+    BOOST_CHECK( registry.getUri(INVALID_PIXELSTREAM_ID).isEmpty() );
+}
+
+BOOST_AUTO_TEST_CASE( TestIdsAreNotReused )
+{
+    PixelStreamRegistry registry;
+
+    const PixelStreamId id = registry.registerStream("stream");
+    registry.unregisterStream(id);
+
+    BOOST_CHECK_EQUAL( registry.getId("stream"), INVALID_PIXELSTREAM_ID );
+    BOOST_CHECK( registry.getUri(id).isEmpty() );
+
+    BOOST_CHECK( registry.registerStream("stream") != id );
+}
+
+BOOST_AUTO_TEST_CASE( TestRegisterStreamsWithKnownIds )
+{
+    PixelStreamRegistry registry;
+
+    registry.registerStream("stream", 5);
+    BOOST_CHECK_EQUAL( registry.getId("stream"), 5 );
+
+    // A stream re-opened by the master process gets a new id
+    registry.registerStream("stream", 7);
+    BOOST_CHECK_EQUAL( registry.getId("stream"), 7 );
+    BOOST_CHECK( registry.getUri(5).isEmpty() );
+    BOOST_CHECK_EQUAL( registry.getUri(7).toStdString(), "stream" );
+}
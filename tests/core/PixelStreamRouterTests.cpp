@@ -0,0 +1,144 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE PixelStreamRouterTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "PixelStreamRouter.h"
+
+#define SEGMENT_SIZE 100
+#define SEGMENT_DATA_SIZE 16
+
+// A 2x2 wall where each process has the screens of one column
+void setColumnScreens(PixelStreamRouter& router)
+{
+    ScreenRects leftColumn;
+    leftColumn.push_back(QRectF(0.0, 0.0, 0.5, 0.5));
+    leftColumn.push_back(QRectF(0.0, 0.5, 0.5, 0.5));
+    router.setProcessScreens(1, leftColumn);
+
+    ScreenRects rightColumn;
+    rightColumn.push_back(QRectF(0.5, 0.0, 0.5, 0.5));
+    rightColumn.push_back(QRectF(0.5, 0.5, 0.5, 0.5));
+    router.setProcessScreens(2, rightColumn);
+}
+
+// A frame made of a single row of segments
+PixelStreamSegments createFrame(const size_t segmentCount)
+{
+    PixelStreamSegments segments(segmentCount);
+    for (size_t i = 0; i < segmentCount; ++i)
+    {
+        segments[i].parameters.x = i * SEGMENT_SIZE;
+        segments[i].parameters.width = SEGMENT_SIZE;
+        segments[i].parameters.height = SEGMENT_SIZE;
+        segments[i].imageData = QByteArray(SEGMENT_DATA_SIZE, 'x');
+    }
+    return segments;
+}
+
+BOOST_AUTO_TEST_CASE( TestSelectSegmentsOfEachProcess )
+{
+    PixelStreamRouter router(0.0);
+    setColumnScreens(router);
+
+    BOOST_CHECK_EQUAL( router.getProcessCount(), 2 );
+
+    // window spanning the two columns, each half of the frame is on a different process
+    const PixelStreamSegments segments = createFrame(4);
+    const QRectF window(0.25, 0.25, 0.5, 0.5);
+
+    const SegmentSelection left = router.selectSegments(segments, window, 1);
+    BOOST_REQUIRE_EQUAL( left.size(), 4 );
+    BOOST_CHECK( left[0] && left[1] && !left[2] && !left[3] );
+
+    const SegmentSelection right = router.selectSegments(segments, window, 2);
+    BOOST_REQUIRE_EQUAL( right.size(), 4 );
+    BOOST_CHECK( !right[0] && !right[1] && right[2] && right[3] );
+}
+
+BOOST_AUTO_TEST_CASE( TestHaloSelectsNeighbouringSegments )
+{
+    PixelStreamRouter router(0.1);
+    setColumnScreens(router);
+
+    // window inside the left column, close to the right column
+    const PixelStreamSegments segments = createFrame(4);
+    const QRectF window(0.08, 0.25, 0.4, 0.5);
+
+    const SegmentSelection right = router.selectSegments(segments, window, 2);
+    BOOST_CHECK( !right[0] && !right[1] && !right[2] && right[3] );
+
+    PixelStreamRouter routerWithoutHalo(0.0);
+    setColumnScreens(routerWithoutHalo);
+
+    const SegmentSelection rightWithoutHalo = routerWithoutHalo.selectSegments(segments, window, 2);
+    BOOST_CHECK( !rightWithoutHalo[3] );
+}
+
+BOOST_AUTO_TEST_CASE( TestUnknownProcessHasNoSegments )
+{
+    PixelStreamRouter router;
+    setColumnScreens(router);
+
+    const PixelStreamSegments segments = createFrame(2);
+    const SegmentSelection selection = router.selectSegments(segments, QRectF(0.0, 0.0, 1.0, 1.0), 3);
+
+    BOOST_REQUIRE_EQUAL( selection.size(), 2 );
+    BOOST_CHECK( !selection[0] && !selection[1] );
+}
+
+BOOST_AUTO_TEST_CASE( TestFilterSegmentsKeepsParameters )
+{
+    const PixelStreamSegments segments = createFrame(2);
+
+    SegmentSelection selection(2, false);
+    selection[1] = true;
+
+    const PixelStreamSegments filtered = PixelStreamRouter::filterSegments(segments, selection);
+
+    BOOST_REQUIRE_EQUAL( filtered.size(), 2 );
+    BOOST_CHECK( filtered[0].imageData.isEmpty() );
+    BOOST_CHECK_EQUAL( filtered[0].parameters.x, segments[0].parameters.x );
+    BOOST_CHECK_EQUAL( filtered[0].parameters.width, segments[0].parameters.width );
+    BOOST_CHECK_EQUAL( filtered[1].imageData.size(), SEGMENT_DATA_SIZE );
+
+    // the original frame is unchanged
+    BOOST_CHECK_EQUAL( segments[0].imageData.size(), SEGMENT_DATA_SIZE );
+}
@@ -0,0 +1,116 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE PixelStreamSchedulerTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "PixelStreamScheduler.h"
+
+#define FRONT_STREAM 1
+#define MIDDLE_STREAM 2
+#define BACK_STREAM 3
+
+std::map<PixelStreamId, size_t> createCosts(const size_t cost)
+{
+    std::map<PixelStreamId, size_t> costs;
+    costs[FRONT_STREAM] = cost;
+    costs[MIDDLE_STREAM] = cost;
+    costs[BACK_STREAM] = cost;
+    return costs;
+}
+
+BOOST_AUTO_TEST_CASE( TestPriorities )
+{
+    const float visibleArea = 0.25f;
+
+    const float priority = PixelStreamScheduler::computePriority(visibleArea, false, false);
+    BOOST_CHECK_GT( PixelStreamScheduler::computePriority(visibleArea, true, false), priority );
+    BOOST_CHECK_GT( PixelStreamScheduler::computePriority(visibleArea, false, true), priority );
+    BOOST_CHECK_GT( PixelStreamScheduler::computePriority(0.f, false, false), 0.f );
+    BOOST_CHECK_LT( PixelStreamScheduler::computePriority(0.f, false, false), priority );
+}
+
+BOOST_AUTO_TEST_CASE( TestScheduleAllStreamsWithoutBudget )
+{
+    PixelStreamScheduler scheduler;
+
+    const std::set<PixelStreamId> streams = scheduler.schedule(createCosts(1000));
+
+    BOOST_CHECK_EQUAL( streams.size(), 3 );
+}
+
+BOOST_AUTO_TEST_CASE( TestScheduleStreamsByPriorityWithinBudget )
+{
+    PixelStreamScheduler scheduler(20);
+    scheduler.setPriority(FRONT_STREAM, 1.f);
+    scheduler.setPriority(MIDDLE_STREAM, 0.5f);
+    scheduler.setPriority(BACK_STREAM, 0.1f);
+
+    std::set<PixelStreamId> streams = scheduler.schedule(createCosts(10));
+
+    BOOST_REQUIRE_EQUAL( streams.size(), 2 );
+    BOOST_CHECK( streams.count(FRONT_STREAM) );
+    BOOST_CHECK( streams.count(MIDDLE_STREAM) );
+
+    // The stream with the lowest priority is updated at a lower frame rate, but eventually updated
+    size_t frames = 1;
+    while( !streams.count(BACK_STREAM) && frames < 10 )
+    {
+        streams = scheduler.schedule(createCosts(10));
+        BOOST_REQUIRE_EQUAL( streams.size(), 2 );
+        BOOST_CHECK( streams.count(FRONT_STREAM) );
+        ++frames;
+    }
+    BOOST_CHECK( streams.count(BACK_STREAM) );
+    BOOST_CHECK_GT( frames, 2 );
+    BOOST_CHECK_LT( frames, 10 );
+}
+
+BOOST_AUTO_TEST_CASE( TestScheduleHighestPriorityStreamOverBudget )
+{
+    PixelStreamScheduler scheduler(5);
+    scheduler.setPriority(FRONT_STREAM, 1.f);
+    scheduler.setPriority(MIDDLE_STREAM, 0.5f);
+    scheduler.setPriority(BACK_STREAM, 0.1f);
+
+    const std::set<PixelStreamId> streams = scheduler.schedule(createCosts(10));
+
+    BOOST_REQUIRE_EQUAL( streams.size(), 1 );
+    BOOST_CHECK( streams.count(FRONT_STREAM) );
+}
@@ -0,0 +1,95 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE TranscodingCommandHandlerTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "TranscodingCommandHandler.h"
+#include "Command.h"
+#include "DisplayGroupManager.h"
+#include "PixelStreamDispatcher.h"
+#include "PixelStreamRegistry.h"
+#include "configuration/MasterConfiguration.h"
+#include "globals.h"
+#include "MinimalGlobalQtApp.h"
+
+// The configured policy of the streams which do not set their own
+#define CONFIG_TEST_FILENAME "./configuration.xml"
+#define CONFIG_EXPECTED_TRANSCODING_POLICY TRANSCODING_ON
+
+BOOST_GLOBAL_FIXTURE( MinimalGlobalQtApp );
+
+BOOST_AUTO_TEST_CASE( TestStreamSetsItsTranscodingPolicy )
+{
+    g_displayGroupManager.reset(new DisplayGroupManager);
+    g_configuration = new MasterConfiguration(CONFIG_TEST_FILENAME, g_displayGroupManager->getOptions());
+
+    {
+        PixelStreamDispatcher dispatcher;
+        TranscodingCommandHandler handler(dispatcher);
+        BOOST_CHECK_EQUAL( handler.getType(), COMMAND_TYPE_TRANSCODING );
+
+        const PixelStreamId streamId = g_pixelStreamRegistry.registerStream("stream");
+        const PixelStreamId otherStreamId = g_pixelStreamRegistry.registerStream("otherStream");
+        BOOST_CHECK_EQUAL( dispatcher.getTranscodingPolicy(streamId), CONFIG_EXPECTED_TRANSCODING_POLICY );
+
+        handler.handle(Command(COMMAND_TYPE_TRANSCODING, "off"), "stream");
+        BOOST_CHECK_EQUAL( dispatcher.getTranscodingPolicy(streamId), TRANSCODING_OFF );
+        BOOST_CHECK_EQUAL( dispatcher.getTranscodingPolicy(otherStreamId), CONFIG_EXPECTED_TRANSCODING_POLICY );
+
+        handler.handle(Command(COMMAND_TYPE_TRANSCODING, "auto"), "otherStream");
+        BOOST_CHECK_EQUAL( dispatcher.getTranscodingPolicy(streamId), TRANSCODING_OFF );
+        BOOST_CHECK_EQUAL( dispatcher.getTranscodingPolicy(otherStreamId), TRANSCODING_AUTO );
+
+        // invalid policies are ignored
+        handler.handle(Command(COMMAND_TYPE_TRANSCODING, "zorglump"), "stream");
+        BOOST_CHECK_EQUAL( dispatcher.getTranscodingPolicy(streamId), TRANSCODING_OFF );
+
+        // streams which are not open cannot set a policy
+        handler.handle(Command(COMMAND_TYPE_TRANSCODING, "off"), "unknownStream");
+        BOOST_CHECK_EQUAL( g_pixelStreamRegistry.getId("unknownStream"), INVALID_PIXELSTREAM_ID );
+
+        g_pixelStreamRegistry.unregisterStream(streamId);
+        g_pixelStreamRegistry.unregisterStream(otherStreamId);
+    }
+
+    delete g_configuration;
+    g_configuration = 0;
+    g_displayGroupManager.reset();
+}
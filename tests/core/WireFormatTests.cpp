@@ -0,0 +1,143 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE WireFormatTests
+#include <boost/test/unit_test.hpp>
+namespace ut = boost::unit_test;
+
+#include "WireFormat.h"
+
+#define STREAM_ID 42
+#define SEGMENT_SIZE 64
+
+PixelStreamSegments createSegments()
+{
+    PixelStreamSegments segments(2);
+
+    segments[0].parameters.x = 0;
+    segments[0].parameters.width = SEGMENT_SIZE;
+    segments[0].parameters.height = SEGMENT_SIZE;
+    segments[0].parameters.compressed = true;
+    segments[0].imageData = QByteArray("jpeg data");
+
+    segments[1].parameters.x = SEGMENT_SIZE;
+    segments[1].parameters.width = SEGMENT_SIZE;
+    segments[1].parameters.height = SEGMENT_SIZE;
+    segments[1].parameters.compressed = false;
+
+    return segments;
+}
+
+BOOST_AUTO_TEST_CASE( TestPixelStreamFrameRoundTrip )
+{
+    const PixelStreamSegments segments = createSegments();
+
+    WireBuffer buffer;
+    writePixelStreamFrame(buffer, STREAM_ID, segments);
+
+    PixelStreamId streamId = INVALID_PIXELSTREAM_ID;
+    PixelStreamSegments receivedSegments;
+    BOOST_REQUIRE( readPixelStreamFrame(&buffer[0], buffer.size(), streamId, receivedSegments) );
+
+    BOOST_CHECK_EQUAL( streamId, STREAM_ID );
+    BOOST_REQUIRE_EQUAL( receivedSegments.size(), segments.size() );
+
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( receivedSegments[i].parameters.x, segments[i].parameters.x );
+        BOOST_CHECK_EQUAL( receivedSegments[i].parameters.y, segments[i].parameters.y );
+        BOOST_CHECK_EQUAL( receivedSegments[i].parameters.width, segments[i].parameters.width );
+        BOOST_CHECK_EQUAL( receivedSegments[i].parameters.height, segments[i].parameters.height );
+        BOOST_CHECK_EQUAL( receivedSegments[i].parameters.compressed, segments[i].parameters.compressed );
+        BOOST_CHECK( receivedSegments[i].imageData == segments[i].imageData );
+    }
+
+    // the image data is read in place
+    BOOST_CHECK( receivedSegments[0].imageData.constData() >= &buffer[0] );
+    BOOST_CHECK( receivedSegments[0].imageData.constData() < &buffer[0] + buffer.size() );
+}
+
+BOOST_AUTO_TEST_CASE( TestLittleEndianLayout )
+{
+    WireBuffer buffer;
+    WireWriter writer(buffer, WIRE_MESSAGE_PIXELSTREAM_FRAME);
+    writer.writeUInt32(0x04030201);
+
+    BOOST_REQUIRE_EQUAL( buffer.size(), 4 * sizeof(uint32_t) );
+    BOOST_CHECK_EQUAL( buffer[12], 1 );
+    BOOST_CHECK_EQUAL( buffer[15], 4 );
+}
+
+BOOST_AUTO_TEST_CASE( TestInvalidMessagesAreRejected )
+{
+    WireBuffer buffer;
+    writePixelStreamFrame(buffer, STREAM_ID, createSegments());
+
+    PixelStreamId streamId;
+    PixelStreamSegments segments;
+
+    // truncated
+    BOOST_CHECK( !readPixelStreamFrame(&buffer[0], buffer.size() - 1, streamId, segments) );
+
+    // wrong type
+    buffer[8] = WIRE_MESSAGE_PIXELSTREAM_FRAME + 1;
+    BOOST_CHECK( !readPixelStreamFrame(&buffer[0], buffer.size(), streamId, segments) );
+    buffer[8] = WIRE_MESSAGE_PIXELSTREAM_FRAME;
+
+    // unsupported version
+    buffer[4] = WIREFORMAT_VERSION + 1;
+    BOOST_CHECK( !readPixelStreamFrame(&buffer[0], buffer.size(), streamId, segments) );
+}
+
+BOOST_AUTO_TEST_CASE( TestBufferPoolReusesReleasedBuffers )
+{
+    WireBufferPool pool(1);
+
+    WireBufferPtr buffer = pool.getBuffer(16);
+    BOOST_CHECK_EQUAL( buffer->size(), 16 );
+
+    // still in use, so a new buffer is needed
+    WireBufferPtr otherBuffer = pool.getBuffer(8);
+    BOOST_CHECK( otherBuffer != buffer );
+
+    WireBuffer* released = buffer.get();
+    buffer.reset();
+    otherBuffer.reset();
+
+    BOOST_CHECK_EQUAL( pool.getBuffer(32).get(), released );
+}
@@ -0,0 +1,164 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE Serialization
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+namespace ut = boost::unit_test;
+
+#include "WireFormat.h"
+
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/vector.hpp>
+#include <sstream>
+#include <iostream>
+
+// Compares the cost of serializing a frame of PixelStream segments with
+// boost binary archives, as previously done for MPI messages, against the
+// flat wire format written in a reused buffer and read in place.
+
+#define WIDTH  (3840u)
+#define HEIGHT (2160u)
+#define SEGMENTS_X (8u)
+#define SEGMENTS_Y (8u)
+#define NFRAMES (50u)
+
+#define STREAM_ID 1
+
+namespace
+{
+PixelStreamSegments createFrame()
+{
+    const unsigned int segmentWidth = WIDTH / SEGMENTS_X;
+    const unsigned int segmentHeight = HEIGHT / SEGMENTS_Y;
+
+    PixelStreamSegments segments;
+    for( unsigned int j = 0; j < SEGMENTS_Y; ++j )
+    {
+        for( unsigned int i = 0; i < SEGMENTS_X; ++i )
+        {
+            PixelStreamSegment segment;
+            segment.parameters.x = i * segmentWidth;
+            segment.parameters.y = j * segmentHeight;
+            segment.parameters.width = segmentWidth;
+            segment.parameters.height = segmentHeight;
+            segment.parameters.compressed = false;
+            segment.imageData = QByteArray( segmentWidth * segmentHeight * 4, 'x' );
+            segments.push_back( segment );
+        }
+    }
+    return segments;
+}
+
+float elapsedSeconds( const boost::posix_time::ptime& start )
+{
+    const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    return (float)(now - start).total_microseconds() / 1000000.f;
+}
+
+void printResult( const std::string& name, const float time, const size_t frameSize )
+{
+    std::cout << name << " " << frameSize / float(1024*1024) / time * NFRAMES
+              << " MB/s (" << NFRAMES / time << " FPS)" << std::endl;
+}
+}
+
+BOOST_AUTO_TEST_CASE( testBoostArchiveSerialization )
+{
+    const PixelStreamSegments segments = createFrame();
+    const size_t frameSize = segments.size() * segments[0].imageData.size();
+
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for( size_t i = 0; i < NFRAMES; ++i )
+    {
+        std::ostringstream oss( std::ostringstream::binary );
+        {
+            boost::archive::binary_oarchive oa( oss );
+            const PixelStreamId streamId = STREAM_ID;
+            oa << streamId;
+            oa << segments;
+        }
+        const std::string serializedString = oss.str();
+
+        // copy to the receive buffer, as done by MPI
+        char* buf = new char[serializedString.size()];
+        memcpy( buf, serializedString.data(), serializedString.size( ));
+
+        std::istringstream iss( std::istringstream::binary );
+        iss.rdbuf()->pubsetbuf( buf, serializedString.size( ));
+
+        PixelStreamId streamId;
+        PixelStreamSegments receivedSegments;
+        {
+            boost::archive::binary_iarchive ia( iss );
+            ia >> streamId;
+            ia >> receivedSegments;
+        }
+        BOOST_CHECK_EQUAL( receivedSegments.size(), segments.size( ));
+
+        delete [] buf;
+    }
+    printResult( "boost", elapsedSeconds( start ), frameSize );
+}
+
+BOOST_AUTO_TEST_CASE( testWireFormatSerialization )
+{
+    const PixelStreamSegments segments = createFrame();
+    const size_t frameSize = segments.size() * segments[0].imageData.size();
+
+    WireBuffer sendBuffer;
+    WireBufferPool receiveBuffers;
+
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for( size_t i = 0; i < NFRAMES; ++i )
+    {
+        writePixelStreamFrame( sendBuffer, STREAM_ID, segments );
+
+        // copy to the receive buffer, as done by MPI
+        WireBufferPtr buffer = receiveBuffers.getBuffer( sendBuffer.size( ));
+        memcpy( &(*buffer)[0], &sendBuffer[0], sendBuffer.size( ));
+
+        PixelStreamId streamId;
+        PixelStreamSegments receivedSegments;
+        BOOST_CHECK( readPixelStreamFrame( &(*buffer)[0], buffer->size(),
+                                           streamId, receivedSegments ));
+        BOOST_CHECK_EQUAL( receivedSegments.size(), segments.size( ));
+    }
+    printResult( "flat ", elapsedSeconds( start ), frameSize );
+}
@@ -0,0 +1,152 @@
+/*********************************************************************/
+/* Copyright (c) 2014, EPFL/Blue Brain Project                       */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/*   1. Redistributions of source code must retain the above         */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer.                                                  */
+/*                                                                   */
+/*   2. Redistributions in binary form must reproduce the above      */
+/*      copyright notice, this list of conditions and the following  */
+/*      disclaimer in the documentation and/or other materials       */
+/*      provided with the distribution.                              */
+/*                                                                   */
+/*    THIS  SOFTWARE IS PROVIDED  BY THE  UNIVERSITY OF  TEXAS AT    */
+/*    AUSTIN  ``AS IS''  AND ANY  EXPRESS OR  IMPLIED WARRANTIES,    */
+/*    INCLUDING, BUT  NOT LIMITED  TO, THE IMPLIED  WARRANTIES OF    */
+/*    MERCHANTABILITY  AND FITNESS FOR  A PARTICULAR  PURPOSE ARE    */
+/*    DISCLAIMED.  IN  NO EVENT SHALL THE UNIVERSITY  OF TEXAS AT    */
+/*    AUSTIN OR CONTRIBUTORS BE  LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL,  SPECIAL, EXEMPLARY,  OR  CONSEQUENTIAL DAMAGES    */
+/*    (INCLUDING, BUT  NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE    */
+/*    GOODS  OR  SERVICES; LOSS  OF  USE,  DATA,  OR PROFITS;  OR    */
+/*    BUSINESS INTERRUPTION) HOWEVER CAUSED  AND ON ANY THEORY OF    */
+/*    LIABILITY, WHETHER  IN CONTRACT, STRICT  LIABILITY, OR TORT    */
+/*    (INCLUDING NEGLIGENCE OR OTHERWISE)  ARISING IN ANY WAY OUT    */
+/*    OF  THE  USE OF  THIS  SOFTWARE,  EVEN  IF ADVISED  OF  THE    */
+/*    POSSIBILITY OF SUCH DAMAGE.                                    */
+/*                                                                   */
+/* The views and conclusions contained in the software and           */
+/* documentation are those of the authors and should not be          */
+/* interpreted as representing official policies, either expressed   */
+/* or implied, of The University of Texas at Austin.                 */
+/*********************************************************************/
+
+#define BOOST_TEST_MODULE TextureUpload
+#include <boost/test/unit_test.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+namespace ut = boost::unit_test;
+
+#include "GlobalQtApp.h"
+#include "PixelBufferPool.h"
+#include "PixelStreamSegmentRenderer.h"
+
+#include <QGLWidget>
+#include <iostream>
+
+// Compares the time spent by the render thread to upload the segments of a
+// 4K stream synchronously from client memory against the asynchronous upload
+// from pixel buffer objects. Writing the pixels, which the decoders do in
+// their own threads, is not timed.
+
+#define WIDTH  (3840u)
+#define HEIGHT (2160u)
+#define SEGMENTS_X (8u)
+#define SEGMENTS_Y (8u)
+#define SEGMENT_WIDTH (WIDTH / SEGMENTS_X)
+#define SEGMENT_HEIGHT (HEIGHT / SEGMENTS_Y)
+#define SEGMENT_SIZE (SEGMENT_WIDTH * SEGMENT_HEIGHT * 4u)
+#define NSEGMENTS (SEGMENTS_X * SEGMENTS_Y)
+#define NFRAMES (50u)
+
+BOOST_GLOBAL_FIXTURE( GlobalQtApp );
+
+namespace
+{
+float elapsedSeconds( const boost::posix_time::ptime& start )
+{
+    const boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    return (float)(now - start).total_microseconds() / 1000000.f;
+}
+
+void printResult( const std::string& name, const float renderThreadTime, const float totalTime )
+{
+    std::cout << name << " render thread: " << renderThreadTime / NFRAMES * 1000.f
+              << " ms/frame, with transfers: " << totalTime / NFRAMES * 1000.f
+              << " ms/frame" << std::endl;
+}
+}
+
+BOOST_AUTO_TEST_CASE( testTextureUpload )
+{
+    if( !hasGLXDisplay( ))
+        return;
+
+    QGLWidget widget;
+    widget.makeCurrent();
+
+    std::vector<PixelStreamSegmentRenderer*> renderers;
+    for( size_t i = 0; i < NSEGMENTS; ++i )
+        renderers.push_back( new PixelStreamSegmentRenderer( "test" ));
+
+    QByteArray pixels( SEGMENT_SIZE, 'x' );
+    const QImage image( (const uchar*)pixels.constData(), SEGMENT_WIDTH,
+                        SEGMENT_HEIGHT, QImage::Format_RGB32 );
+
+    float renderThreadTime = 0.f;
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for( size_t frame = 0; frame < NFRAMES; ++frame )
+    {
+        const boost::posix_time::ptime uploadStart = boost::posix_time::microsec_clock::universal_time();
+        for( size_t i = 0; i < NSEGMENTS; ++i )
+            renderers[i]->updateTexture( image );
+        renderThreadTime += elapsedSeconds( uploadStart );
+    }
+    glFinish();
+    printResult( "client memory", renderThreadTime, elapsedSeconds( start ));
+
+    if( !PixelBufferPool::isSupported( ))
+    {
+        std::cout << "pixel buffer objects not supported" << std::endl;
+        return;
+    }
+
+    std::vector<PixelBufferPool*> pools;
+    for( size_t i = 0; i < NSEGMENTS; ++i )
+        pools.push_back( new PixelBufferPool( ));
+
+    renderThreadTime = 0.f;
+    start = boost::posix_time::microsec_clock::universal_time();
+    for( size_t frame = 0; frame < NFRAMES; ++frame )
+    {
+        std::vector<unsigned char*> buffers;
+        const boost::posix_time::ptime mapStart = boost::posix_time::microsec_clock::universal_time();
+        for( size_t i = 0; i < NSEGMENTS; ++i )
+            buffers.push_back( pools[i]->map( SEGMENT_SIZE ));
+        renderThreadTime += elapsedSeconds( mapStart );
+
+        // done by the decoders
+        for( size_t i = 0; i < NSEGMENTS; ++i )
+        {
+            BOOST_REQUIRE( buffers[i] );
+            memcpy( buffers[i], pixels.constData(), SEGMENT_SIZE );
+        }
+
+        const boost::posix_time::ptime uploadStart = boost::posix_time::microsec_clock::universal_time();
+        for( size_t i = 0; i < NSEGMENTS; ++i )
+            renderers[i]->updateTexture( *pools[i], SEGMENT_WIDTH, SEGMENT_HEIGHT );
+        renderThreadTime += elapsedSeconds( uploadStart );
+    }
+    glFinish();
+    printResult( "pixel buffers", renderThreadTime, elapsedSeconds( start ));
+
+    for( size_t i = 0; i < NSEGMENTS; ++i )
+    {
+        delete pools[i];
+        delete renderers[i];
+    }
+}
@@ -44,9 +44,11 @@ namespace ut = boost::unit_test;
 
 #include "DisplayGroupManager.h"
 #include "MinimalGlobalQtApp.h"
+#include "MPIChannel.h"
 #include "NetworkListener.h"
 #include "configuration/MasterConfiguration.h"
 #include "dcstream/Stream.h"
+#include "globals.h"
 
 // Tests local throughput of the streaming library by sending raw as well as
 // blank and random images through dc::Stream. Baseline test for best-case
@@ -148,6 +150,7 @@ BOOST_AUTO_TEST_CASE( testSocketConnection )
 {
     ut::master_test_suite_t& testSuite = ut::framework::master_test_suite();
     MPI_Init( &testSuite.argc, &testSuite.argv );
+    g_mpiChannel = new MPIChannel( MPI_COMM_WORLD );
 
     g_displayGroupManager.reset( new DisplayGroupManager );
     g_configuration =
@@ -163,5 +166,7 @@ BOOST_AUTO_TEST_CASE( testSocketConnection )
     QApplication::instance()->exec();
     BOOST_CHECK( thread.wait( ));
 
+    delete g_mpiChannel;
+    g_mpiChannel = 0;
     MPI_Finalize();
 }